@@ -0,0 +1,130 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include <string.h>
+#include "com/diag/amigo/BufferedSink.h"
+#include "com/diag/amigo/Task.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+BufferedSinkBase::BufferedSinkBase(Sink & outputsink, uint8_t * storage, size_t size, bool lines, ticks_t interval)
+: sink(&outputsink)
+, buffer(storage)
+, limit(size)
+, length(0)
+, latency(interval)
+, then(0)
+, newline(lines)
+{}
+
+BufferedSinkBase::~BufferedSinkBase() {}
+
+bool BufferedSinkBase::stale() const {
+	// The clock is only read when there is a latency, so that the common case
+	// costs no critical section per byte.
+	return (latency != NEVER) && (length > 0) && (static_cast<ticks_t>(Task::elapsed() - then) >= latency);
+}
+
+size_t BufferedSinkBase::forward() {
+	size_t written = 0;
+	if (length > 0) {
+		written = sink->write(buffer, length);
+		if (written >= length) {
+			length = 0;
+		} else {
+			memmove(buffer, buffer + written, length - written);
+			length -= written;
+		}
+	}
+	return written;
+}
+
+size_t BufferedSinkBase::append(const void * datum, size_t size, bool progmem) {
+	if (size >= limit) {
+		// Copying a block this large would only split it up, so it goes
+		// straight through once everything before it has.
+		forward();
+		if (length > 0) {
+			return 0;
+		}
+		return progmem ? sink->write_P(datum, size) : sink->write(datum, size);
+	}
+	const uint8_t * here = static_cast<const uint8_t *>(datum);
+	size_t count = 0;
+	bool lines = false;
+	while (count < size) {
+		if (length >= limit) {
+			forward();
+			if (length >= limit) { break; }
+		}
+		if ((length == 0) && (latency != NEVER)) {
+			then = Task::elapsed();
+		}
+		size_t chunk = limit - length;
+		if (chunk > (size - count)) { chunk = size - count; }
+		if (progmem) {
+			memcpy_P(buffer + length, here + count, chunk);
+		} else {
+			memcpy(buffer + length, here + count, chunk);
+		}
+		if (newline && (memchr(buffer + length, '\n', chunk) != 0)) {
+			lines = true;
+		}
+		length += chunk;
+		count += chunk;
+	}
+	if ((length >= limit) || lines || stale()) {
+		forward();
+	}
+	return count;
+}
+
+size_t BufferedSinkBase::write(uint8_t ch) {
+	if (length >= limit) {
+		forward();
+		if (length >= limit) {
+			return 0;
+		}
+	}
+	if ((length == 0) && (latency != NEVER)) {
+		then = Task::elapsed();
+	}
+	buffer[length++] = ch;
+	if ((length >= limit) || (newline && (ch == '\n')) || stale()) {
+		forward();
+	}
+	return 1;
+}
+
+size_t BufferedSinkBase::write(const void * datum, size_t size) {
+	return append(datum, size, false);
+}
+
+size_t BufferedSinkBase::write_P(PGM_VOID_P datum, size_t size) {
+	return append(datum, size, true);
+}
+
+void BufferedSinkBase::flush() {
+	forward();
+	sink->flush();
+}
+
+size_t BufferedSinkBase::poll() {
+	return stale() ? forward() : 0;
+}
+
+}
+}
+}
+
+// Used by applications; any other size must be instantiated likewise.
+template class com::diag::amigo::BufferedSink<16>;
+template class com::diag::amigo::BufferedSink<32>;
+template class com::diag::amigo::BufferedSink<64>;
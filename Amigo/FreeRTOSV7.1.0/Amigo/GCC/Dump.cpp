@@ -36,6 +36,58 @@ size_t Dump::operator() (const void * data, size_t size) {
 	return result;
 }
 
+// Computing a digit takes a compare and an add in registers, where looking
+// it up in HEX takes a load from program memory.
+static char hex(uint8_t nibble) {
+	return (nibble < 10) ? ('0' + nibble) : ('A' - 10 + nibble);
+}
+
+size_t Dump::lines(const void * data, size_t size, uintptr_t offset) {
+	static const size_t DIGITS = sizeof(offset) * 2;
+	static const size_t GUTTER = DIGITS + 1 + (WIDTH * 2) + (WIDTH / GROUP) + 2;
+	char line[GUTTER + WIDTH + 3];
+	const uint8_t * here = static_cast<const uint8_t *>(data);
+	size_t result = 0;
+	while (size > 0) {
+		size_t count = (size < WIDTH) ? size : WIDTH;
+		char * there = line;
+		for (size_t ii = DIGITS; ii > 0; --ii) {
+			*(there++) = hex((offset >> ((ii - 1) * 4)) & 0xf);
+		}
+		*(there++) = ':';
+		for (size_t ii = 0; ii < WIDTH; ++ii) {
+			if ((ii % GROUP) == 0) {
+				*(there++) = ' ';
+			}
+			if (ii < count) {
+				uint8_t datum = progmem ? pgm_read_byte(here + ii) : here[ii];
+				*(there++) = hex(datum >> 4);
+				*(there++) = hex(datum & 0xf);
+				line[GUTTER + ii] = ((' ' <= datum) && (datum <= '~')) ? datum : '.';
+			} else {
+				*(there++) = ' ';
+				*(there++) = ' ';
+			}
+		}
+		*(there++) = ' ';
+		*(there++) = '|';
+		there += count;
+		*(there++) = '|';
+		*(there++) = '\n';
+		*(there++) = '\r';
+		size_t length = there - line;
+		size_t written = sink->write(line, length);
+		result += written;
+		if (written < length) {
+			break;
+		}
+		here += count;
+		size -= count;
+		offset += count;
+	}
+	return result;
+}
+
 }
 }
 }
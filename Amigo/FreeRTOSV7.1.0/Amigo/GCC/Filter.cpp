@@ -0,0 +1,108 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/Filter.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+Filter::Filter(Sink & outputsink, uint8_t decimation, uint8_t window, uint8_t smoothing)
+: sink(&outputsink)
+, sequence(0)
+, decimate((decimation < 15) ? decimation : 15)
+, width((window < WINDOW) ? window : WINDOW)
+, smooth((smoothing < 15) ? smoothing : 15)
+{
+	reset();
+}
+
+void Filter::reset() {
+	accumulator = 0;
+	sum = 0;
+	squares = 0;
+	ema = 0;
+	phase = 0;
+	count = 0;
+	minimum = ~static_cast<uint16_t>(0);
+	maximum = 0;
+	primed = false;
+}
+
+size_t Filter::operator() (const uint16_t * samples, size_t size) {
+	size_t result = 0;
+	while ((size--) > 0) {
+		result += (*this)(*(samples++));
+	}
+	return result;
+}
+
+size_t Filter::decimated(uint16_t sample) {
+	size_t result = 0;
+
+	// Starting the moving average at the first sample instead of at zero
+	// keeps it from ramping up from nothing.
+	if (primed) {
+		ema += ((static_cast<int32_t>(sample) << 8) - ema) >> smooth;
+	} else {
+		ema = static_cast<int32_t>(sample) << 8;
+		primed = true;
+	}
+
+	if (sample < minimum) {
+		minimum = sample;
+	}
+	if (sample > maximum) {
+		maximum = sample;
+	}
+	sum += sample;
+	squares += static_cast<uint32_t>(sample) * sample;
+
+	if ((++count) >> width) {
+		uint32_t half = (1UL << width) >> 1;
+		Summary summary;
+		summary.sequence = sequence++;
+		summary.minimum = minimum;
+		summary.maximum = maximum;
+		summary.mean = (sum + half) >> width;
+		summary.rms = root((squares + half) >> width);
+		summary.average = average();
+		if (sink->write(&summary, sizeof(summary)) == sizeof(summary)) {
+			result = 1;
+		}
+		sum = 0;
+		squares = 0;
+		count = 0;
+		minimum = ~static_cast<uint16_t>(0);
+		maximum = 0;
+	}
+
+	return result;
+}
+
+uint16_t Filter::root(uint32_t value) {
+	uint32_t result = 0;
+	uint32_t bit = 1UL << 30;
+	while (bit > value) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (value >= (result + bit)) {
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+	return result;
+}
+
+}
+}
+}
@@ -0,0 +1,87 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ * This file also instantiates the Formatter template explicitly for when the
+ * GCC C++ option -fno-implicit-templates is used.
+ */
+
+#include <string.h>
+#include "com/diag/amigo/Formatter.h"
+#include "com/diag/amigo/convert.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+size_t FormatterBase::Output::flush() {
+	if (length > 0) {
+		total += sink->write(buffer, length);
+		length = 0;
+	}
+	return total;
+}
+
+void FormatterBase::pad(Output & output, char ch, uint8_t count) {
+	while ((count--) > 0) {
+		output.put(ch);
+	}
+}
+
+void FormatterBase::integer(Output & output, const Specification & specification, unsigned long value, bool negative, uint8_t base, bool upper) {
+	// Enough for an unsigned long in octal, the worst case that is used.
+	char digits[((sizeof(value) * 8) + 2) / 3];
+	uint8_t count = 0;
+	bool nonzero = (value != 0);
+	// As in printf, a zero precision prints nothing for a zero value.
+	if (nonzero || (specification.precision != 0)) {
+		count = convert(digits, value, base, upper ? 'A' : 'a');
+	}
+	uint8_t zeros = ((specification.precision != NONE) && (specification.precision > count)) ? (specification.precision - count) : 0;
+	if (((specification.flags & ALTERNATE) != 0) && (base == 8) && (zeros == 0) && ((count == 0) || (digits[count - 1] != '0'))) {
+		zeros = 1;
+	}
+	char sign = negative ? '-' : ((specification.flags & PLUS) != 0) ? '+' : ((specification.flags & SPACE) != 0) ? ' ' : '\0';
+	bool prefix = ((specification.flags & ALTERNATE) != 0) && (base == 16) && nonzero;
+	uint8_t size = count + zeros + ((sign != '\0') ? 1 : 0) + (prefix ? 2 : 0);
+	uint8_t padding = (specification.width > size) ? (specification.width - size) : 0;
+	if (((specification.flags & (ZERO | LEFT)) == ZERO) && (specification.precision == NONE)) {
+		zeros += padding;
+		padding = 0;
+	}
+	if ((specification.flags & LEFT) == 0) { pad(output, ' ', padding); }
+	if (sign != '\0') { output.put(sign); }
+	if (prefix) { output.put('0'); output.put(upper ? 'X' : 'x'); }
+	pad(output, '0', zeros);
+	while (count > 0) { output.put(digits[--count]); }
+	if ((specification.flags & LEFT) != 0) { pad(output, ' ', padding); }
+}
+
+void FormatterBase::string(Output & output, const Specification & specification, const char * string, bool progmem) {
+	size_t length = (string == 0) ? 0 : progmem ? strlen_P(string) : strlen(string);
+	if ((specification.precision != NONE) && (specification.precision < length)) {
+		length = specification.precision;
+	}
+	uint8_t padding = (specification.width > length) ? (specification.width - length) : 0;
+	if ((specification.flags & LEFT) == 0) { pad(output, ' ', padding); }
+	if (length < BUFFER) {
+		for (size_t ii = 0; ii < length; ++ii) {
+			output.put(progmem ? static_cast<char>(pgm_read_byte(&string[ii])) : string[ii]);
+		}
+	} else {
+		// A long string is written directly rather than through the buffer.
+		output.flush();
+		output.total += progmem ? output.sink->write_P(string, length) : output.sink->write(string, length);
+	}
+	if ((specification.flags & LEFT) != 0) { pad(output, ' ', padding); }
+}
+
+}
+}
+}
+
+// Used by applications.
+template class com::diag::amigo::Formatter<true>;
+template class com::diag::amigo::Formatter<false>;
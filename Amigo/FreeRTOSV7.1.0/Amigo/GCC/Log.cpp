@@ -0,0 +1,170 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include <stdarg.h>
+#include <string.h>
+#include "com/diag/amigo/Log.h"
+#include "com/diag/amigo/Task.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+// The longest thing encoded into the buffer at one time is a variable length
+// long long (ten bytes) or a double.
+static const size_t MARGIN = (((sizeof(unsigned long long) * 8) + 6) / 7);
+
+static size_t varint64(uint8_t * buffer, unsigned long long value) {
+	size_t length = 0;
+	while (value > 0x7f) {
+		buffer[length++] = static_cast<uint8_t>(value) | 0x80;
+		value >>= 7;
+	}
+	buffer[length++] = static_cast<uint8_t>(value);
+	return length;
+}
+
+static size_t zigzag64(uint8_t * buffer, long long value) {
+	return varint64(buffer, (static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> ((sizeof(value) * 8) - 1)));
+}
+
+size_t Log::varint(uint8_t * buffer, unsigned long value) {
+	size_t length = 0;
+	while (value > 0x7f) {
+		buffer[length++] = static_cast<uint8_t>(value) | 0x80;
+		value >>= 7;
+	}
+	buffer[length++] = static_cast<uint8_t>(value);
+	return length;
+}
+
+size_t Log::operator() (PGM_P format, ...) {
+	uint8_t buffer[MARGIN * 2];
+	size_t length = 0;
+	size_t total = 0;
+	va_list ap;
+
+	buffer[length++] = RECORD;
+	length += varint(&buffer[length], reinterpret_cast<uintptr_t>(format));
+	length += varint(&buffer[length], static_cast<unsigned long>(Task::elapsed()));
+
+	// This scan must consume arguments exactly as vsnprintf_P would, and
+	// exactly as the decoder does.
+	va_start(ap, format);
+	PGM_P here = format;
+	uint8_t ch;
+	while ((ch = pgm_read_byte(here++)) != '\0') {
+		if (ch != '%') { continue; }
+		uint8_t longs = 0;
+		bool extended = false;
+		bool converting = true;
+		while (converting) {
+			if (length > (sizeof(buffer) - MARGIN)) {
+				total += sink->write(buffer, length);
+				length = 0;
+			}
+			ch = pgm_read_byte(here++);
+			switch (ch) {
+			case '\0':
+				--here;
+				converting = false;
+				break;
+			case '-': case '+': case ' ': case '#': case '.':
+			case '0': case '1': case '2': case '3': case '4':
+			case '5': case '6': case '7': case '8': case '9':
+			case 'h':
+				break;
+			case 'l':
+				++longs;
+				break;
+			case 'j':
+				longs = 2;
+				break;
+			case 'L':
+				extended = true;
+				break;
+			case 'z': case 't':
+				if (sizeof(size_t) > sizeof(unsigned int)) { longs = 1; }
+				break;
+			case '*':
+				length += zigzag(&buffer[length], static_cast<long>(va_arg(ap, int)));
+				break;
+			case 'd': case 'i':
+				if (longs == 0) {
+					length += zigzag(&buffer[length], static_cast<long>(va_arg(ap, int)));
+				} else if (longs == 1) {
+					length += zigzag(&buffer[length], va_arg(ap, long));
+				} else {
+					length += zigzag64(&buffer[length], va_arg(ap, long long));
+				}
+				converting = false;
+				break;
+			case 'o': case 'u': case 'x': case 'X':
+				if (longs == 0) {
+					length += varint(&buffer[length], static_cast<unsigned long>(va_arg(ap, unsigned int)));
+				} else if (longs == 1) {
+					length += varint(&buffer[length], va_arg(ap, unsigned long));
+				} else {
+					length += varint64(&buffer[length], va_arg(ap, unsigned long long));
+				}
+				converting = false;
+				break;
+			case 'c':
+				length += varint(&buffer[length], static_cast<unsigned long>(static_cast<unsigned char>(va_arg(ap, int))));
+				converting = false;
+				break;
+			case 'p':
+				length += varint(&buffer[length], static_cast<unsigned long>(reinterpret_cast<uintptr_t>(va_arg(ap, void *))));
+				converting = false;
+				break;
+			case 'S':
+				length += varint(&buffer[length], static_cast<unsigned long>(reinterpret_cast<uintptr_t>(va_arg(ap, PGM_P))));
+				converting = false;
+				break;
+			case 's':
+				{
+					const char * string = va_arg(ap, const char *);
+					size_t size = (string != 0) ? strlen(string) : 0;
+					length += varint(&buffer[length], static_cast<unsigned long>(size));
+					total += sink->write(buffer, length);
+					length = 0;
+					if (size > 0) {
+						total += sink->write(string, size);
+					}
+				}
+				converting = false;
+				break;
+			case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+				{
+					// A long double is narrowed to a double (on the AVR they
+					// are the same) so that the record is always the same size.
+					double value = extended ? static_cast<double>(va_arg(ap, long double)) : va_arg(ap, double);
+					memcpy(&buffer[length], &value, sizeof(value));
+					length += sizeof(value);
+				}
+				converting = false;
+				break;
+			default:
+				// This includes %% which consumes no argument.
+				converting = false;
+				break;
+			}
+		}
+	}
+	va_end(ap);
+
+	if (length > 0) {
+		total += sink->write(buffer, length);
+	}
+
+	return total;
+}
+
+}
+}
+}
@@ -0,0 +1,64 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/Pool.h"
+#include "com/diag/amigo/target/Uninterruptible.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+Allocator::Allocator(void * storage, size_t myblocksize, size_t myblocks)
+: head(0)
+, blocksize(myblocksize)
+, blocks(myblocks)
+, unallocated(myblocks)
+, lowwater(myblocks)
+{
+	// Thread the free list from the end so that blocks are allocated in
+	// address order to begin with.
+	size_t stride = COM_DIAG_AMIGO_POOL_STRIDE(blocksize);
+	uint8_t * here = static_cast<uint8_t *>(storage) + (stride * blocks);
+	for (size_t ii = 0; ii < blocks; ++ii) {
+		here -= stride;
+		Block * block = reinterpret_cast<Block *>(here);
+		block->header.next = head;
+		head = block;
+	}
+}
+
+void * Allocator::allocate(size_t size) {
+	Block * block = 0;
+	if (size <= blocksize) {
+		Uninterruptible uninterruptible;
+		block = head;
+		if (block != 0) {
+			head = block->header.next;
+			block->header.owner = this;
+			if ((--unallocated) < lowwater) {
+				lowwater = unallocated;
+			}
+		}
+	}
+	return (block != 0) ? (block + 1) : 0;
+}
+
+void Allocator::deallocate(void * ptr) {
+	if (ptr != 0) {
+		Block * block = static_cast<Block *>(ptr) - 1;
+		Uninterruptible uninterruptible;
+		Allocator * that = block->header.owner;
+		block->header.next = that->head;
+		that->head = block;
+		++that->unallocated;
+	}
+}
+
+}
+}
+}
@@ -0,0 +1,118 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include <unistd.h>
+#include <errno.h>
+#include "com/diag/amigo/target/Console.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+static const char HEX[] PROGMEM = "0123456789ABCDEF";
+
+// See comments on the constructor below for caveats.
+static Console console;
+
+// See comments on the constructor below for caveats.
+Console & Console::instance() {
+	return console;
+}
+
+// For this to avoid the dreaded "static initialization order fiasco" it
+// absolutely cannot refer to a static member of any other class. This is
+// pretty simple however since the role of Console is to provide a way to
+// debug code when just about nothing else is working. Since this constructor
+// does nothing at all, this isn't an issue.
+Console::Console()
+{}
+
+Console::~Console() {
+}
+
+inline void Console::emit(uint8_t ch) {
+	// Standard error is unbuffered, and this is only used for debugging, so
+	// a system call per character is acceptable.
+	while ((::write(STDERR_FILENO, &ch, sizeof(ch)) < 0) && (errno == EINTR)) {
+		// Do nothing: interrupted by the simulator tick signal.
+	}
+}
+
+Console & Console::start(uint32_t rate) {
+	return *this;
+}
+
+Console & Console::stop() {
+	return *this;
+}
+
+Console & Console::write(uint8_t ch) {
+	emit(ch);
+	return *this;
+}
+
+Console & Console::write(const char * string) {
+	while (*string != '\0') {
+		emit(*(string++));
+	}
+	return *this;
+}
+
+Console & Console::write_P(PGM_P string) {
+	uint8_t ch;
+	while ((ch = pgm_read_byte(string++)) != '\0') {
+		emit(ch);
+	}
+	return *this;
+}
+
+Console & Console::write(const void * data, size_t size) {
+	const uint8_t * here = static_cast<const uint8_t *>(data);
+	while ((size--) > 0) {
+		emit(*(here++));
+	}
+	return *this;
+}
+
+Console & Console::write_P(PGM_VOID_P data, size_t size) {
+	PGM_P here = static_cast<PGM_P>(data);
+	while ((size--) > 0) {
+		emit(pgm_read_byte(here++));
+	}
+	return *this;
+}
+
+Console & Console::dump(const void * data, size_t size) {
+	const uint8_t * here = static_cast<const uint8_t *>(data);
+	uint8_t datum;
+	while ((size--) > 0) {
+		datum = *(here++);
+		emit(pgm_read_byte(&HEX[datum >> 4]));
+		emit(pgm_read_byte(&HEX[datum & 0xf]));
+	}
+	return *this;
+}
+
+Console & Console::dump_P(PGM_VOID_P data, size_t size) {
+	PGM_P here = static_cast<PGM_P>(data);
+	uint8_t datum;
+	while ((size--) > 0) {
+		datum = pgm_read_byte(here++);
+		emit(pgm_read_byte(&HEX[datum >> 4]));
+		emit(pgm_read_byte(&HEX[datum & 0xf]));
+	}
+	return *this;
+}
+
+Console & Console::flush() {
+	return *this;
+}
+
+}
+}
+}
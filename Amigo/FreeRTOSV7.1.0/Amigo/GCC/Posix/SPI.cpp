@@ -0,0 +1,73 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include <string.h>
+#include "com/diag/amigo/target/SPI.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+SPI::SPI(Controller mycontroller, size_t transmits, size_t receives)
+: controller(mycontroller)
+, errors(0)
+, running(false)
+{
+	switch (controller) {
+
+	case SPI0:
+		break;
+
+	default:
+		controller = FAIL;
+		break;
+
+	}
+}
+
+SPI::~SPI() {
+	running = false;
+}
+
+void SPI::start(Divisor divisor, Role role, Order order, Polarity polarity, Phase phase) {
+	running = (controller != FAIL);
+}
+
+void SPI::stop() {
+	running = false;
+}
+
+void SPI::restart() {
+	running = (controller != FAIL);
+}
+
+int SPI::master(uint8_t ch, ticks_t timeout) {
+	return running ? ch : -1;
+}
+
+ssize_t SPI::transfer(const void * data, void * buffer, size_t length, ticks_t timeout) {
+	if (!running) {
+		return -1;
+	} else if (buffer == 0) {
+		// Do nothing: the received bytes are discarded.
+	} else if (data == 0) {
+		memset(buffer, 0, length);
+	} else {
+		memmove(buffer, data, length);
+	}
+	return length;
+}
+
+SPI & SPI::operator=(uint8_t value) {
+	errors = value;
+	return *this;
+}
+
+}
+}
+}
@@ -0,0 +1,255 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include "com/diag/amigo/target/Serial.h"
+#include "com/diag/amigo/Task.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+Serial::Serial(Port myport, size_t transmits, size_t receives, uint8_t mybad)
+: input(-1)
+, output(-1)
+, port(myport)
+, microseconds(0.0)
+, batch(0)
+, quiet(1)
+, pending(-1)
+, idle(IDLE)
+, bad(mybad)
+, errors(0)
+, running(false)
+{
+	const char * path;
+
+	name[0] = '\0';
+
+	switch (port) {
+
+	case USART0:
+		input = STDIN_FILENO;
+		output = STDOUT_FILENO;
+		break;
+
+	case USART1:
+	case USART2:
+	case USART3:
+		input = posix_openpt(O_RDWR | O_NOCTTY);
+		if (input < 0) {
+			// Do nothing.
+		} else if ((grantpt(input) < 0) || (unlockpt(input) < 0) || ((path = ptsname(input)) == 0) || (strlen(path) >= sizeof(name))) {
+			::close(input);
+			input = -1;
+		} else {
+			// ptsname() returns a static buffer that the next call by anyone
+			// overwrites, so we keep our own copy.
+			strcpy(name, path);
+			output = input;
+		}
+		break;
+
+	default:
+		break;
+
+	}
+}
+
+Serial::~Serial() {
+	if (port == USART0) {
+		// Do nothing.
+	} else if (input < 0) {
+		// Do nothing.
+	} else {
+		::close(input);
+	}
+}
+
+void Serial::start(Baud baud, Data data, Parity parity, Stop stop) {
+	static const uint32_t RATES[] = {
+		50UL, 75UL, 110UL, 134UL, 150UL, 200UL, 300UL, 600UL, 1200UL, 1800UL,
+		2400UL, 4800UL, 9600UL, 19200UL, 38400UL, 57600UL, 115200UL
+	};
+	start((baud < (sizeof(RATES) / sizeof(RATES[0]))) ? RATES[baud] : 115200UL, data, parity, stop);
+}
+
+void Serial::start(uint32_t rate, Data data, Parity parity, Stop stop) {
+	uint8_t bits = 1 + 5 + data + ((parity == NONE) ? 0 : 1) + ((stop == ONE) ? 1 : 2);
+	microseconds = (1000000.0 / rate) * 2 * bits; // uSec for two characters.
+	quiesce();
+	running = true;
+}
+
+void Serial::stop() {
+	running = false;
+}
+
+void Serial::restart() {
+	running = true;
+}
+
+int Serial::available() const {
+	int count = 0;
+	if (!running) {
+		return -1;
+	} else if (ioctl(input, FIONREAD, &count) < 0) {
+		return -1;
+	} else {
+		return count + ((pending < 0) ? 0 : 1);
+	}
+}
+
+void Serial::flush() {
+	// Do nothing: writes are synchronous.
+}
+
+bool Serial::wait(ticks_t timeout) {
+	ticks_t then = Task::elapsed();
+	while (true) {
+		if (!running) {
+			return false;
+		} else if (pending >= 0) {
+			return true;
+		} else {
+			struct pollfd poller = { input, POLLIN, 0 };
+			if (poll(&poller, 1, 0) > 0) {
+				return true;
+			} else if ((timeout != NEVER) && (static_cast<ticks_t>(Task::elapsed() - then) >= timeout)) {
+				return false;
+			} else {
+				Task::delay(1);
+			}
+		}
+	}
+}
+
+int Serial::peek(ticks_t timeout) {
+	if (pending >= 0) {
+		return pending;
+	} else if (!wait(timeout)) {
+		return -1;
+	} else {
+		pending = read(IMMEDIATELY);
+		return pending;
+	}
+}
+
+int Serial::read(ticks_t timeout) {
+	uint8_t ch;
+	ssize_t rc;
+	if (pending >= 0) {
+		ch = pending;
+		pending = -1;
+		return ch;
+	} else if (!wait(timeout)) {
+		return -1;
+	} else if ((rc = ::read(input, &ch, sizeof(ch))) == sizeof(ch)) {
+		return ch;
+	} else if ((rc < 0) && (errno == EINTR)) {
+		return read(timeout);
+	} else {
+		if (errors < ~static_cast<uint8_t>(0)) {
+			++errors;
+		}
+		return -1;
+	}
+}
+
+void Serial::clear(ticks_t timeout) {
+	while (read(timeout) >= 0) {
+		// Do nothing.
+	}
+}
+
+void Serial::quiesce() {
+	// The microseconds field is the time for two characters.
+	double milliseconds = (idle * microseconds) / 2000.0;
+	ticks_t ticks = static_cast<ticks_t>((milliseconds / Task::PERIOD) + 0.999);
+	quiet = (ticks > 0) ? ticks : 1;
+}
+
+void Serial::threshold(size_t count, uint8_t characters) {
+	idle = characters;
+	quiesce();
+	batch = count;
+}
+
+size_t Serial::read(void * buffer, size_t size, ticks_t timeout) {
+	uint8_t * here = static_cast<uint8_t *>(buffer);
+	size_t count = 0;
+	if (size == 0) {
+		return 0;
+	} else if (!wait(timeout)) {
+		return 0;
+	} else if (batch > 0) {
+		// Poll until the threshold is met or the count stops changing for
+		// the idle interval.
+		size_t limit = (batch < size) ? batch : size;
+		int before = available();
+		ticks_t since = Task::elapsed();
+		while ((before >= 0) && (static_cast<size_t>(before) < limit)) {
+			Task::delay(1);
+			int after = available();
+			if (after != before) {
+				before = after;
+				since = Task::elapsed();
+			} else if (static_cast<ticks_t>(Task::elapsed() - since) >= quiet) {
+				break;
+			} else {
+				// Do nothing.
+			}
+		}
+	} else {
+		// Do nothing.
+	}
+	int ch;
+	while ((count < size) && (available() > 0) && ((ch = read(IMMEDIATELY)) >= 0)) {
+		*(here++) = ch;
+		++count;
+	}
+	return count;
+}
+
+size_t Serial::write(const void * data, size_t size, ticks_t timeout) {
+	const uint8_t * here = static_cast<const uint8_t *>(data);
+	size_t count = 0;
+	ssize_t rc;
+	if (!running) {
+		return 0;
+	}
+	while (count < size) {
+		rc = ::write(output, here + count, size - count);
+		if (rc > 0) {
+			count += rc;
+		} else if ((rc < 0) && (errno == EINTR)) {
+			// Do nothing: interrupted by the simulator tick signal.
+		} else {
+			if (errors < ~static_cast<uint8_t>(0)) {
+				++errors;
+			}
+			break;
+		}
+	}
+	return count;
+}
+
+Serial & Serial::operator=(uint8_t value) {
+	errors = value;
+	return *this;
+}
+
+}
+}
+}
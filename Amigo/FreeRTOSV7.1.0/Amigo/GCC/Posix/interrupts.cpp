@@ -0,0 +1,14 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/target/interrupts.h"
+
+// Recursive so that Uninterruptible scopes can nest as they can on the target.
+pthread_mutex_t amigo_interrupts_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+volatile uint8_t amigo_interrupts_depth = 0;
@@ -0,0 +1,27 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include <time.h>
+#include "com/diag/amigo/target/runtime.h"
+#include "com/diag/amigo/types.h"
+
+static uint64_t epoch = 0;
+
+static uint64_t microseconds() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (static_cast<uint64_t>(now.tv_sec) * 1000000ULL) + (now.tv_nsec / 1000);
+}
+
+CXXCAPI void amigo_runtime_start(void) {
+	epoch = microseconds();
+}
+
+CXXCAPI unsigned long amigo_runtime_counter(void) {
+	return static_cast<unsigned long>(microseconds() - epoch);
+}
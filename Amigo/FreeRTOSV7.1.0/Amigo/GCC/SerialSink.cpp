@@ -19,6 +19,14 @@ size_t SerialSink::write(uint8_t ch) {
 	return serial->write(ch);
 }
 
+size_t SerialSink::write(const void * datum, size_t size) {
+	return serial->write(datum, size);
+}
+
+size_t SerialSink::write_P(PGM_VOID_P datum, size_t size) {
+	return serial->write_P(datum, size);
+}
+
 void SerialSink::flush() {
 	serial->flush();
 }
@@ -6,6 +6,7 @@
  * http://www.diag.com/navigation/downloads/Amigo.html\n
  */
 
+#include <string.h>
 #include "com/diag/amigo/Sink.h"
 
 namespace com {
@@ -33,22 +34,11 @@ size_t Sink::write_P(PGM_VOID_P datum, size_t size) {
 }
 
 size_t Sink::write(const char * string) {
-	const char * here = string;
-	while (*here != '\0') {
-		if (write(*here) != 1) { break; }
-		++here;
-	}
-	return (here - string);
+	return write(string, strlen(string));
 }
 
 size_t Sink::write_P(PGM_P string) {
-	PGM_P here = string;
-	uint8_t ch;
-	while ((ch = pgm_read_byte(here)) != '\0') {
-		if (write(ch) != 1) { break; }
-		++here;
-	}
-	return (here - string);
+	return write_P(string, strlen_P(string));
 }
 
 }
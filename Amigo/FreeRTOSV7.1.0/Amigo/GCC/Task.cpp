@@ -8,6 +8,8 @@
 
 #include "com/diag/amigo/Task.h"
 #include "com/diag/amigo/fatal.h"
+#include "com/diag/amigo/Print.h"
+#include "com/diag/amigo/countof.h"
 
 namespace com {
 namespace diag {
@@ -90,6 +92,26 @@ void Task::start(size_t mydepth, priority_t mypriority) {
 void Task::task() {
 }
 
+#if (configGENERATE_RUN_TIME_STATS == 1)
+
+size_t Task::cpu(Sink & sink) {
+	RunTime runtimes[RUNTIMES];
+	size_t count = cpu(runtimes, countof(runtimes));
+	unsigned long total = cpuTotal();
+	// Dividing the total first keeps the arithmetic within 32 bits.
+	unsigned long hundredth = total / 100;
+	if (hundredth == 0) { hundredth = 1; }
+	Print printf(sink, true);
+	printf(PSTR("%-8s %10s %4s\n"), "TASK", "TICKS", "%CPU");
+	for (size_t ii = 0; ii < count; ++ii) {
+		printf(PSTR("%-8s %10lu %4lu\n"), runtimes[ii].pcTaskName, runtimes[ii].ulRunTimeCounter, runtimes[ii].ulRunTimeCounter / hundredth);
+	}
+	printf(PSTR("%-8s %10lu\n"), "TOTAL", total);
+	return count;
+}
+
+#endif
+
 }
 }
 }
@@ -0,0 +1,119 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/Telegraph.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+Telegraph::Telegraph(GPIO::Pin pin, ticks_t myunit)
+: Timer((myunit > 0) ? myunit : 1, true, "Telegraph")
+, gpio(GPIO::gpio2base(pin))
+, unit((myunit > 0) ? myunit : 1)
+, mask(GPIO::gpio2mask(pin))
+, remaining(0)
+{
+	gpio.output(mask, 0);
+}
+
+Telegraph::~Telegraph() {
+	gpio.clear(mask);
+}
+
+size_t Telegraph::blink(const uint8_t * elements, size_t count) {
+	size_t result = 0;
+	while (result < count) {
+		uint8_t element = elements[result];
+		if ((element & UNITS) == 0) {
+			element |= 1;
+		}
+		if (!ring.put(&element)) {
+			break;
+		}
+		++result;
+	}
+	return result;
+}
+
+bool Telegraph::morse(const char * code) {
+	static const uint8_t DOT[] = { ON | 1, 1 };
+	static const uint8_t DASH[] = { ON | 3, 1 };
+	static const uint8_t LETTER[] = { 2 };
+	static const uint8_t WORD[] = { 6 };
+	bool result = true;
+	const uint8_t * elements;
+	size_t count;
+	while (result && (*code != '\0')) {
+		switch (*(code++)) {
+		case '.':
+			elements = DOT;
+			count = sizeof(DOT);
+			break;
+		case '-':
+			elements = DASH;
+			count = sizeof(DASH);
+			break;
+		case ',':
+			elements = LETTER;
+			count = sizeof(LETTER);
+			break;
+		default:
+		case ' ':
+			elements = WORD;
+			count = sizeof(WORD);
+			break;
+		}
+		result = (blink(elements, count) == count);
+	}
+	return result;
+}
+
+void Telegraph::tick() {
+	uint8_t element;
+	if (remaining > 1) {
+		--remaining;
+	} else if (ring.get(&element)) {
+		if ((element & ON) != 0) {
+			gpio.set(mask);
+		} else {
+			gpio.clear(mask);
+		}
+		remaining = element & UNITS;
+	} else if (remaining > 0) {
+		gpio.clear(mask);
+		remaining = 0;
+	} else {
+		// Do nothing: idle.
+	}
+}
+
+void Telegraph::drain() {
+	double microseconds = Task::ticks2milliseconds(unit) * 1000.0;
+	uint8_t element;
+	while (ring.get(&element)) {
+		if ((element & ON) != 0) {
+			gpio.set(mask);
+		} else {
+			gpio.clear(mask);
+		}
+		for (uint8_t ii = element & UNITS; ii > 0; --ii) {
+			Task::busywait(microseconds);
+		}
+	}
+	gpio.clear(mask);
+	remaining = 0;
+}
+
+void Telegraph::timer() {
+	tick();
+}
+
+}
+}
+}
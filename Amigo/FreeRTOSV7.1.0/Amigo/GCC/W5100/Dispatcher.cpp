@@ -0,0 +1,154 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "com/diag/amigo/W5100/Dispatcher.h"
+#include "com/diag/amigo/target/GPIO.h"
+#include "com/diag/amigo/target/Uninterruptible.h"
+
+// The W5100 /INT output is on Arduino digital pin 2 on both the Arduino
+// Ethernet shield (when jumpered) and the Freetronics boards. These are the
+// external interrupt registers and bits for that pin.
+
+#if defined(__AVR_ATmega2560__)
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_PIN		com::diag::amigo::GPIO::PIN_E4
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_EICR		EICRB
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_ISC		(_BV(ISC41) | _BV(ISC40))
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_INT		_BV(INT4)
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_INTF		_BV(INTF4)
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_VECTOR	INT4_vect
+#elif defined(__AVR_ATmega328P__)
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_PIN		com::diag::amigo::GPIO::PIN_D2
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_EICR		EICRA
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_ISC		(_BV(ISC01) | _BV(ISC00))
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_INT		_BV(INT0)
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_INTF		_BV(INTF0)
+#	define COM_DIAG_AMIGO_W5100_DISPATCHER_VECTOR	INT0_vect
+#else
+#	error Dispatcher must be modified for this microcontroller!
+#endif
+
+namespace com {
+namespace diag {
+namespace amigo {
+namespace W5100 {
+
+/**
+ * This is filled in with the this pointer of the Dispatcher when it is
+ * instantiated. There is only one /INT line, so there is only one entry.
+ */
+static Dispatcher * dispatcher = 0;
+
+Dispatcher::Dispatcher(W5100 & myw5100, const char * myname)
+: Task(myname)
+, w5100(&myw5100)
+, count(0)
+{
+	// FreeRTOS binary semaphores are created full. We want the first take to
+	// block until there is actually an event.
+	asserted.take(IMMEDIATELY);
+	for (uint8_t ii = 0; ii < W5100::SOCKETS; ++ii) {
+		events[ii].take(IMMEDIATELY);
+	}
+	dispatcher = this;
+}
+
+Dispatcher::~Dispatcher() {
+	{
+		Uninterruptible uninterruptible;
+		EIMSK &= ~COM_DIAG_AMIGO_W5100_DISPATCHER_INT;
+	}
+	dispatcher = 0;
+}
+
+void Dispatcher::task() {
+	GPIO gpio(GPIO::gpio2base(COM_DIAG_AMIGO_W5100_DISPATCHER_PIN));
+	gpio.pulledup(GPIO::gpio2mask(COM_DIAG_AMIGO_W5100_DISPATCHER_PIN));
+
+	w5100->enable();
+
+#if defined(COM_DIAG_AMIGO_W5100_DISPATCHER_USES_ISR)
+	{
+		// A low level (both ISC bits clear) generates the interrupt for as
+		// long as /INT is asserted, so an event can't be lost between the
+		// time we clear the W5100 and the time we unmask the interrupt.
+		Uninterruptible uninterruptible;
+		COM_DIAG_AMIGO_W5100_DISPATCHER_EICR &= ~COM_DIAG_AMIGO_W5100_DISPATCHER_ISC;
+		EIFR = COM_DIAG_AMIGO_W5100_DISPATCHER_INTF;
+		EIMSK |= COM_DIAG_AMIGO_W5100_DISPATCHER_INT;
+	}
+#endif
+
+	while (!stopping) {
+		if (!asserted.take(PATIENCE)) {
+#if defined(COM_DIAG_AMIGO_W5100_DISPATCHER_USES_ISR)
+			continue;
+#else
+			// Without the ISR nothing ever gives the semaphore, so we poll
+			// the W5100 once per PATIENCE instead.
+#endif
+		}
+		uint8_t pending = w5100->collect();
+		for (uint8_t ii = 0; ii < W5100::SOCKETS; ++ii) {
+			if ((pending & (1 << ii)) != 0) {
+				events[ii].give();
+			}
+		}
+#if defined(COM_DIAG_AMIGO_W5100_DISPATCHER_USES_ISR)
+		{
+			Uninterruptible uninterruptible;
+			EIMSK |= COM_DIAG_AMIGO_W5100_DISPATCHER_INT;
+		}
+#endif
+	}
+
+	{
+		Uninterruptible uninterruptible;
+		EIMSK &= ~COM_DIAG_AMIGO_W5100_DISPATCHER_INT;
+	}
+
+	w5100->enable(0);
+}
+
+void Dispatcher::interrupt() {
+	// Only called from an ISR hence implicitly uninterruptible.
+	EIMSK &= ~COM_DIAG_AMIGO_W5100_DISPATCHER_INT;
+	if (dispatcher != 0) {
+		++(dispatcher->count);
+		bool woken = false;
+		dispatcher->asserted.giveFromISR(woken);
+		if (woken) {
+			// See the comments in SPI.cpp.
+			Task::yield();
+		}
+	}
+}
+
+}
+}
+}
+}
+
+#if defined(COM_DIAG_AMIGO_W5100_DISPATCHER_USES_ISR)
+
+// This is the ISR routine which is jumped to from an ISR vector in low memory.
+// Note that this function has C linkage. Because every Amigo object file is
+// linked into the image, it is only compiled in when the application asks for
+// it; otherwise the external interrupt vector is left to the application (or
+// to the unexpected interrupt handler).
+
+extern "C" {
+
+ISR(COM_DIAG_AMIGO_W5100_DISPATCHER_VECTOR) {
+	com::diag::amigo::W5100::Dispatcher::interrupt();
+}
+
+}
+
+#endif
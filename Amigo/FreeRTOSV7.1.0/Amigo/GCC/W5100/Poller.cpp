@@ -0,0 +1,26 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/W5100/Poller.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+namespace W5100 {
+
+Poller::~Poller() {
+}
+
+void Poller::timer() {
+	Socket::service();
+}
+
+}
+}
+}
+}
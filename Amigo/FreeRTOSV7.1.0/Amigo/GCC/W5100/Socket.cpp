@@ -12,6 +12,7 @@
  */
 
 #include "com/diag/amigo/W5100/Socket.h"
+#include "com/diag/amigo/W5100/Dispatcher.h"
 #include "com/diag/amigo/CriticalSection.h"
 #include "com/diag/amigo/countof.h"
 
@@ -22,6 +23,8 @@ namespace W5100 {
 
 static MutexSemaphore * mutex = 0;
 
+static Dispatcher * dispatcher = 0;
+
 static Socket::socket_t nextsocket = 0;
 
 static Socket::port_t nextport = Socket::LOCALPORT;
@@ -34,6 +37,47 @@ void Socket::provide(MutexSemaphore & mymutex) {
 	mutex = &mymutex;
 }
 
+void Socket::provide(Dispatcher * mydispatcher) {
+	dispatcher = mydispatcher;
+}
+
+void Socket::service() {
+	// This runs in the timer task, which must never block, so if some other
+	// task holds the mutex we just try again on the next poll. The same goes
+	// for the mutex of each W5100, which a task may hold for a bulk transfer.
+	if ((mutex != 0) && (!mutex->take(IMMEDIATELY))) {
+		return;
+	}
+
+	Socket * done[W5100::SOCKETS];
+	ssize_t sent[W5100::SOCKETS];
+	uint8_t count = 0;
+
+	for (uint8_t ii = 0; ii < countof(sockets); ++ii) {
+		if (sockets[ii] == 0) {
+			// Do nothing.
+		} else if (!sockets[ii]->posted()) {
+			// Do nothing.
+		} else if (!sockets[ii]->w5100->take(IMMEDIATELY)) {
+			// Do nothing.
+		} else {
+			sent[count] = sockets[ii]->check();
+			sockets[ii]->w5100->give();
+			if (sent[count] >= 0) {
+				done[count++] = sockets[ii];
+			}
+		}
+	}
+
+	if (mutex != 0) {
+		mutex->give();
+	}
+
+	for (uint8_t ii = 0; ii < count; ++ii) {
+		done[ii]->completed(sent[ii]);
+	}
+}
+
 Socket::socket_t Socket::allocate(socket_t sock) {
 	if (sock >= W5100::SOCKETS) {
 		socket_t candidate;
@@ -124,7 +168,7 @@ bool Socket::bind(Protocol protocol, port_t port, uint8_t flag) {
 	port = allocate(sock, port);
 
 	w5100->execCmdSn(sock, W5100::Sock_CLOSE);
-	w5100->writeSnIR(sock, 0xFF);
+	w5100->acknowledge(sock, 0xFF);
 	w5100->writeSnMR(sock, proto | flag);
 	w5100->writeSnPORT(sock, port);
 	w5100->execCmdSn(sock, W5100::Sock_OPEN);
@@ -137,15 +181,28 @@ void Socket::close() {
 		return;
 	}
 
-	CriticalSection cs(mutex);
+	bool abandoned = false;
 
-	w5100->execCmdSn(sock, W5100::Sock_CLOSE);
-	w5100->writeSnIR(sock, 0xFF);
+	{
+		CriticalSection cs(mutex);
+
+		w5100->execCmdSn(sock, W5100::Sock_CLOSE);
+		w5100->acknowledge(sock, 0xFF);
 
-	deallocate(sock, NOPORT);
-	deallocate(sock);
+		if (pending > 0) {
+			pending = 0;
+			abandoned = true;
+		}
+
+		deallocate(sock, NOPORT);
+		deallocate(sock);
+
+		sock = NOSOCKET;
+	}
 
-	sock = NOSOCKET;
+	if (abandoned) {
+		completed(0);
+	}
 }
 
 bool Socket::listen() {
@@ -169,9 +226,14 @@ bool Socket::accept(ticks_t timeout, ticks_t iteration) {
 		return false;
 	}
 
-	CriticalSection cs(mutex);
+	uint8_t state;
+
+	{
+		CriticalSection cs(mutex);
+
+		state = w5100->state(sock);
+	}
 
-	uint8_t state = w5100->state(sock);
 	if ((state == W5100::SnSR::ESTABLISHED) || (state == W5100::SnSR::CLOSE_WAIT)) {
 		return true;
 	}
@@ -184,7 +246,12 @@ bool Socket::accept(ticks_t timeout, ticks_t iteration) {
 
 	while (true) {
 
-		Task::delay(iteration);
+		// We don't hold the mutex while we wait so that other tasks can use
+		// the W5100 in the meantime. If there is a Dispatcher, this returns
+		// as soon as the W5100 reports an event on this socket.
+		wait(iteration);
+
+		CriticalSection cs(mutex);
 
 		if (sock >= W5100::SOCKETS) {
 			break;
@@ -315,42 +382,50 @@ ssize_t Socket::send(const void * data, size_t length) {
 		return -2;
 	}
 
-	ssize_t result = (length < W5100::SSIZE) ? length : W5100::SSIZE; // check size not to exceed MAX size.
+	ssize_t result = (length < w5100->txsize(sock)) ? length : w5100->txsize(sock); // check size not to exceed MAX size.
 	size_t freesize;
 	uint8_t state;
 
-	CriticalSection cs(mutex);
+	if (result == 0) {
+		return 0;
+	}
 
-	// If freebuf is available, start.
-	do {
-		freesize = w5100->getTXFreeSize(sock);
-		state = w5100->state(sock);
+	// If freebuf is available, start. We don't hold the mutex while we wait
+	// so that other tasks can use the W5100 in the meantime.
+	while (true) {
+		{
+			CriticalSection cs(mutex);
+
+			freesize = w5100->getTXFreeSize(sock);
+			state = w5100->state(sock);
+		}
 		if ((state != W5100::SnSR::ESTABLISHED) && (state != W5100::SnSR::CLOSE_WAIT)) {
-			result = 0;
+			return 0;
+		}
+		if (freesize >= result) {
 			break;
 		}
-	} while (freesize < result);
+		pause();
+	}
 
-	// Copy data.
-	w5100->send_data_processing(sock, data, result);
-	w5100->execCmdSn(sock, W5100::Sock_SEND);
+	{
+		CriticalSection cs(mutex);
 
-	/* +2008.01 bj */
-	while ((w5100->readSnIR(sock) & W5100::SnIR::SEND_OK) != W5100::SnIR::SEND_OK) {
-		/* m2008.01 [bj] : reduce code */
-		if (w5100->state(sock) == W5100::SnSR::CLOSED) {
-			close();
-			return 0;
+		// Copy data.
+		if (!w5100->send_data_processing(sock, data, result)) {
+			return -1;
 		}
+		w5100->execCmdSn(sock, W5100::Sock_SEND);
 	}
 
-	/* +2008.01 bj */
-	w5100->writeSnIR(sock, W5100::SnIR::SEND_OK);
+	if (sent() != W5100::SnIR::SEND_OK) {
+		close();
+		return 0;
+	}
 
 	return result;
 }
 
-
 ssize_t Socket::recv(void * buffer, size_t length) {
 	if (sock >= W5100::SOCKETS) {
 		return -2;
@@ -379,13 +454,159 @@ ssize_t Socket::recv(void * buffer, size_t length) {
 	}
 
 	if (result > 0) {
-		w5100->recv_data_processing(sock, buffer, result);
+		if (!w5100->recv_data_processing(sock, buffer, result)) {
+			return -1;
+		}
 		w5100->execCmdSn(sock, W5100::Sock_RECV);
 	}
 
 	return result;
 }
 
+ssize_t Socket::send(Source & source, size_t length) {
+	if (sock >= W5100::SOCKETS) {
+		return -2;
+	}
+
+	size_t freesize;
+	uint8_t state;
+
+	// Wait for at least some room in the transmit buffer. Since we don't know
+	// how much data the Source will provide, we take what we can get.
+	while (true) {
+		{
+			CriticalSection cs(mutex);
+
+			freesize = w5100->getTXFreeSize(sock);
+			state = w5100->state(sock);
+		}
+		if ((state != W5100::SnSR::ESTABLISHED) && (state != W5100::SnSR::CLOSE_WAIT)) {
+			return 0;
+		}
+		if (freesize > 0) {
+			break;
+		}
+		pause();
+	}
+
+	if (length > freesize) {
+		length = freesize;
+	}
+
+	// Each call to send_data_processing() advances the transmit write
+	// pointer, so the chunks are appended one after the other. If one fails,
+	// the pointer is put back where it started so that the chunks already
+	// copied aren't sent ahead of the next payload.
+	W5100::address_t pointer;
+	{
+		CriticalSection cs(mutex);
+
+		pointer = w5100->readSnTX_WR(sock);
+	}
+	uint8_t chunk[CHUNK];
+	size_t result = 0;
+	while (result < length) {
+		size_t size = source.read(chunk, ((length - result) < sizeof(chunk)) ? (length - result) : sizeof(chunk));
+		if (size == 0) {
+			break;
+		}
+		if (!w5100->send_data_processing(sock, chunk, size)) {
+			CriticalSection cs(mutex);
+
+			w5100->writeSnTX_WR(sock, pointer);
+			return -1;
+		}
+		result += size;
+	}
+
+	if (result == 0) {
+		return 0;
+	}
+
+	{
+		CriticalSection cs(mutex);
+
+		w5100->execCmdSn(sock, W5100::Sock_SEND);
+	}
+
+	if (sent() != W5100::SnIR::SEND_OK) {
+		close();
+		return 0;
+	}
+
+	return result;
+}
+
+ssize_t Socket::recv(Sink & sink, size_t length) {
+	if (sock >= W5100::SOCKETS) {
+		return -2;
+	}
+
+	size_t result;
+	W5100::address_t pointer;
+
+	{
+		CriticalSection cs(mutex);
+
+		result = w5100->getRXReceivedSize(sock); // Check how much data is available
+
+		if (result == 0) {
+			// No data available.
+			switch (w5100->state(sock)) {
+			case W5100::SnSR::LISTEN:
+			case W5100::SnSR::CLOSED:
+			case W5100::SnSR::CLOSE_WAIT:
+				// The remote end has closed its side of the connection: EOF.
+				return 0;
+			default:
+				// The connection is still up, but there's no data waiting to be read: ERROR.
+				return -1;
+			}
+		}
+
+		pointer = w5100->readSnRX_RD(sock);
+	}
+
+	if (result > length) {
+		result = length;
+	}
+
+	// Only the receive read pointer for this socket is involved, and no one
+	// else has any business with it, so the mutex isn't held while we write
+	// to the Sink.
+	uint8_t chunk[CHUNK];
+	size_t remaining = result;
+	bool failed = false;
+	while (remaining > 0) {
+		size_t size = (remaining < sizeof(chunk)) ? remaining : sizeof(chunk);
+		if (!w5100->read_data(sock, pointer, chunk, size)) {
+			failed = true;
+			break;
+		}
+		size_t written = sink.write(chunk, size);
+		pointer += written;
+		remaining -= written;
+		if (written < size) {
+			break;
+		}
+	}
+	result -= remaining;
+
+	if (result > 0) {
+		CriticalSection cs(mutex);
+
+		w5100->writeSnRX_RD(sock, pointer);
+		w5100->execCmdSn(sock, W5100::Sock_RECV);
+	} else if (failed) {
+		// Nothing reached the Sink, and zero would look like EOF.
+		return -1;
+	} else {
+		// Do nothing.
+	}
+
+	return result;
+}
+
 ssize_t Socket::peek(void * buffer) {
 	if (sock >= W5100::SOCKETS) {
 		return -2;
@@ -393,7 +614,9 @@ ssize_t Socket::peek(void * buffer) {
 
 	CriticalSection cs(mutex);
 
-	w5100->recv_data_processing(sock, buffer, 1, 1);
+	if (!w5100->recv_data_processing(sock, buffer, 1, 1)) {
+		return -1;
+	}
 
 	return 1;
 }
@@ -403,7 +626,7 @@ ssize_t Socket::sendto(const void * data, size_t length, const ipv4address_t * a
 		return -2;
 	}
 
-	ssize_t result = (length < W5100::SSIZE) ? length : W5100::SSIZE; // check size not to exceed MAX size.
+	ssize_t result = (length < w5100->txsize(sock)) ? length : w5100->txsize(sock); // check size not to exceed MAX size.
 
 	if (
 		((address[0] == 0x00) && (address[1] == 0x00) && (address[2] == 0x00) && (address[3] == 0x00)) ||
@@ -413,26 +636,22 @@ ssize_t Socket::sendto(const void * data, size_t length, const ipv4address_t * a
 		return 0;
 	}
 
-	CriticalSection cs(mutex);
-
-	w5100->writeSnDIPR(sock, address);
-	w5100->writeSnDPORT(sock, port);
+	{
+		CriticalSection cs(mutex);
 
-	// Copy data.
-	w5100->send_data_processing(sock, data, result);
-	w5100->execCmdSn(sock, W5100::Sock_SEND);
+		w5100->writeSnDIPR(sock, address);
+		w5100->writeSnDPORT(sock, port);
 
-	/* +2008.01 bj */
-	while ((w5100->readSnIR(sock) & W5100::SnIR::SEND_OK) != W5100::SnIR::SEND_OK) {
-		if (w5100->readSnIR(sock) & W5100::SnIR::TIMEOUT) {
-			/* +2008.01 [bj]: clear interrupt */
-			w5100->writeSnIR(sock, (W5100::SnIR::SEND_OK | W5100::SnIR::TIMEOUT)); /* clear SEND_OK & TIMEOUT */
-			return 0;
+		// Copy data.
+		if (!w5100->send_data_processing(sock, data, result)) {
+			return -1;
 		}
+		w5100->execCmdSn(sock, W5100::Sock_SEND);
 	}
 
-	/* +2008.01 bj */
-	w5100->writeSnIR(sock, W5100::SnIR::SEND_OK);
+	if (sent() != W5100::SnIR::SEND_OK) {
+		return 0;
+	}
 
 	return result;
 }
@@ -457,7 +676,9 @@ ssize_t Socket::recvfrom(void * buffer, size_t length, ipv4address_t * address,
 		switch (w5100->readSnMR(sock) & 0x07) {
 
 		case W5100::SnMR::UDP :
-			w5100->read_data(sock, ptr, head, 8);
+			if (!w5100->read_data(sock, ptr, head, 8)) {
+				return -1;
+			}
 			ptr += 8;
 
 			// read peer's IP address, port number.
@@ -470,14 +691,19 @@ ssize_t Socket::recvfrom(void * buffer, size_t length, ipv4address_t * address,
 			result = head[6];
 			result = (result << 8) + head[7];
 
-			w5100->read_data(sock, ptr, buffer, result); // Data copy.
+			// Data copy.
+			if (!w5100->read_data(sock, ptr, buffer, result)) {
+				return -1;
+			}
 			ptr += result;
 
 			w5100->writeSnRX_RD(sock, ptr);
 			break;
 
 		case W5100::SnMR::IPRAW :
-			w5100->read_data(sock, ptr, head, 6);
+			if (!w5100->read_data(sock, ptr, head, 6)) {
+				return -1;
+			}
 			ptr += 6;
 
 			address[0] = head[0];
@@ -487,20 +713,27 @@ ssize_t Socket::recvfrom(void * buffer, size_t length, ipv4address_t * address,
 			result = head[4];
 			result = (result << 8) + head[5];
 
-			w5100->read_data(sock, ptr, buffer, result); // Data copy.
+			// Data copy.
+			if (!w5100->read_data(sock, ptr, buffer, result)) {
+				return -1;
+			}
 			ptr += result;
 
 			w5100->writeSnRX_RD(sock, ptr);
 			break;
 
 		case W5100::SnMR::MACRAW:
-			w5100->read_data(sock, ptr, head, 2);
+			if (!w5100->read_data(sock, ptr, head, 2)) {
+				return -1;
+			}
 			ptr += 2;
 
 			result = head[0];
 			result = (result << 8) + head[1] - 2;
 
-			w5100->read_data(sock, ptr, buffer, result);
+			if (!w5100->read_data(sock, ptr, buffer, result)) {
+				return -1;
+			}
 			ptr += result;
 
 			w5100->writeSnRX_RD(sock, ptr);
@@ -523,29 +756,27 @@ ssize_t Socket::igmpsend(const void * data, size_t length) {
 		return -2;
 	}
 
-	ssize_t result = (length < W5100::SSIZE) ? length : W5100::SSIZE; // Check size not to exceed MAX size.
-	uint8_t status;
+	ssize_t result = (length < w5100->txsize(sock)) ? length : w5100->txsize(sock); // Check size not to exceed MAX size.
 
 	if (result == 0) {
 		return 0;
 	}
 
-	CriticalSection cs(mutex);
-
-	w5100->send_data_processing(sock, data, result);
-	w5100->execCmdSn(sock, W5100::Sock_SEND);
+	{
+		CriticalSection cs(mutex);
 
-	while ((w5100->readSnIR(sock) & W5100::SnIR::SEND_OK) != W5100::SnIR::SEND_OK) {
-		status = w5100->readSnSR(sock);
-		if ((w5100->readSnIR(sock) & W5100::SnIR::TIMEOUT) != 0) {
-			/* In case of IGMP, if send fails, then socket closed. */
-			/* If you want change, remove this code. */
-			close();
-			return 0;
+		if (!w5100->send_data_processing(sock, data, result)) {
+			return -1;
 		}
+		w5100->execCmdSn(sock, W5100::Sock_SEND);
 	}
 
-	w5100->writeSnIR(sock, W5100::SnIR::SEND_OK);
+	if (sent() != W5100::SnIR::SEND_OK) {
+		/* In case of IGMP, if send fails, then socket closed. */
+		/* If you want change, remove this code. */
+		close();
+		return 0;
+	}
 
 	return result;
 }
@@ -560,11 +791,115 @@ ssize_t Socket::bufferData(size_t offset, const void * data, size_t length) {
 	size_t free = w5100->getTXFreeSize(sock);
 	ssize_t result = (length < free) ? length : free;
 
-	w5100->send_data_processing_offset(sock, offset, data, result);
+	if (!w5100->send_data_processing_offset(sock, offset, data, result)) {
+		return -1;
+	}
 
 	return result;
 }
 
+ssize_t Socket::post(const void * data, size_t length, BinarySemaphore * mycompletion) {
+	if (sock >= W5100::SOCKETS) {
+		return -2;
+	}
+
+	ssize_t result = (length < w5100->txsize(sock)) ? length : w5100->txsize(sock); // check size not to exceed MAX size.
+
+	CriticalSection cs(mutex);
+
+	if (pending > 0) {
+		return 0;
+	}
+
+	switch (w5100->state(sock)) {
+	case W5100::SnSR::ESTABLISHED:
+	case W5100::SnSR::CLOSE_WAIT:
+	case W5100::SnSR::UDP:
+		break;
+	default:
+		return 0;
+	}
+
+	// Unlike send(), we don't wait for room in the transmit buffer. We send
+	// whatever fits and let the caller come back for the rest.
+	size_t freesize = w5100->getTXFreeSize(sock);
+	if (freesize < result) {
+		result = freesize;
+	}
+
+	if (result == 0) {
+		return 0;
+	}
+
+	if (!w5100->send_data_processing(sock, data, result)) {
+		return -1;
+	}
+
+	completion = mycompletion;
+	pending = result;
+
+	w5100->execCmdSn(sock, W5100::Sock_SEND);
+
+	return result;
+}
+
+bool Socket::complete() {
+	if (pending <= 0) {
+		return true;
+	}
+
+	ssize_t sent;
+
+	{
+		CriticalSection cs(mutex);
+
+		if (pending <= 0) {
+			return true;
+		}
+
+		sent = check();
+	}
+
+	if (sent < 0) {
+		return false;
+	}
+
+	completed(sent);
+
+	return true;
+}
+
+ssize_t Socket::check() {
+	ssize_t sent;
+
+	if (sock >= W5100::SOCKETS) {
+		sent = 0;
+	} else {
+		uint8_t ir = w5100->events(sock);
+		if ((ir & W5100::SnIR::SEND_OK) != 0) {
+			w5100->acknowledge(sock, W5100::SnIR::SEND_OK);
+			sent = pending;
+		} else if ((ir & W5100::SnIR::TIMEOUT) != 0) {
+			w5100->acknowledge(sock, (W5100::SnIR::SEND_OK | W5100::SnIR::TIMEOUT));
+			sent = 0;
+		} else if (w5100->state(sock) == W5100::SnSR::CLOSED) {
+			sent = 0;
+		} else {
+			return -1;
+		}
+	}
+
+	pending = -sent;
+
+	return sent;
+}
+
+void Socket::completed(ssize_t sent) {
+	if (completion != 0) {
+		completion->give();
+	}
+}
+
 bool Socket::startUDP(const ipv4address_t * address, port_t port) {
 	if (sock >= W5100::SOCKETS) {
 		return false;
@@ -590,25 +925,61 @@ bool Socket::sendUDP() {
 		return false;
 	}
 
-	CriticalSection cs(mutex);
+	{
+		CriticalSection cs(mutex);
 
-	w5100->execCmdSn(sock, W5100::Sock_SEND);
+		w5100->execCmdSn(sock, W5100::Sock_SEND);
+	}
 
-	/* +2008.01 bj */
-	while ((w5100->readSnIR(sock) & W5100::SnIR::SEND_OK) != W5100::SnIR::SEND_OK) {
-		if (w5100->readSnIR(sock) & W5100::SnIR::TIMEOUT)
+	/* Sent ok? */
+	return (sent() == W5100::SnIR::SEND_OK);
+}
+
+uint8_t Socket::sent() {
+	while (true) {
 		{
-			/* +2008.01 [bj]: clear interrupt */
-			w5100->writeSnIR(sock, (W5100::SnIR::SEND_OK | W5100::SnIR::TIMEOUT));
-			return false;
+			CriticalSection cs(mutex);
+
+			if (sock >= W5100::SOCKETS) {
+				return 0;
+			}
+
+			uint8_t ir = w5100->events(sock);
+			if ((ir & W5100::SnIR::SEND_OK) != 0) {
+				w5100->acknowledge(sock, W5100::SnIR::SEND_OK);
+				return W5100::SnIR::SEND_OK;
+			}
+			if ((ir & W5100::SnIR::TIMEOUT) != 0) {
+				w5100->acknowledge(sock, (W5100::SnIR::SEND_OK | W5100::SnIR::TIMEOUT));
+				return W5100::SnIR::TIMEOUT;
+			}
+			if (w5100->state(sock) == W5100::SnSR::CLOSED) {
+				return 0;
+			}
 		}
+		pause();
 	}
+}
 
-	/* +2008.01 bj */
-	w5100->writeSnIR(sock, W5100::SnIR::SEND_OK);
+void Socket::pause() {
+	if (dispatcher == 0) {
+		Task::yield();
+	} else if (sock >= W5100::SOCKETS) {
+		// Do nothing.
+	} else {
+		dispatcher->wait(sock, ITERATION);
+	}
+}
 
-	/* Sent ok. */
-	return true;
+bool Socket::wait(ticks_t timeout) {
+	if (sock >= W5100::SOCKETS) {
+		return false;
+	} else if (dispatcher != 0) {
+		return dispatcher->wait(sock, timeout);
+	} else {
+		Task::delay(timeout);
+		return false;
+	}
 }
 
 }
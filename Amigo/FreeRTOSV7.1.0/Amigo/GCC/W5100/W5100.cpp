@@ -27,15 +27,55 @@ namespace W5100 {
  ******************************************************************************/
 
 void W5100::initialize() {
+	layout(MSR, TXBUF_BASE, sbase, ssize);
+	layout(MSR, RXBUF_BASE, rbase, rsize);
 	for (uint8_t ii = 0; ii < SOCKETS; ++ii) {
-		sbase[ii] = TXBUF_BASE + (SSIZE * ii);
-		rbase[ii] = RXBUF_BASE + (RSIZE * ii);
+		latched[ii] = 0;
 	}
 }
 
 W5100::~W5100() {
 }
 
+/*******************************************************************************
+ * CONFIGURING MEMORY
+ ******************************************************************************/
+
+// Each socket gets two bits in the memory size register, socket 0 in the least
+// significant, encoding 1KB, 2KB, 4KB or 8KB. The W5100 hands out its memory
+// in socket order until it runs out. See "TMSR", p. 23.
+
+void W5100::layout(uint8_t msr, address_t origin, address_t * base, uint16_t * size) {
+	size_t remaining = MEMORY;
+	for (uint8_t ii = 0; ii < SOCKETS; ++ii) {
+		size_t requested = 1024U << ((msr >> (ii * 2)) & 0x3);
+		base[ii] = origin + (MEMORY - remaining);
+		size[ii] = (requested < remaining) ? requested : remaining;
+		remaining -= size[ii];
+	}
+}
+
+uint8_t W5100::msr(size_t size0, size_t size1, size_t size2, size_t size3) {
+	size_t size[SOCKETS] = { size0, size1, size2, size3 };
+	uint8_t result = 0;
+	for (uint8_t ii = 0; ii < SOCKETS; ++ii) {
+		uint8_t code = 0;
+		while ((code < 3) && (size[ii] >= (2048U << code))) {
+			++code;
+		}
+		result |= code << (ii * 2);
+	}
+	return result;
+}
+
+void W5100::configure(uint8_t tmsr, uint8_t rmsr) {
+	CriticalSection cs(mutex);
+	writeTMSR(tmsr);
+	writeRMSR(rmsr);
+	layout(tmsr, TXBUF_BASE, sbase, ssize);
+	layout(rmsr, RXBUF_BASE, rbase, rsize);
+}
+
 /*******************************************************************************
  * STARTING AND STOPPING
  ******************************************************************************/
@@ -47,11 +87,13 @@ void W5100::reset(ticks_t resetting) {
 	}
 }
 
-void W5100::start(ticks_t resetting) {
+void W5100::start(ticks_t resetting, uint8_t tmsr, uint8_t rmsr) {
 	gpio.output(mask, mask); // Active low hence initially high.
 	reset(resetting);
-	writeTMSR(0x55); // 2KB to each of four sockets for transmitting.
-	writeRMSR(0x55); // 2KB to each of four sockets for receiving.
+	for (uint8_t ii = 0; ii < SOCKETS; ++ii) {
+		latched[ii] = 0;
+	}
+	configure(tmsr, rmsr);
 }
 
 void W5100::stop(ticks_t resetting) {
@@ -62,47 +104,58 @@ void W5100::stop(ticks_t resetting) {
  * SPI ACTIONS
  ******************************************************************************/
 
-void W5100::write(address_t address, uint8_t datum) {
+bool W5100::write(address_t address, uint8_t datum) {
 	CriticalSection cs(mutex);
-	ToggleOff ss(gpio, mask);
-	spi->master(0xf0);
-	spi->master(address >> 8);
-	spi->master(address & 0xff);
-	spi->master(datum);
+	return (frame(OP_WRITE, address, datum) >= 0);
 }
 
-void W5100::write(address_t address, const void * data, size_t length) {
+// The mutex is taken once for the whole buffer, and the loop is unrolled by
+// four so that the per-byte cost is as close as we can get to the cost of the
+// frame itself. We can't do better than one frame per byte: the W5100 SPI
+// protocol requires the opcode and address in front of every single byte.
+// A failed frame ends the operation, since the SPI controller has already
+// given up on it and every frame after it would likely fail the same way.
+
+bool W5100::write(address_t address, const void * data, size_t length) {
 	CriticalSection cs(mutex);
 	const uint8_t * here = static_cast<const uint8_t *>(data);
+	for (; length >= 4; length -= 4) {
+		if (frame(OP_WRITE, address++, *(here++)) < 0) { return false; }
+		if (frame(OP_WRITE, address++, *(here++)) < 0) { return false; }
+		if (frame(OP_WRITE, address++, *(here++)) < 0) { return false; }
+		if (frame(OP_WRITE, address++, *(here++)) < 0) { return false; }
+	}
 	for (; length > 0; --length) {
-		ToggleOff ss(gpio, mask);
-		spi->master(0xf0);
-		spi->master(address >> 8);
-		spi->master((address++) & 0xff);
-		spi->master(*(here++));
+		if (frame(OP_WRITE, address++, *(here++)) < 0) { return false; }
 	}
+	return true;
 }
 
 uint8_t W5100::read(address_t address) {
 	CriticalSection cs(mutex);
-	ToggleOff ss(gpio, mask);
-	spi->master(0x0f);
-	spi->master(address >> 8);
-	spi->master(address & 0xff);
-	uint8_t datum = spi->master();
-	return datum;
+	int datum = frame(OP_READ, address);
+	return (datum < 0) ? 0 : datum;
 }
 
-void W5100::read(address_t address, void * buffer, size_t length) {
+bool W5100::read(address_t address, void * buffer, size_t length) {
 	CriticalSection cs(mutex);
 	uint8_t * here = static_cast<uint8_t *>(buffer);
+	int datum;
+	for (; length >= 4; length -= 4) {
+		if ((datum = frame(OP_READ, address++)) < 0) { return false; }
+		*(here++) = datum;
+		if ((datum = frame(OP_READ, address++)) < 0) { return false; }
+		*(here++) = datum;
+		if ((datum = frame(OP_READ, address++)) < 0) { return false; }
+		*(here++) = datum;
+		if ((datum = frame(OP_READ, address++)) < 0) { return false; }
+		*(here++) = datum;
+	}
 	for (; length > 0; --length) {
-		ToggleOff ss(gpio, mask);
-		spi->master(0x0f);
-		spi->master(address >> 8);
-		spi->master((address++) & 0xff);
-		*(here++) = spi->master();
-  }
+		if ((datum = frame(OP_READ, address++)) < 0) { return false; }
+		*(here++) = datum;
+	}
+	return true;
 }
 
 /***************************************************************************
@@ -147,51 +200,96 @@ size_t W5100::getRXReceivedSize(socket_t socket)
 	return val;
 }
 
-void W5100::send_data_processing_offset(socket_t socket, size_t displacement, const void * data, size_t length)
+bool W5100::send_data_processing_offset(socket_t socket, size_t displacement, const void * data, size_t length)
 {
+	// Hold the mutex across both halves of a wrap and the pointer update so
+	// the whole buffer is one acquisition (the mutex is recursive).
+	CriticalSection cs(mutex);
 	const uint8_t * here = static_cast<const uint8_t *>(data);
 	address_t address = readSnTX_WR(socket) + displacement;
-	size_t offset = address & SMASK;
+	size_t offset = address & (ssize[socket] - 1);
 	address_t pointer = sbase[socket] + offset;
 	size_t size;
 
-	if ((offset + length) > SSIZE) {
+	if ((offset + length) > ssize[socket]) {
 		// Wrap around circular buffer.
-		size = SSIZE - offset;
-		write(pointer, here, size);
-		write(sbase[socket], here + size, length - size);
+		size = ssize[socket] - offset;
+		if (!write(pointer, here, size)) {
+			return false;
+		}
+		if (!write(sbase[socket], here + size, length - size)) {
+			return false;
+		}
 	} else {
-		write(pointer, here, length);
+		if (!write(pointer, here, length)) {
+			return false;
+		}
 	}
 
 	writeSnTX_WR(socket, address + length);
+
+	return true;
 }
 
 
-void W5100::recv_data_processing(socket_t socket, void * buffer, size_t length, bool peek)
+bool W5100::recv_data_processing(socket_t socket, void * buffer, size_t length, bool peek)
 {
 	address_t address = readSnRX_RD(socket);
-	read_data(socket, address, buffer, length);
+	if (!read_data(socket, address, buffer, length)) {
+		return false;
+	}
 	if (!peek) {
 		writeSnRX_RD(socket, address + length);
 	}
+	return true;
 }
 
-void W5100::read_data(socket_t socket, address_t address, void * buffer, size_t length)
+bool W5100::read_data(socket_t socket, address_t address, void * buffer, size_t length)
 {
+	CriticalSection cs(mutex);
 	uint8_t * here = static_cast<uint8_t *>(buffer);
-	size_t offset = address & RMASK;
+	size_t offset = address & (rsize[socket] - 1);
 	address_t pointer = rbase[socket] + offset;
 	size_t size;
 
-	if ((offset + length) > RSIZE) {
+	if ((offset + length) > rsize[socket]) {
 		// Wrap around circular buffer.
-		size = RSIZE - offset;
-		read(pointer, here, size);
-		read(rbase[socket], here + size, length - size);
+		size = rsize[socket] - offset;
+		if (!read(pointer, here, size)) {
+			return false;
+		}
+		return read(rbase[socket], here + size, length - size);
 	} else {
-		read(pointer, here, length);
+		return read(pointer, here, length);
+	}
+}
+
+/***************************************************************************
+ * INTERRUPTING
+ **************************************************************************/
+
+uint8_t W5100::collect() {
+	CriticalSection cs(mutex);
+	uint8_t pending = readIR() & ((1 << SOCKETS) - 1);
+	for (uint8_t ii = 0; ii < SOCKETS; ++ii) {
+		if ((pending & (1 << ii)) != 0) {
+			uint8_t ir = readSnIR(ii);
+			latched[ii] |= ir;
+			writeSnIR(ii, ir);
+		}
 	}
+	return pending;
+}
+
+uint8_t W5100::events(socket_t socket) {
+	CriticalSection cs(mutex);
+	return latched[socket] | readSnIR(socket);
+}
+
+void W5100::acknowledge(socket_t socket, uint8_t acknowledged) {
+	CriticalSection cs(mutex);
+	latched[socket] &= ~acknowledged;
+	writeSnIR(socket, acknowledged);
 }
 
 }
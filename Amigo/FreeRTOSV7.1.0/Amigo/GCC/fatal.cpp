@@ -6,7 +6,6 @@
  * http://www.diag.com/navigation/downloads/Amigo.html\n
  */
 
-#include <avr/io.h>
 #include "com/diag/amigo/fatal.h"
 #include "com/diag/amigo/byteorder.h"
 #include "com/diag/amigo/target/watchdog.h"
@@ -202,9 +202,19 @@ A2D::A2D(Converter myconverter, size_t requests, size_t conversions)
 : adcbase(0)
 , converted(conversions)
 , requesting(requests)
+, scanning(0)
+, sampling(0)
+, swept(0)
 , converter(myconverter)
+, scans(0)
+, position(0)
+, filling(0)
+, fresh(false)
+, chained(false)
 , errors(0)
 {
+	// FreeRTOS binary semaphores are created full.
+	ready.take(IMMEDIATELY);
 	switch (converter) {
 
 	case CONVERTER0:
@@ -329,6 +339,22 @@ void A2D::begin() {
 	uint8_t request;
 	if ((A2DCSRA & (_BV(ADEN) | _BV(ADIE))) != _BV(ADEN)) {
 		// Do nothing: stopped or busy.
+	} else if (scanning != 0) {
+		// Free running can't be used as is for a scan because the conversion
+		// after the current one has already begun on the current channel by
+		// the time the interrupt service routine gets to change it. So the
+		// interrupt service routine starts each conversion itself instead.
+		if (((A2DCSRA & _BV(ADATE)) == _BV(ADATE)) && ((A2DCSRB & (_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) == 0)) {
+			A2DCSRA &= ~_BV(ADATE);
+			chained = true;
+		}
+		select(scanning[position]);
+		A2DCSRA |= _BV(ADIE);
+		if ((A2DCSRA & _BV(ADATE)) == 0) {
+			A2DCSRA |= _BV(ADSC);
+		} else {
+			// Do nothing: wait for the trigger.
+		}
 	} else if (!requesting.receive(&request, IMMEDIATELY)) {
 		// Do nothing: stalled.
 	} else {
@@ -337,6 +363,12 @@ void A2D::begin() {
 }
 
 void A2D::adc(uint8_t request) {
+	select(request);
+	A2DCSRA |= _BV(ADIE);
+	A2DCSRA |= _BV(ADSC);
+}
+
+void A2D::select(uint8_t request) {
 	uint8_t reference = request >> 4;
 	uint8_t channel = request & 0x0f;
 
@@ -409,8 +441,99 @@ void A2D::adc(uint8_t request) {
 	A2DCSRB = (A2DCSRB & ~(1 << MUX5)) | (((channel >> 3) & 0x01) << MUX5);
 #endif
 	A2DMUX = refs | (channel & 0x07);
-	A2DCSRA |= _BV(ADIE);
-	A2DCSRA |= _BV(ADSC);
+}
+
+uint32_t A2D::rate(uint32_t hertz) {
+	uint32_t result = 0;
+#if !defined(portUSE_TIMER1) && defined(TCCR1B) && defined(WGM12) && defined(OCR1A) && defined(OCR1B)
+	static const uint16_t PRESCALE[] = { 1, 8, 64, 256, 1024 };
+	Uninterruptible uninterruptible;
+	TCCR1B = 0; // Stop the timer/counter.
+	if (hertz > 0) {
+		for (uint8_t cs = 0; cs < countof(PRESCALE); ++cs) {
+			uint32_t counts = F_CPU / (PRESCALE[cs] * hertz);
+			if (counts == 0) {
+				break;
+			} else if (counts > 65536UL) {
+				// Do nothing: try the next larger prescale factor.
+			} else {
+				// In CTC mode the timer/counter counts from zero up to TOP in
+				// OCR1A then starts over. Setting OCR1B to the same value makes
+				// compare match B happen once per period too.
+				TCCR1A = 0;
+				TCNT1 = 0;
+				OCR1A = counts - 1;
+				OCR1B = counts - 1;
+				TIFR1 = _BV(OCF1B) | _BV(OCF1A) | _BV(TOV1); // Writing a one clears them.
+				TCCR1B = _BV(WGM12) | (cs + 1);
+				result = (counts * PRESCALE[cs]) / (F_CPU / 1000000UL);
+				break;
+			}
+		}
+	}
+#endif
+	return result;
+}
+
+void A2D::scan(const uint8_t * list, uint8_t count, uint16_t * frames) {
+	{
+		Uninterruptible uninterruptible;
+		scanning = 0;
+		A2DCSRA &= ~_BV(ADIE);
+		// In free running mode ADSC stays set for as long as ADATE is, since
+		// each conversion starts the next, so auto triggering is suspended
+		// here the same way begin() does it for a scan and restored below.
+		if (((A2DCSRA & _BV(ADATE)) == _BV(ADATE)) && ((A2DCSRB & (_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) == 0)) {
+			A2DCSRA &= ~_BV(ADATE);
+			chained = true;
+		}
+	}
+
+	// Let any conversion that is under way finish so that its completion
+	// isn't mistaken for that of the first entry in the list or of a request.
+	// This takes at most twenty-five ADC clock cycles.
+	while ((A2DCSRA & _BV(ADSC)) != 0) {
+		// Do nothing.
+	}
+
+	{
+		Uninterruptible uninterruptible;
+		A2DCSRA |= _BV(ADIF); // Writing a one clears it.
+		if (chained) {
+			A2DCSRA |= _BV(ADATE);
+			chained = false;
+		}
+	}
+
+	if ((list != 0) && (count > 0) && (frames != 0)) {
+		ready.take(IMMEDIATELY);
+		Uninterruptible uninterruptible;
+		sampling = frames;
+		scans = count;
+		position = 0;
+		filling = 0;
+		fresh = false;
+		swept = 0;
+		scanning = list;
+	}
+
+	begin();
+}
+
+const uint16_t * A2D::frame(ticks_t timeout, uint16_t & sweep) {
+	const uint16_t * result = 0;
+	if (ready.take(timeout)) {
+		Uninterruptible uninterruptible;
+		fresh = false;
+		result = (filling == 0) ? &sampling[scans] : &sampling[0];
+		sweep = swept - 1;
+	}
+	return result;
+}
+
+uint16_t A2D::sweeps() const {
+	Uninterruptible uninterruptible;
+	return swept;
 }
 
 inline void A2D::complete(Converter converter) {
@@ -425,22 +548,27 @@ void A2D::complete() {
 	uint8_t adch = ADCH;
 	uint16_t sample = (adch << 8) | adcl;
 
-	bool woken = false;
-	if (converted.sendFromISR(&sample, woken)) {
-		// Do nothing.
-	} else if (errors < ~static_cast<uint8_t>(0)) {
-		++errors;
-	} else {
-		// Do nothing.
-	}
+	rearm();
 
+	bool woken = false;
 	uint8_t request;
-	if (requesting.receiveFromISR(&request)) {
-		adc(request);
-	} else if (((A2DCSRA & _BV(ADATE)) == _BV(ADATE)) && ((A2DCSRB & (_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) == 0)) {
-		// Do nothing: free running.
+	if (scanning != 0) {
+		sweep(sample, woken);
 	} else {
-		A2DCSRA &= ~_BV(ADIE);
+		if (converted.sendFromISR(&sample, woken)) {
+			// Do nothing.
+		} else if (errors < ~static_cast<uint8_t>(0)) {
+			++errors;
+		} else {
+			// Do nothing.
+		}
+		if (requesting.receiveFromISR(&request)) {
+			adc(request);
+		} else if (((A2DCSRA & _BV(ADATE)) == _BV(ADATE)) && ((A2DCSRB & (_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) == 0)) {
+			// Do nothing: free running.
+		} else {
+			A2DCSRA &= ~_BV(ADIE);
+		}
 	}
 
 	if (woken) {
@@ -449,6 +577,61 @@ void A2D::complete() {
 
 }
 
+void A2D::sweep(uint16_t sample, bool & woken) {
+	sampling[(filling == 0) ? position : (scans + position)] = sample;
+	if ((++position) < scans) {
+		// Do nothing.
+	} else {
+		position = 0;
+		filling = (filling == 0) ? 1 : 0;
+		++swept;
+		if (!fresh) {
+			fresh = true;
+		} else if (errors < ~static_cast<uint8_t>(0)) {
+			++errors; // Overrun: the consumer never took the prior frame.
+		} else {
+			// Do nothing.
+		}
+		ready.giveFromISR(woken);
+	}
+	select(scanning[position]);
+	if ((A2DCSRA & _BV(ADATE)) == 0) {
+		A2DCSRA |= _BV(ADSC);
+	} else {
+		// Do nothing: wait for the trigger.
+	}
+}
+
+void A2D::rearm() {
+	if ((A2DCSRA & _BV(ADATE)) == 0) {
+		// Do nothing: not auto-triggered.
+	} else {
+		switch (A2DCSRB & (_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) {
+#if defined(TIFR0)
+		case _BV(ADTS1) | _BV(ADTS0): // MATCH0A
+			TIFR0 = _BV(OCF0A);
+			break;
+		case _BV(ADTS2): // OVERFLOW0
+			TIFR0 = _BV(TOV0);
+			break;
+#endif
+#if defined(TIFR1)
+		case _BV(ADTS2) | _BV(ADTS0): // MATCH1B
+			TIFR1 = _BV(OCF1B);
+			break;
+		case _BV(ADTS2) | _BV(ADTS1): // OVERFLOW1
+			TIFR1 = _BV(TOV1);
+			break;
+		case _BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0): // CAPTURE1
+			TIFR1 = _BV(ICF1);
+			break;
+#endif
+		default:
+			break;
+		}
+	}
+}
+
 A2D & A2D::operator=(uint8_t value) {
 	// It is fun to think about why this has to be uninterruptible.
 	Uninterruptible uninterruptible;
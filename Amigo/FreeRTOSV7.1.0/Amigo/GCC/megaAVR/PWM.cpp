@@ -11,8 +11,12 @@
 #include "com/diag/amigo/countof.h"
 #include "com/diag/amigo/target/harvard.h"
 #include "com/diag/amigo/target/PWM.h"
+#include "com/diag/amigo/target/Uninterruptible.h"
 
 #define TCCR		COM_DIAG_AMIGO_MMIO_8(controlbase, 0)
+#define TCCRB		COM_DIAG_AMIGO_MMIO_8(controlbase, 1)
+#define TCNT16		COM_DIAG_AMIGO_MMIO_16(controlbase, 2)
+#define ICR16		COM_DIAG_AMIGO_MMIO_16(controlbase, 3)
 #define OCR8		COM_DIAG_AMIGO_MMIO_8(outputcompare8base, 0)
 #define OCR16		COM_DIAG_AMIGO_MMIO_16(outputcompare16base, 0)
 
@@ -73,7 +77,7 @@ static volatile void * const CONTROL[] PROGMEM = {
 		0,
 		0,
 #endif
-#if !defined(portUSE_TIMER2)
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2)
 #	if defined(TCCR2)
 		&TCCR2,
 #	else
@@ -142,7 +146,7 @@ static volatile void * const CONTROL[] PROGMEM = {
 		0,
 		0,
 #endif
-#if !defined(portUSE_TIMER5)
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5)
 #	if defined(TCCR5A)
 		&TCCR5A,
 #	else
@@ -218,7 +222,7 @@ static volatile void * const OUTPUTCOMPARE8[] PROGMEM = {
 		0,
 		0,
 #endif
-#if !defined(portUSE_TIMER2)
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2)
 #	if defined(OCR2) && !defined(OCR2L)
 		&OCR2,
 #	else
@@ -370,7 +374,7 @@ static volatile void * const OUTPUTCOMPARE16[] PROGMEM = {
 		0,
 		0,
 #endif
-#if !defined(portUSE_TIMER5)
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5)
 #	if defined(OCR5AL)
 		&OCR5A,
 #	else
@@ -446,7 +450,7 @@ static const uint8_t OFFSET[] PROGMEM = {
 		~0,
 		~0,
 #endif
-#if !defined(portUSE_TIMER2)
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2)
 #	if defined(COM21)
 		COM21,
 #	else
@@ -515,7 +519,7 @@ static const uint8_t OFFSET[] PROGMEM = {
 		~0,
 		~0,
 #endif
-#if !defined(portUSE_TIMER5)
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5)
 #	if defined(COM5A1)
 		COM5A1,
 #	else
@@ -625,7 +629,7 @@ static const uint8_t ARDUINOPIN[] PROGMEM = {
 	PWM::INVALID,   // 7
 	PWM::INVALID,   // 8
 #endif
-#if !defined(portUSE_TIMER2)
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2)
 	PWM::PIN_2B,    // 9
 	PWM::PIN_2A,    // 10
 #else
@@ -674,7 +678,7 @@ static const uint8_t ARDUINOPIN[] PROGMEM = {
 	PWM::INVALID,	// 41
 	PWM::INVALID,	// 42
 	PWM::INVALID,	// 43
-#if !defined(portUSE_TIMER5)
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5)
 	PWM::PIN_5C,    // 44
 	PWM::PIN_5B,    // 45
 	PWM::PIN_5A,    // 46
@@ -711,7 +715,7 @@ static const uint8_t ARDUINOPIN[] PROGMEM = {
 	PWM::INVALID,   // 0
 	PWM::INVALID,   // 1
 	PWM::INVALID,   // 2
-#if !defined(portUSE_TIMER2)
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2)
 	PWM::PIN_2B,    // 3
 #else
 	PWM::INVALID,   // 3
@@ -733,7 +737,7 @@ static const uint8_t ARDUINOPIN[] PROGMEM = {
 	PWM::INVALID,   // 9
 	PWM::INVALID,   // 10
 #endif
-#if !defined(portUSE_TIMER2)
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2)
 	PWM::PIN_2A,    // 11
 #else
 	PWM::INVALID,   // 11
@@ -804,7 +808,7 @@ static const uint8_t TIMER[] PROGMEM = {
 		PWM::NONE,
 		PWM::NONE,
 #endif
-#if !defined(portUSE_TIMER2)
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2)
 #	if defined(TCCR2)
 		PWM::TIMER_2,
 #	else
@@ -873,7 +877,7 @@ static const uint8_t TIMER[] PROGMEM = {
 		PWM::NONE,
 		PWM::NONE,
 #endif
-#if !defined(portUSE_TIMER5)
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5)
 #	if defined(TCCR5A)
 		PWM::TIMER_5,
 #	else
@@ -928,6 +932,58 @@ PWM::Timer PWM::pwm2timer(Pin pin) {
 	return (pin < countof(TIMER)) ? static_cast<Timer>(pgm_read_byte(&TIMER[pin])) : NONE;
 }
 
+volatile void * PWM::timer2interruptflag(Timer timer) {
+	volatile void * result = 0;
+	switch (timer) {
+#if !defined(portUSE_TIMER0) && defined(TIFR0)
+	case TIMER_0:	result = &TIFR0;	break;
+#endif
+#if !defined(portUSE_TIMER1) && defined(TIFR1)
+	case TIMER_1:	result = &TIFR1;	break;
+#endif
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2) && defined(TIFR2)
+	case TIMER_2:	result = &TIFR2;	break;
+#endif
+#if !defined(portUSE_TIMER3) && defined(TIFR3)
+	case TIMER_3:	result = &TIFR3;	break;
+#endif
+#if !defined(portUSE_TIMER4) && defined(TIFR4)
+	case TIMER_4:	result = &TIFR4;	break;
+#endif
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5) && defined(TIFR5)
+	case TIMER_5:	result = &TIFR5;	break;
+#endif
+	default:		break;
+	}
+	return result;
+}
+
+volatile void * PWM::timer2interruptmask(Timer timer) {
+	volatile void * result = 0;
+	switch (timer) {
+#if !defined(portUSE_TIMER0) && defined(TIMSK0)
+	case TIMER_0:	result = &TIMSK0;	break;
+#endif
+#if !defined(portUSE_TIMER1) && defined(TIMSK1)
+	case TIMER_1:	result = &TIMSK1;	break;
+#endif
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2) && defined(TIMSK2)
+	case TIMER_2:	result = &TIMSK2;	break;
+#endif
+#if !defined(portUSE_TIMER3) && defined(TIMSK3)
+	case TIMER_3:	result = &TIMSK3;	break;
+#endif
+#if !defined(portUSE_TIMER4) && defined(TIMSK4)
+	case TIMER_4:	result = &TIMSK4;	break;
+#endif
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5) && defined(TIMSK5)
+	case TIMER_5:	result = &TIMSK5;	break;
+#endif
+	default:		break;
+	}
+	return result;
+}
+
 /*******************************************************************************
  * CLASS METHODS
  ******************************************************************************/
@@ -987,7 +1043,7 @@ PWM::Timer PWM::prestart(Timer timer) {
 		break;
 #endif
 
-#if !defined(portUSE_TIMER2)
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2)
 	case TIMER_2:
 #	if defined(TCCR2) && defined(CS22)
 		TCCR2 = _BV(CS22);					// Set timer 2 prescale factor to 64.
@@ -1028,7 +1084,7 @@ PWM::Timer PWM::prestart(Timer timer) {
 		break;
 #	endif
 
-#if !defined(portUSE_TIMER5)
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5)
 	case TIMER_5:
 #	if defined(TCCR5B) && defined(CS51) && defined(WGM50)
 		TCCR5B = _BV(CS51) | _BV(CS50);		// Set timer 5 prescale factor to 64.
@@ -1056,6 +1112,75 @@ PWM::Timer PWM::prestart(Timer timer) {
 	return result;
 }
 
+uint16_t PWM::prestart(Timer timer, uint32_t hertz) {
+	uint16_t result = 0;
+
+	// All of the sixteen-bit timers have the same register layout starting at
+	// TCCRnA, and the same bit positions within those registers, so the timer
+	// 1 bit names serve for all of them.
+
+	volatile void * controlbase = 0;
+	switch (timer) {
+
+#if !defined(portUSE_TIMER1) && defined(TCCR1A) && defined(ICR1)
+	case TIMER_1:
+		controlbase = &TCCR1A;
+		break;
+#endif
+
+#if !defined(portUSE_TIMER3) && defined(TCCR3A) && defined(ICR3)
+	case TIMER_3:
+		controlbase = &TCCR3A;
+		break;
+#endif
+
+#if !defined(portUSE_TIMER4) && defined(TCCR4A) && defined(ICR4)
+	case TIMER_4:
+		controlbase = &TCCR4A;
+		break;
+#endif
+
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5) && defined(TCCR5A) && defined(ICR5)
+	case TIMER_5:
+		controlbase = &TCCR5A;
+		break;
+#endif
+
+	default:
+		break;
+
+	}
+
+#if defined(WGM13) && defined(WGM12) && defined(WGM11) && defined(WGM10)
+	static const uint16_t PRESCALE[] = { 1, 8, 64, 256, 1024 };
+	if ((controlbase != 0) && (hertz > 0)) {
+		for (uint8_t cs = 0; cs < countof(PRESCALE); ++cs) {
+			uint32_t counts = F_CPU / (PRESCALE[cs] * hertz);
+			if (counts < 4) {
+				// The minimum resolution of fast PWM is two bits.
+				break;
+			} else if (counts > 65536UL) {
+				// Do nothing: try the next larger prescale factor.
+			} else {
+				// Mode 14: fast PWM with TOP in ICRn. The compare output mode
+				// bits in TCCRnA are left alone so that running pins stay
+				// connected.
+				Uninterruptible uninterruptible;
+				TCCRB = 0; // Stop the timer.
+				TCCR = (TCCR & ~(_BV(WGM11) | _BV(WGM10))) | _BV(WGM11);
+				ICR16 = counts - 1;
+				TCNT16 = 0;
+				TCCRB = _BV(WGM13) | _BV(WGM12) | (cs + 1);
+				result = counts - 1;
+				break;
+			}
+		}
+	}
+#endif
+
+	return result;
+}
+
 /*******************************************************************************
  * INSTANCE METHODS
  ******************************************************************************/
@@ -1083,6 +1208,42 @@ void PWM::start(uint8_t dutycycle) {
 	}
 }
 
+void PWM::start16(uint16_t dutycycle) {
+	if (!*this) {
+		// FAIL!
+		return;
+	}
+
+	if (outputcompare16base != 0) {
+		uint32_t top;
+		{
+			Uninterruptible uninterruptible;
+#if defined(WGM13)
+			top = ((TCCRB & _BV(WGM13)) != 0) ? ICR16 : 0xff;
+#else
+			top = 0xff;
+#endif
+		}
+		uint16_t ocr = (dutycycle * (top + 1)) >> 16;
+		if (ocr == 0) {
+			TCCR &= ~pwmmask;
+			gpio.clear(gpiomask);
+			gpio.output(gpiomask);
+		} else {
+			gpio.output(gpiomask);
+			Uninterruptible uninterruptible;
+			// The output compare register is double buffered, so the new
+			// value takes effect at the end of the current period.
+			OCR16 = ocr;
+			TCCR |= pwmmask;
+		}
+	} else if (outputcompare8base != 0) {
+		start(dutycycle >> 8);
+	} else {
+		// Should be impossible.
+	}
+}
+
 void PWM::stop(bool high) {
 	if (!*this) {
 		// FAIL!
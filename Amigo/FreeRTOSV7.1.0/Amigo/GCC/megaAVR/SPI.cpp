@@ -50,6 +50,9 @@ SPI::SPI(Controller mycontroller, size_t transmits, size_t receives)
 , gpiobase(0)
 , received(receives)
 , transmitting(transmits)
+, transmit(0)
+, receive(0)
+, remaining(0)
 , controller(mycontroller)
 , ss(0)
 , sck(0)
@@ -83,6 +86,10 @@ SPI::SPI(Controller mycontroller, size_t transmits, size_t receives)
 		break;
 
 	}
+
+	// FreeRTOS binary semaphores are created full. We want the first take to
+	// block until a block transfer actually completes.
+	transferred.take(IMMEDIATELY);
 }
 
 SPI::~SPI() {
@@ -246,6 +253,42 @@ void SPI::begin() {
 	}
 }
 
+ssize_t SPI::transfer(const void * data, void * buffer, size_t length, ticks_t timeout) {
+	if (length == 0) {
+		return 0;
+	}
+
+	{
+		Uninterruptible uninterruptible;
+		if ((SPICR & (_BV(SPIE) | _BV(SPE))) != _BV(SPE)) {
+			return -1; // Stopped or busy.
+		}
+		transmit = static_cast<const uint8_t *>(data);
+		receive = static_cast<uint8_t *>(buffer);
+		remaining = length;
+		SPICR |= _BV(SPIE);
+		SPIDR = (transmit != 0) ? *(transmit++) : 0;
+	}
+
+	if (!transferred.take(timeout)) {
+		Uninterruptible uninterruptible;
+		SPICR &= ~_BV(SPIE);
+		remaining = 0;
+		// The ISR may have finished the block, and given the semaphore, after
+		// our take timed out but before we got here; or the last byte may have
+		// completed since, leaving SPIF set. Either would be mistaken for the
+		// end of the next transfer, so both are discarded. Reading SPDR
+		// after SPSR has been read with SPIF set is what clears SPIF.
+		transferred.take(IMMEDIATELY);
+		if ((SPISR & _BV(SPIF)) != 0) {
+			(void)SPIDR;
+		}
+		return -2;
+	}
+
+	return length;
+}
+
 inline void SPI::complete(Controller controller) {
 	// Only called from an ISR hence implicitly uninterruptible.
 	if (spi[controller] != 0) {
@@ -265,18 +308,31 @@ void SPI::complete() {
 
 	uint8_t ch = SPIDR;
 	bool woken = false;
-	if (received.sendFromISR(&ch, woken)) {
-		// Do nothing.
-	} else if (errors < ~static_cast<uint8_t>(0)) {
-		++errors;
+	if (remaining > 0) {
+		// Block transfer: no ring buffers, just pointers, and one wake up
+		// at the very end.
+		if (receive != 0) {
+			*(receive++) = ch;
+		}
+		if ((--remaining) > 0) {
+			SPIDR = (transmit != 0) ? *(transmit++) : 0;
+		} else {
+			SPICR &= ~_BV(SPIE);
+			transferred.giveFromISR(woken);
+		}
 	} else {
-		// Do nothing.
-	}
-
-	if (transmitting.receiveFromISR(&ch)) {
-		SPIDR = ch;
-	} else {
-		SPICR &= ~_BV(SPIE);
+		if (received.sendFromISR(&ch, woken)) {
+			// Do nothing.
+		} else if (errors < ~static_cast<uint8_t>(0)) {
+			++errors;
+		} else {
+			// Do nothing.
+		}
+		if (transmitting.receiveFromISR(&ch)) {
+			SPIDR = ch;
+		} else {
+			SPICR &= ~_BV(SPIE);
+		}
 	}
 
 	if (woken) {
@@ -60,9 +60,16 @@ Serial::Serial(Port myport, size_t transmits, size_t receives, uint8_t mybad)
 , transmitting(transmits)
 , port(myport)
 , microseconds(0.0)
+, batch(0)
+, last(0)
+, quiet(1)
+, idle(IDLE)
 , bad(mybad)
 , errors(0)
 {
+	// FreeRTOS binary semaphores are created full.
+	ready.take(IMMEDIATELY);
+
 	switch (port) {
 
 	case USART0:
@@ -169,6 +176,8 @@ void Serial::start(uint32_t rate, Data data, Parity parity, Stop stop) {
 
 	microseconds = (1000000.0 / rate) * 2 * bits; // uSec for two characters.
 
+	quiesce();
+
 	Uninterruptible uninterruptible;
 
 	UCSRB = 0;
@@ -244,6 +253,119 @@ void Serial::flush() {
 	// foolish as to still be emitting, tough nuggies.
 }
 
+size_t Serial::emit(const void * data, size_t size, ticks_t timeout, bool progmem) {
+	const uint8_t * here = static_cast<const uint8_t *>(data);
+	size_t count = 0;
+	uint8_t ch;
+	while (count < size) {
+		bool full = false;
+		{
+			// Nothing waits on the transmit queue but writers blocked on it
+			// being full, so the ISR form of send never wakes anyone here.
+			Uninterruptible uninterruptible;
+			size_t limit = size - count;
+			if (limit > BURST) {
+				limit = BURST;
+			}
+			while (limit > 0) {
+				ch = progmem ? pgm_read_byte(here) : *here;
+				if (!transmitting.sendFromISR(&ch)) {
+					full = true;
+					break;
+				}
+				++here;
+				++count;
+				--limit;
+			}
+			begin();
+		}
+		if (!full) {
+			// Do nothing.
+		} else if (!transmitting.send(&ch, timeout)) {
+			break;
+		} else {
+			++here;
+			++count;
+			begin();
+		}
+	}
+	return count;
+}
+
+void Serial::quiesce() {
+	// The microseconds field is the time for two characters.
+	double milliseconds = (idle * microseconds) / 2000.0;
+	ticks_t ticks = static_cast<ticks_t>((milliseconds / Task::PERIOD) + 0.999);
+	quiet = (ticks > 0) ? ticks : 1;
+}
+
+void Serial::threshold(size_t count, uint8_t characters) {
+	idle = characters;
+	quiesce();
+	// The ISR reads this so it has to be changed atomically.
+	Uninterruptible uninterruptible;
+	batch = count;
+}
+
+size_t Serial::read(void * buffer, size_t size, ticks_t timeout) {
+	uint8_t * here = static_cast<uint8_t *>(buffer);
+	size_t count = 0;
+	size_t limit = batch;
+	if (size == 0) {
+		// Do nothing.
+	} else if (limit == 0) {
+		// Wait for the first character as the single character read() does.
+		if (received.receive(here, timeout)) {
+			++here;
+			++count;
+		}
+	} else {
+		// The ISR gives the semaphore when the first character arrives in an
+		// empty buffer and when the threshold is reached, so this task is
+		// woken a couple of times per batch instead of once per character.
+		// Stale gives just cause another trip around the loop.
+		if (limit > size) {
+			limit = size;
+		}
+		ticks_t then = Task::elapsed();
+		while (true) {
+			size_t have = received.available();
+			ticks_t wait = timeout;
+			if (have >= limit) {
+				break;
+			} else if (have > 0) {
+				ticks_t recent;
+				{
+					Uninterruptible uninterruptible;
+					recent = last;
+				}
+				if (static_cast<ticks_t>(Task::elapsed() - recent) >= quiet) {
+					break;
+				}
+				wait = quiet;
+			} else {
+				// Do nothing.
+			}
+			if (timeout != NEVER) {
+				ticks_t waited = Task::elapsed() - then;
+				if (waited >= timeout) {
+					break;
+				} else if (wait > (timeout - waited)) {
+					wait = timeout - waited;
+				} else {
+					// Do nothing.
+				}
+			}
+			ready.take(wait);
+		}
+	}
+	while ((count < size) && received.receive(here, IMMEDIATELY)) {
+		++here;
+		++count;
+	}
+	return count;
+}
+
 Serial & Serial::operator=(uint8_t value) {
 	// It is fun to think about why this has to be uninterruptible.
 	Uninterruptible uninterruptible;
@@ -271,12 +393,21 @@ void Serial::receive() {
 	}
 
 	bool woken = false;
-	if (received.sendFromISR(&ch, woken)) {
+	if (!received.sendFromISR(&ch, woken)) {
+		if (errors < ~static_cast<uint8_t>(0)) {
+			++errors;
+		}
+	} else if (batch == 0) {
 		// Do nothing.
-	} else if (errors < ~static_cast<uint8_t>(0)) {
-		++errors;
 	} else {
-		// Do nothing.
+		// Only wake a bulk reader on the first character or at the threshold.
+		last = Task::elapsedFromISR();
+		size_t have = received.availableFromISR();
+		if ((have == 1) || (have >= batch)) {
+			bool notified = false;
+			ready.giveFromISR(notified);
+			woken = woken || notified;
+		}
 	}
 
 	if (woken) {
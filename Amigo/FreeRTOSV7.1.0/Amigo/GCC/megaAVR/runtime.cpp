@@ -0,0 +1,88 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "FreeRTOS.h"
+#include "com/diag/amigo/target/runtime.h"
+#include "com/diag/amigo/target/Uninterruptible.h"
+#include "com/diag/amigo/types.h"
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+
+#if defined(TCNT5)
+
+// Timer5 is sixteen bits; the overflows supply the other sixteen.
+
+static volatile uint16_t overflows = 0;
+
+CXXCAPI void amigo_runtime_start(void) {
+	com::diag::amigo::Uninterruptible uninterruptible;
+	TCCR5B = 0;
+	TCCR5A = 0;
+	TCNT5 = 0;
+	overflows = 0;
+	TIFR5 = _BV(TOV5); // Writing a one clears it.
+	TIMSK5 = _BV(TOIE5);
+	TCCR5B = _BV(CS51) | _BV(CS50);
+}
+
+CXXCAPI unsigned long amigo_runtime_counter(void) {
+	com::diag::amigo::Uninterruptible uninterruptible;
+	uint16_t low = TCNT5;
+	uint16_t high = overflows;
+	// If the timer overflowed while interrupts were disabled, the overflow
+	// hasn't been counted yet. If it overflowed before the timer was read,
+	// the value read is small.
+	if (((TIFR5 & _BV(TOV5)) != 0) && (low < 0x8000)) {
+		++high;
+	}
+	return (static_cast<unsigned long>(high) << 16) | low;
+}
+
+ISR(TIMER5_OVF_vect) {
+	++overflows;
+}
+
+#elif defined(TCNT2)
+
+// Timer2 is eight bits; the overflows supply the other twenty-four.
+
+static volatile unsigned long overflows = 0;
+
+CXXCAPI void amigo_runtime_start(void) {
+	com::diag::amigo::Uninterruptible uninterruptible;
+	TCCR2B = 0;
+	TCCR2A = 0;
+	ASSR &= ~_BV(AS2);
+	TCNT2 = 0;
+	overflows = 0;
+	TIFR2 = _BV(TOV2); // Writing a one clears it.
+	TIMSK2 = _BV(TOIE2);
+	TCCR2B = _BV(CS22);
+}
+
+CXXCAPI unsigned long amigo_runtime_counter(void) {
+	com::diag::amigo::Uninterruptible uninterruptible;
+	uint8_t low = TCNT2;
+	unsigned long high = overflows;
+	if (((TIFR2 & _BV(TOV2)) != 0) && (low < 0x80)) {
+		++high;
+	}
+	return (high << 8) | low;
+}
+
+ISR(TIMER2_OVF_vect) {
+	++overflows;
+}
+
+#else
+#	error "No timer is available for the FreeRTOS run time statistics."
+#endif
+
+#endif
@@ -151,6 +151,14 @@
 #define configUSE_ALTERNATIVE_API       0
 #define configCHECK_FOR_STACK_OVERFLOW  1
 #define configQUEUE_REGISTRY_SIZE	    0
+/* v coverclock@diag.com 2012-07-14 */
+// Per-task CPU usage, reported by Task::cpu(), is measured with a free running
+// hardware timer; see com/diag/amigo/target/runtime.h.
+#define configGENERATE_RUN_TIME_STATS	1
+#include "com/diag/amigo/target/runtime.h"
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() amigo_runtime_start()
+#define portGET_RUN_TIME_COUNTER_VALUE() amigo_runtime_counter()
+/* ^ coverclock@diag.com 2012-07-14 */
 
 /* Timer definitions. */
 #define configUSE_TIMERS				1
@@ -25,6 +25,7 @@
 #include "com/diag/amigo/target/SPI.h"
 #include "com/diag/amigo/target/GPIO.h"
 #include "com/diag/amigo/target/PWM.h"
+#include "com/diag/amigo/target/PWMGroup.h"
 #include "com/diag/amigo/target/A2D.h"
 #include "com/diag/amigo/target/Uninterruptible.h"
 #include "com/diag/amigo/target/Console.h"
@@ -33,16 +34,26 @@
 #include "com/diag/amigo/SerialSource.h"
 #include "com/diag/amigo/Source.h"
 #include "com/diag/amigo/Sink.h"
+#include "com/diag/amigo/BufferedSink.h"
 #include "com/diag/amigo/Print.h"
+#include "com/diag/amigo/Log.h"
+#include "com/diag/amigo/Formatter.h"
+#include "com/diag/amigo/convert.h"
 #include "com/diag/amigo/Dump.h"
+#include "com/diag/amigo/Filter.h"
 #include "com/diag/amigo/BinarySemaphore.h"
 #include "com/diag/amigo/CountingSemaphore.h"
 #include "com/diag/amigo/CriticalSection.h"
 #include "com/diag/amigo/MutexSemaphore.h"
 #include "com/diag/amigo/Timer.h"
 #include "com/diag/amigo/Toggle.h"
+#include "com/diag/amigo/Ring.h"
+#include "com/diag/amigo/Pool.h"
+#include "com/diag/amigo/Telegraph.h"
 #include "com/diag/amigo/W5100/W5100.h"
 #include "com/diag/amigo/W5100/Socket.h"
+#include "com/diag/amigo/W5100/Dispatcher.h"
+#include "com/diag/amigo/W5100/Poller.h"
 #include "com/diag/amigo/IPV4Address.h"
 #include "com/diag/amigo/MACAddress.h"
 #include "unittest.h"
@@ -254,6 +265,25 @@ private:
 };
 #endif
 
+/*******************************************************************************
+ * W5100 BULK TRANSFER TEST FIXTURE
+ ******************************************************************************/
+
+#if 1
+class W5100Bulk : public com::diag::amigo::W5100::W5100 {
+public:
+	explicit W5100Bulk(com::diag::amigo::MutexSemaphore & mymutex, com::diag::amigo::GPIO::Pin myss, com::diag::amigo::SPI & myspi)
+	: com::diag::amigo::W5100::W5100(mymutex, myss, myspi)
+	{}
+	// Exposes the bulk transfer methods and the buffer base addresses so that
+	// the unit test can look directly at W5100 buffer memory.
+	void mywrite(address_t address, const void * data, size_t length) { write(address, data, length); }
+	void myread(address_t address, void * buffer, size_t length) { read(address, buffer, length); }
+	address_t mysbase(socket_t sock) const { return sbase[sock]; }
+	address_t myrbase(socket_t sock) const { return rbase[sock]; }
+};
+#endif
+
 /*******************************************************************************
  * SOCKET TEST FIXTURE
  ******************************************************************************/
@@ -274,6 +304,171 @@ public:
 };
 #endif
 
+/*******************************************************************************
+ * BUFFER SOURCE AND SINK TEST FIXTURE
+ ******************************************************************************/
+
+#if 1
+class BufferSource : public com::diag::amigo::Source {
+public:
+	explicit BufferSource(const void * mydata, size_t mylength) : here(static_cast<const uint8_t *>(mydata)), remaining(mylength) {}
+	virtual int available() { return remaining; }
+	virtual int read() { if (remaining == 0) { return -1; } --remaining; return *(here++); }
+	const uint8_t * here;
+	size_t remaining;
+};
+
+class BufferSink : public com::diag::amigo::Sink {
+public:
+	explicit BufferSink(void * mybuffer, size_t mylength) : here(static_cast<uint8_t *>(mybuffer)), remaining(mylength) {}
+	virtual size_t write(uint8_t ch) { if (remaining == 0) { return 0; } --remaining; *(here++) = ch; return 1; }
+	virtual void flush() {}
+	uint8_t * here;
+	size_t remaining;
+};
+#endif
+
+/*******************************************************************************
+ * COUNTING SINK TEST FIXTURE
+ ******************************************************************************/
+
+#if 1
+class CountingSink : public com::diag::amigo::Sink {
+public:
+	explicit CountingSink() : count(0) {}
+	virtual size_t write(uint8_t ch) { ++count; return 1; }
+	virtual void flush() {}
+	size_t count;
+};
+#endif
+
+/*******************************************************************************
+ * CALLING SINK TEST FIXTURE
+ ******************************************************************************/
+
+#if 1
+class CallingSink : public com::diag::amigo::Sink {
+public:
+	explicit CallingSink() : bytes(0), calls(0) {}
+	virtual size_t write(uint8_t ch) { ++bytes; ++calls; return 1; }
+	virtual size_t write(const void * datum, size_t size) { bytes += size; ++calls; return size; }
+	virtual size_t write_P(PGM_VOID_P datum, size_t size) { bytes += size; ++calls; return size; }
+	virtual void flush() {}
+	using com::diag::amigo::Sink::write;
+	using com::diag::amigo::Sink::write_P;
+	size_t bytes;
+	size_t calls;
+};
+#endif
+
+/*******************************************************************************
+ * RING TEST FIXTURE
+ ******************************************************************************/
+
+#if 1
+class RingProducer : public com::diag::amigo::PeriodicTimer {
+public:
+	explicit RingProducer(com::diag::amigo::RingQueue<uint8_t, 8> & myring, com::diag::amigo::ticks_t duration) : com::diag::amigo::PeriodicTimer(duration), ring(myring), datum(0) {}
+	virtual void timer();
+	com::diag::amigo::RingQueue<uint8_t, 8> & ring;
+	uint8_t datum;
+};
+
+void RingProducer::timer() {
+	// Stand in for an ISR by running uninterruptible.
+	com::diag::amigo::Uninterruptible uninterruptible;
+	for (uint8_t ii = 0; ii < 3; ++ii) {
+		if (!ring.sendFromISR(&datum)) {
+			break;
+		}
+		++datum;
+	}
+}
+#endif
+
+/*******************************************************************************
+ * POOL TEST FIXTURE
+ ******************************************************************************/
+
+#if 1
+class PooledTimer : public com::diag::amigo::PeriodicTimer, public com::diag::amigo::Pooled {
+public:
+	explicit PooledTimer(com::diag::amigo::ticks_t duration, uint8_t & mydestroyed) : com::diag::amigo::PeriodicTimer(duration), destroyed(mydestroyed) {}
+	virtual ~PooledTimer() { ++destroyed; }
+	virtual void timer();
+	uint8_t & destroyed;
+};
+
+void PooledTimer::timer() {
+	// Do nothing.
+}
+#endif
+
+/*******************************************************************************
+ * BUSY TEST FIXTURE (FOR TESTING RUN TIME STATISTICS)
+ ******************************************************************************/
+
+#if 1
+static const uint32_t BUSY = 100000;
+
+class BusyTask : public com::diag::amigo::Task {
+public:
+	explicit BusyTask(const char * name, uint32_t myiterations) : com::diag::amigo::Task(name), iterations(myiterations), done(false) {}
+	virtual void task();
+	uint32_t iterations;
+	volatile bool done;
+} static busytask1("Busy1", BUSY * 3), busytask2("Busy2", BUSY);
+
+void BusyTask::task() {
+	volatile uint32_t counter = 0;
+	while (counter < iterations) {
+		++counter;
+	}
+	done = true;
+	// Delaying rather than yielding keeps the time spent waiting to be
+	// stopped from being charged to this task.
+	while (!stopped()) {
+		delay(1);
+	}
+}
+#endif
+
+/*******************************************************************************
+ * PRINTING TEST FIXTURE (FOR MEASURING FORMATTER STACK USAGE)
+ ******************************************************************************/
+
+#if 1
+static const char PRINTING[] PROGMEM = "%-8s|%10lu|%d|%u|%02x|%s\n";
+
+// Print needs more than the minimal stack.
+static const size_t PRINTINGDEPTH = 384;
+
+class PrintingTask : public com::diag::amigo::Task {
+public:
+	explicit PrintingTask(const char * name, bool myformatter) : com::diag::amigo::Task(name), formatter(myformatter), unused(0), done(false) {}
+	virtual void task();
+	bool formatter;
+	size_t unused;
+	volatile bool done;
+} static printingtask("Print", false), formattingtask("Format", true);
+
+void PrintingTask::task() {
+	CountingSink sink;
+	if (formatter) {
+		com::diag::amigo::Formatter<true> format(sink);
+		format(PRINTING, getName(), 4000000000UL, -1, 2U, 0xaU, "string");
+	} else {
+		com::diag::amigo::Print print(sink, true);
+		print(PRINTING, getName(), 4000000000UL, -1, 2U, 0xaU, "string");
+	}
+	unused = stackSelf();
+	done = true;
+	while (!stopped()) {
+		delay(1);
+	}
+}
+#endif
+
 /*******************************************************************************
  * TAKER TEST FIXTURE (FOR TESTING BINARYSEMAPHORE)
  ******************************************************************************/
@@ -529,6 +724,90 @@ void UnitTestTask::task() {
 	} while (false);
 #endif
 
+#if 1
+	UNITTESTLN("Serial bulk write");
+	do {
+		// Longer than the transmit ring buffer so that the writer has to wait
+		// for the transmitter at least once.
+		static const char LINE[] PROGMEM = "The quick brown fox jumps over the lazy dog.\r\n";
+		char buffer[sizeof(LINE)];
+		size_t written;
+		size_t total = 0;
+		memcpy_P(buffer, LINE, sizeof(buffer));
+		for (uint8_t ii = 0; ii < 3; ++ii) {
+			written = serialp->write(buffer, sizeof(buffer) - 1);
+			if (written != (sizeof(buffer) - 1)) {
+				break;
+			}
+			total += written;
+			written = serialp->write_P(LINE, sizeof(LINE) - 1);
+			if (written != (sizeof(LINE) - 1)) {
+				break;
+			}
+			total += written;
+		}
+		if (total != (6 * (sizeof(LINE) - 1))) {
+			FAILED(__LINE__);
+			break;
+		}
+		written = serialp->write(buffer, 0);
+		if (written != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		serialp->flush();
+		PASSED();
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("Serial bulk write rate");
+	do {
+		// The lines go to a second USART, which nothing need be listening to,
+		// so that the console stays at its own rate. The CPU time is the run
+		// time of this task alone; for the rest of the elapsed time it is
+		// blocked waiting for the transmitter to drain the ring buffer.
+		static const char FORMAT[] PROGMEM = "line=%u task=%s ticks=%lu\r\n";
+		static const unsigned int LINES = 20;
+		static const com::diag::amigo::Serial::Baud BAUDS[] = { com::diag::amigo::Serial::B115200, com::diag::amigo::Serial::B9600 };
+		unsigned long cpucycles[sizeof(BAUDS) / sizeof(BAUDS[0])];
+		unsigned long elapsedcycles[sizeof(BAUDS) / sizeof(BAUDS[0])];
+		size_t bytes = 0;
+		uint8_t bb;
+		for (bb = 0; bb < (sizeof(BAUDS) / sizeof(BAUDS[0])); ++bb) {
+			com::diag::amigo::Serial serial(com::diag::amigo::Serial::USART1);
+			if (!serial) { break; }
+			com::diag::amigo::SerialSink sink(serial);
+			com::diag::amigo::Print print(sink, true);
+			serial.start(BAUDS[bb]);
+			bytes = 0;
+			unsigned long self = cpuSelf();
+			com::diag::amigo::ticks_t then = elapsed();
+			for (unsigned int ii = 0; ii < LINES; ++ii) {
+				bytes += print(FORMAT, ii, getName(), static_cast<unsigned long>(then));
+			}
+			serial.flush();
+			elapsedcycles[bb] = (ticks2milliseconds(elapsed() - then) * (F_CPU / 1000UL)) / LINES;
+			cpucycles[bb] = ((cpuSelf() - self) * (F_CPU / COM_DIAG_AMIGO_RUNTIME_HZ)) / LINES;
+		}
+		if (bb < (sizeof(BAUDS) / sizeof(BAUDS[0]))) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (bytes == 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		// At 9600 baud the elapsed time is dominated by the wire.
+		if (elapsedcycles[1] <= elapsedcycles[0]) {
+			FAILED(__LINE__);
+			break;
+		}
+		printf(PSTR("115200=%lu/%lucycles 9600=%lu/%lucycles cpu/elapsed per %ubyte line "), cpucycles[0], elapsedcycles[0], cpucycles[1], elapsedcycles[1], bytes / LINES);
+		PASSED();
+	} while (false);
+#endif
+
 #if 1
 	UNITTESTLN("sizeof");
 	do {
@@ -737,6 +1016,58 @@ void UnitTestTask::task() {
 #endif
 	printf(PSTR("freeheap=%u\n"), heap());
 
+#if 1
+	UNITTEST("Heap statistics");
+	do {
+		// Other tasks, like the idle task cleaning up after deleted tasks,
+		// may use the heap too, so the counts are only lower bounds.
+		HeapStatistics before;
+		heap(before);
+		if ((before.xLargestFreeBlock > before.xFreeBytes) || (before.xMinimumFreeBytes > before.xFreeBytes) || (before.xFreeBlocks == 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		void * first = pvPortMalloc(16);
+		void * second = pvPortMalloc(16);
+		void * third = pvPortMalloc(16);
+		vPortFree(second);
+		void * toobig = pvPortMalloc(configTOTAL_HEAP_SIZE);
+		HeapStatistics during;
+		heap(during);
+		vPortFree(first);
+		vPortFree(third);
+		vPortFree(toobig);
+		HeapStatistics after;
+		heap(after);
+		if ((first == 0) || (second == 0) || (third == 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (toobig != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		if ((during.xAllocations < (before.xAllocations + 3)) || (during.xFrees < (before.xFrees + 1)) || (during.xFailures < (before.xFailures + 1))) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (during.xFreeBytes >= before.xFreeBytes) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (during.xMinimumFreeBytes > during.xFreeBytes) {
+			FAILED(__LINE__);
+			break;
+		}
+		if ((after.xFrees < (before.xFrees + 3)) || (after.xMinimumFreeBytes > during.xFreeBytes)) {
+			FAILED(__LINE__);
+			break;
+		}
+		PASSED();
+		printf(PSTR("free=%u minimum=%u largest=%u blocks=%u failures=%u\n"), after.xFreeBytes, after.xMinimumFreeBytes, after.xLargestFreeBlock, after.xFreeBlocks, after.xFailures);
+	} while (false);
+#endif
+
 #if 1
 	UNITTEST("littleendian and byteorder");
 	// megaAVR is little-endian.
@@ -948,6 +1279,156 @@ void UnitTestTask::task() {
 	} while (false);
 #endif
 
+#if 1
+	UNITTEST("Dump lines");
+	do {
+		static const char DATA[] = "0123456789ABCDEF\x00\x7f\n~";
+		static const char PROGRAM[] PROGMEM = "0123456789ABCDEF\x00\x7f\n~";
+		static const char GOLDEN[] = "0010: 30313233 34353637 38394142 43444546 |0123456789ABCDEF|\n\r0020: 007F0A7E                            |...~|\n\r";
+		char output[sizeof(GOLDEN)];
+		BufferSink buffersink(output, sizeof(output));
+		com::diag::amigo::Dump dump(buffersink);
+		if ((dump.lines(DATA, sizeof(DATA) - 1, 0x10) != (sizeof(GOLDEN) - 1)) || (memcmp(output, GOLDEN, sizeof(GOLDEN) - 1) != 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		buffersink.here = reinterpret_cast<uint8_t *>(output);
+		buffersink.remaining = sizeof(output);
+		com::diag::amigo::Dump dump_P(buffersink, true);
+		if ((dump_P.lines(PROGRAM, sizeof(PROGRAM) - 1, 0x10) != (sizeof(GOLDEN) - 1)) || (memcmp(output, GOLDEN, sizeof(GOLDEN) - 1) != 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Each line is a single bulk write.
+		CallingSink calling;
+		com::diag::amigo::Dump callingdump(calling);
+		if ((callingdump.lines(DATA, sizeof(DATA) - 1) != (sizeof(GOLDEN) - 1)) || (calling.calls != 2)) {
+			FAILED(__LINE__);
+			break;
+		}
+		// The same block is dumped as hexadecimal pairs and as lines.
+		uint8_t block[256];
+		for (size_t ii = 0; ii < sizeof(block); ++ii) {
+			block[ii] = ii;
+		}
+		CallingSink pairs;
+		com::diag::amigo::Dump pairsdump(pairs);
+		CallingSink lines;
+		com::diag::amigo::Dump linesdump(lines);
+		static const int ITERATIONS = 40;
+		com::diag::amigo::ticks_t then = elapsed();
+		for (int ii = 0; ii < ITERATIONS; ++ii) {
+			pairsdump(block, sizeof(block));
+		}
+		uint32_t pairsms = ticks2milliseconds(elapsed() - then);
+		then = elapsed();
+		for (int ii = 0; ii < ITERATIONS; ++ii) {
+			linesdump.lines(block, sizeof(block));
+		}
+		uint32_t linesms = ticks2milliseconds(elapsed() - then);
+		if (lines.calls >= pairs.calls) {
+			FAILED(__LINE__);
+			break;
+		}
+		PASSED();
+		printf(PSTR("pairs=%lucalls/%lucycles lines=%lucalls/%lucycles per byte\n"), static_cast<unsigned long>(pairs.calls / ITERATIONS), (pairsms * (F_CPU / 1000UL)) / (ITERATIONS * sizeof(block)), static_cast<unsigned long>(lines.calls / ITERATIONS), (linesms * (F_CPU / 1000UL)) / (ITERATIONS * sizeof(block)));
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("Filter");
+	// The golden values were computed independently by a model of the same
+	// integer arithmetic. The samples are a sawtooth with a period that isn't
+	// a power of two, so decimation groups and windows don't line up with it.
+	do {
+		typedef com::diag::amigo::Filter Filter;
+		static const uint16_t GOLDEN[4][6] = {
+			{ 0, 56, 956, 462, 551, 443 },
+			{ 1, 92, 968, 510, 570, 458 },
+			{ 2, 116, 868, 558, 610, 621 },
+			{ 3, 140, 892, 494, 547, 496 },
+		};
+		if (Filter::root(0) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (Filter::root(1) != 1) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (Filter::root(1023UL * 1023UL) != 1023) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (Filter::root((1023UL * 1023UL) - 1) != 1022) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (Filter::root(~static_cast<uint32_t>(0)) != 65535) {
+			FAILED(__LINE__);
+			break;
+		}
+		Filter::Summary summaries[sizeof(GOLDEN) / sizeof(GOLDEN[0])];
+		BufferSink sink(summaries, sizeof(summaries));
+		Filter filter(sink, 2, 4, 2);
+		uint16_t block[16];
+		size_t emitted = 0;
+		for (uint16_t ii = 0; ii < 256; ii += sizeof(block) / sizeof(block[0])) {
+			for (uint8_t jj = 0; jj < (sizeof(block) / sizeof(block[0])); ++jj) {
+				block[jj] = ((ii + jj) * 37UL) % 1024;
+			}
+			emitted += filter(block, sizeof(block) / sizeof(block[0]));
+		}
+		if (emitted != (sizeof(GOLDEN) / sizeof(GOLDEN[0]))) {
+			FAILED(__LINE__);
+			break;
+		}
+		uint8_t ii;
+		for (ii = 0; ii < (sizeof(GOLDEN) / sizeof(GOLDEN[0])); ++ii) {
+			if (summaries[ii].sequence != GOLDEN[ii][0]) { break; }
+			if (summaries[ii].minimum != GOLDEN[ii][1]) { break; }
+			if (summaries[ii].maximum != GOLDEN[ii][2]) { break; }
+			if (summaries[ii].mean != GOLDEN[ii][3]) { break; }
+			if (summaries[ii].rms != GOLDEN[ii][4]) { break; }
+			if (summaries[ii].average != GOLDEN[ii][5]) { break; }
+		}
+		if (ii < (sizeof(GOLDEN) / sizeof(GOLDEN[0]))) {
+			FAILED(__LINE__);
+			break;
+		}
+		// A constant full scale input should come out unchanged in every
+		// statistic, which checks the rounding and that nothing overflows at
+		// the largest window.
+		BufferSink constant(summaries, sizeof(summaries[0]));
+		Filter fullscale(constant, 0, Filter::WINDOW, 4);
+		emitted = 0;
+		for (uint16_t ii = 0; ii < (1U << Filter::WINDOW); ++ii) {
+			emitted += fullscale(1023);
+		}
+		if (emitted != 1) {
+			FAILED(__LINE__);
+			break;
+		}
+		if ((summaries[0].minimum != 1023) || (summaries[0].maximum != 1023) || (summaries[0].mean != 1023) || (summaries[0].rms != 1023) || (summaries[0].average != 1023)) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Benchmark: decimate by four, summarize every sixteen decimated
+		// samples, and throw the summaries away.
+		static const uint16_t SAMPLES = 16384;
+		com::diag::amigo::Sink & null = sink;
+		sink.remaining = 0;
+		Filter benchmark(null, 2, 4, 2);
+		com::diag::amigo::ticks_t then = elapsed();
+		for (uint16_t ii = 0; ii < SAMPLES; ++ii) {
+			benchmark(ii & 0x3ff);
+		}
+		uint32_t ms = ticks2milliseconds(elapsed() - then);
+		PASSED();
+		printf(PSTR("%luus/%usamples=%lucycles/sample\n"), ms * 1000, SAMPLES, (ms * (F_CPU / 1000UL)) / SAMPLES);
+	} while (false);
+#endif
+
 #if 1
 	UNITTEST("Uninterruptible");
 	do {
@@ -1316,69 +1797,900 @@ void UnitTestTask::task() {
 #endif
 
 #if 1
-	UNITTEST("GPIO");
-	// This is not a very good unit test. But I'm surprised about how much
-	// variance there is among megaAVRs in GPIO port nomenclature. For example,
-	// the ATmega328P (used on the Arduino Uno) starts with GPIO B. I'm sure
-	// there's a rhyme or reason for it, but I clueless as to what it is. The
-	// pins I check for below are the ones used by the Freetronics EtherMega
-	// 2560 (ATmega2560) and the Arduino Uno (ATmega328p) respectively for
-	// their diagnostic LEDs, and hence would be the pins likely used by Morse.
+	UNITTEST("Telegraph (uses LED)");
+	// First the Timer is left stopped and tick() stands in for it, so that
+	// the output can be checked unit by unit. Then the Timer plays a pattern
+	// while this task measures how long it takes.
 	do {
-		if (com::diag::amigo::GPIO::gpio2base(com::diag::amigo::GPIO::PIN_B7) != &PINB) {
+#if defined(__AVR_ATmega2560__) || !defined(__AVR__)
+		static const com::diag::amigo::GPIO::Pin LEDPIN = com::diag::amigo::GPIO::PIN_B7;
+#else
+		static const com::diag::amigo::GPIO::Pin LEDPIN = com::diag::amigo::GPIO::PIN_B5;
+#endif
+		static const com::diag::amigo::ticks_t UNIT = milliseconds2ticks(20);
+		// Dot, pause, dash, pause, word.
+		static const bool EXPECTED[] = { true, false, true, true, true, false, false, false, false, false, false, false };
+		com::diag::amigo::Telegraph telegraph(LEDPIN, UNIT);
+		if (!telegraph) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::GPIO::gpio2offset(com::diag::amigo::GPIO::PIN_B7) != 7) {
+		if (!telegraph.idle()) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::GPIO::gpio2mask(com::diag::amigo::GPIO::PIN_B7) != _BV(7)) {
+		if (!telegraph.morse(".- ")) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::GPIO::gpio2base(com::diag::amigo::GPIO::PIN_B4) != &PINB) {
+		if (telegraph.idle()) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::GPIO::gpio2offset(com::diag::amigo::GPIO::PIN_B4) != 4) {
+		uint8_t ii;
+		for (ii = 0; ii < sizeof(EXPECTED); ++ii) {
+			telegraph.tick();
+			if (com::diag::amigo::GPIO::get(LEDPIN) != EXPECTED[ii]) {
+				break;
+			}
+			if (telegraph.idle()) {
+				break;
+			}
+		}
+		if (ii < sizeof(EXPECTED)) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::GPIO::gpio2mask(com::diag::amigo::GPIO::PIN_B4) != _BV(4)) {
+		telegraph.tick();
+		if (!telegraph.idle()) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::GPIO::gpio2base(com::diag::amigo::GPIO::INVALID) != 0) {
+		if (com::diag::amigo::GPIO::get(LEDPIN)) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::GPIO::gpio2offset(com::diag::amigo::GPIO::INVALID) != static_cast<uint8_t>(~0)) {
+		// Too much to queue.
+		for (ii = 0; ii < com::diag::amigo::Telegraph::CAPACITY; ++ii) {
+			if (!telegraph.morse(".")) {
+				break;
+			}
+		}
+		if (ii >= com::diag::amigo::Telegraph::CAPACITY) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::GPIO::gpio2mask(com::diag::amigo::GPIO::INVALID) != 0) {
+		telegraph.drain();
+		if (!telegraph.idle()) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::GPIO::arduino2gpio(~0) != com::diag::amigo::GPIO::INVALID) {
+		if (!telegraph.start()) {
 			FAILED(__LINE__);
 			break;
 		}
+		com::diag::amigo::ticks_t then = elapsed();
+		telegraph.morse(".-");
+		com::diag::amigo::ticks_t queued = elapsed() - then;
+		while (!telegraph.idle() && ((elapsed() - then) < milliseconds2ticks(1000))) {
+			delay(1);
+		}
+		com::diag::amigo::ticks_t played = elapsed() - then;
+		telegraph.stop();
+		if (queued > 1) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Six units, plus up to a unit to the first timer tick, plus another to
+		// notice the end.
+		if (!(((6 * UNIT) <= played) && (played <= ((8 * UNIT) + 1)))) {
+			FAILED(__LINE__);
+			break;
+		}
+		printf(PSTR("queued=%ums played=%ums "), ticks2milliseconds(queued), ticks2milliseconds(played));
 		PASSED();
 	} while (false);
 #endif
 
 #if 1
-	UNITTEST("Digital I/O (requires text fixture on EtherMega)");
-	// This is a separate test because it requires a simple text fixture to be
-	// wired up on the board. It is specific to the EtherMega 2560 board.
-	// PE4 (Arduino Mega pin 2) wired to ground.
-	// PE5 (Arduino Mega pin 3) wired to 5V.
-	// PG5 (Arduino Mega pin 4) is otherwise in use (and may read high or low).
-	// PE3 (Arduino Mega pin 5) connected to PH3 (Arduino Mega pin 6).
-	// PH4 (Arduino Mega pin 7) not connected.
-	do {
+	UNITTEST("Ring");
+	{
+		static const com::diag::amigo::ticks_t T3 = 10;
+		static const uint8_t LIMIT = 200;
+		static const unsigned int ITERATIONS = 1024;
+		com::diag::amigo::RingQueue<uint8_t, 8> ring;
+		RingProducer producer(ring, milliseconds2ticks(T3));
+		do {
+			if (!ring) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (ring.capacity() != 8) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!ring.empty()) {
+				FAILED(__LINE__);
+				break;
+			}
+			uint8_t datum = 0;
+			bool flag = false;
+			if (ring.get(&datum)) {
+				FAILED(__LINE__);
+				break;
+			}
+			datum = 0xa5;
+			if (!ring.put(&datum, flag)) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!flag) {
+				FAILED(__LINE__);
+				break;
+			}
+			datum = 0x5a;
+			if (!ring.put(&datum, flag)) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (flag) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (ring.available() != 2) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!ring.get(&datum) || (datum != 0xa5)) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!ring.get(&datum) || (datum != 0x5a)) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!ring.empty()) {
+				FAILED(__LINE__);
+				break;
+			}
+			uint8_t data[11];
+			for (uint8_t ii = 0; ii < sizeof(data); ++ii) {
+				data[ii] = ii;
+			}
+			// The indices are not at zero so this wraps around the end.
+			if (ring.put(data, sizeof(data), flag) != 8) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!flag) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!ring.full()) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (ring.put(&datum)) {
+				FAILED(__LINE__);
+				break;
+			}
+			uint8_t buffer[sizeof(data)];
+			memset(buffer, 0xff, sizeof(buffer));
+			if (ring.get(buffer, 3, flag) != 3) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!flag) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (ring.get(&buffer[3], sizeof(buffer) - 3, flag) != 5) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (flag) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (memcmp(data, buffer, 8) != 0) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!ring.empty()) {
+				FAILED(__LINE__);
+				break;
+			}
+			datum = 0x3c;
+			if (!ring.put(&datum)) {
+				FAILED(__LINE__);
+				break;
+			}
+			datum = 0;
+			if (!ring.peek(&datum) || (datum != 0x3c)) {
+				FAILED(__LINE__);
+				break;
+			}
+			if ((ring.availableFromISR() != 1) || ring.isEmptyFromISR() || ring.isFullFromISR()) {
+				FAILED(__LINE__);
+				break;
+			}
+			ring.clear();
+			if (!ring.isEmptyFromISR()) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (ring.peek(&datum, milliseconds2ticks(T3))) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (ring.receive(&datum, milliseconds2ticks(T3))) {
+				FAILED(__LINE__);
+				break;
+			}
+			// The timer produces several bytes per period and this task blocks
+			// in between, so the ring goes empty and full repeatedly.
+			if (!producer.start()) {
+				FAILED(__LINE__);
+				break;
+			}
+			uint8_t expected = 0;
+			while (expected < LIMIT) {
+				if (!ring.receive(&datum, milliseconds2ticks(T3 * 10))) {
+					break;
+				}
+				if (datum != expected) {
+					break;
+				}
+				++expected;
+			}
+			producer.stop();
+			if (expected < LIMIT) {
+				FAILED(__LINE__);
+				break;
+			}
+			com::diag::amigo::Ring<uint8_t, 64> bench;
+			com::diag::amigo::TypedQueue<uint8_t> queue(64);
+			com::diag::amigo::ticks_t then = elapsed();
+			for (unsigned int ii = 0; ii < ITERATIONS; ++ii) {
+				bench.put(&datum);
+				bench.get(&datum);
+			}
+			com::diag::amigo::ticks_t ringticks = elapsed() - then;
+			then = elapsed();
+			for (unsigned int ii = 0; ii < ITERATIONS; ++ii) {
+				queue.send(&datum, com::diag::amigo::IMMEDIATELY);
+				queue.receive(&datum, com::diag::amigo::IMMEDIATELY);
+			}
+			com::diag::amigo::ticks_t queueticks = elapsed() - then;
+			printf(PSTR("ring=%ums queue=%ums per %u bytes "), ticks2milliseconds(ringticks), ticks2milliseconds(queueticks), ITERATIONS);
+			PASSED();
+		} while (false);
+		// Try to avoid taking a fatal() in the destructor because the timer
+		// task hasn't stopped the timer yet.
+		producer.stop();
+		delay(milliseconds2ticks(T3 * 10));
+	}
+#endif
+
+#if 1
+	UNITTEST("Pool");
+	do {
+		com::diag::amigo::Pool<sizeof(PooledTimer), 3> pool;
+		if (pool.size() != sizeof(PooledTimer)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if ((pool.capacity() != 3) || (pool.available() != 3) || (pool.minimum() != 3)) {
+			FAILED(__LINE__);
+			break;
+		}
+		void * first = pool.allocate();
+		void * second = pool.allocate(sizeof(PooledTimer));
+		void * third = pool.allocate(1);
+		if ((first == 0) || (second == 0) || (third == 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (static_cast<size_t>(static_cast<uint8_t *>(second) - static_cast<uint8_t *>(first)) != COM_DIAG_AMIGO_POOL_STRIDE(sizeof(PooledTimer))) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (pool.allocate() != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		if ((pool.available() != 0) || (pool.minimum() != 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		com::diag::amigo::Allocator::deallocate(second);
+		if (pool.available() != 1) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (pool.allocate(pool.size() + 1) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Stand in for an ISR by running uninterruptible.
+		void * again;
+		{
+			com::diag::amigo::Uninterruptible uninterruptible;
+			again = pool.allocate();
+			com::diag::amigo::Allocator::deallocate(again);
+		}
+		if (again != second) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (pool.available() != 1) {
+			FAILED(__LINE__);
+			break;
+		}
+		com::diag::amigo::Allocator::deallocate(first);
+		com::diag::amigo::Allocator::deallocate(third);
+		com::diag::amigo::Allocator::deallocate(0);
+		if ((pool.available() != 3) || (pool.minimum() != 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		// The fourth object doesn't fit so no constructor is called.
+		uint8_t destroyed = 0;
+		com::diag::amigo::Timer * timers[4];
+		for (uint8_t ii = 0; ii < 4; ++ii) {
+			timers[ii] = new (pool) PooledTimer(milliseconds2ticks(100), destroyed);
+		}
+		if ((timers[0] == 0) || (timers[1] == 0) || (timers[2] == 0) || (timers[3] != 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (pool.available() != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		for (uint8_t ii = 0; ii < 4; ++ii) {
+			delete timers[ii];
+		}
+		if (destroyed != 3) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (pool.available() != 3) {
+			FAILED(__LINE__);
+			break;
+		}
+		PASSED();
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("CPU");
+	do {
+		size_t before = tasks();
+		unsigned long total = cpuTotal();
+		unsigned long self = cpuSelf();
+		if (cpu() < self) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (busytask1.cpu() != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		// The busy tasks run at a higher priority than this one, sharing the
+		// processor with one another, so this task doesn't run again until
+		// both are done.
+		busytask1.start(DEPTH, PRIORITY + 1);
+		busytask2.start(DEPTH, PRIORITY + 1);
+		if ((busytask1 != true) || (busytask2 != true)) {
+			FAILED(__LINE__);
+			break;
+		}
+		while (!(busytask1.done && busytask2.done)) {
+			delay(milliseconds2ticks(100));
+		}
+		unsigned long busy1 = busytask1.cpu();
+		unsigned long busy2 = busytask2.cpu();
+		unsigned long elapsed = cpuTotal() - total;
+		if ((busy1 == 0) || (busy2 == 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if ((busy1 + busy2) > elapsed) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Busy1 did three times the work of Busy2.
+		unsigned long ratio = (busy1 * 10) / busy2;
+		if (!((24 <= ratio) && (ratio <= 36))) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (cpuSelf() < self) {
+			FAILED(__LINE__);
+			break;
+		}
+		com::diag::amigo::Task::RunTime runtimes[RUNTIMES];
+		size_t count = cpu(runtimes, RUNTIMES);
+		if (count != tasks()) {
+			FAILED(__LINE__);
+			break;
+		}
+		size_t found = 0;
+		for (size_t ii = 0; ii < count; ++ii) {
+			if (runtimes[ii].xHandle == busytask1.getHandle()) {
+				if (runtimes[ii].ulRunTimeCounter != busy1) { break; }
+				++found;
+			} else if (runtimes[ii].xHandle == busytask2.getHandle()) {
+				if (runtimes[ii].ulRunTimeCounter != busy2) { break; }
+				++found;
+			} else {
+				// Do nothing.
+			}
+		}
+		if (found != 2) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (cpu(serialsink) != count) {
+			FAILED(__LINE__);
+			break;
+		}
+		busytask1.stop();
+		busytask2.stop();
+		// The busy tasks must be deleted before their Task objects can be.
+		while ((busytask1 != false) || (busytask2 != false) || (tasks() != before)) {
+			delay(milliseconds2ticks(100));
+		}
+		printf(PSTR("busy1=%lu busy2=%lu elapsed=%lu ratio=%lu.%lu "), busy1, busy2, elapsed, ratio / 10, ratio % 10);
+		PASSED();
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("Log");
+	do {
+		uint8_t buffer[32];
+		BufferSink sink(buffer, sizeof(buffer));
+		com::diag::amigo::Log log(sink);
+		static const char FORMAT[] PROGMEM = "%d %u %s %c %%\n";
+		com::diag::amigo::ticks_t before = elapsed();
+		size_t length = log(FORMAT, -3, 300U, "ab", 'Z');
+		com::diag::amigo::ticks_t after = elapsed();
+		if (length != (sizeof(buffer) - sink.remaining)) {
+			FAILED(__LINE__);
+			break;
+		}
+		const uint8_t * here = buffer;
+		if (*(here++) != com::diag::amigo::Log::RECORD) {
+			FAILED(__LINE__);
+			break;
+		}
+		uint8_t address[sizeof(uintptr_t) * 2];
+		size_t size = com::diag::amigo::Log::varint(address, reinterpret_cast<uintptr_t>(FORMAT));
+		if (memcmp(here, address, size) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		here += size;
+		unsigned long ticks = 0;
+		uint8_t shift = 0;
+		do {
+			ticks |= static_cast<unsigned long>(*here & 0x7f) << shift;
+			shift += 7;
+		} while ((*(here++) & 0x80) != 0);
+		if (!((before <= ticks) && (ticks <= after))) {
+			FAILED(__LINE__);
+			break;
+		}
+		// -3 zig-zags to 5, 300 takes two bytes, the string is its length
+		// and characters, the character is its value, and %% is nothing.
+		static const uint8_t ARGUMENTS[] = { 0x05, 0xac, 0x02, 0x02, 'a', 'b', 'Z' };
+		if (static_cast<size_t>((buffer + length) - here) != sizeof(ARGUMENTS)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (memcmp(here, ARGUMENTS, sizeof(ARGUMENTS)) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		// A long double is narrowed to a double and is followed by the same
+		// arguments as it would be without the L.
+		static const char EXTENDED[] PROGMEM = "%Lf %d\n";
+		sink.here = buffer;
+		sink.remaining = sizeof(buffer);
+		length = log(EXTENDED, static_cast<long double>(2.5), -3);
+		if (length != (sizeof(buffer) - sink.remaining)) {
+			FAILED(__LINE__);
+			break;
+		}
+		here = buffer;
+		if (*(here++) != com::diag::amigo::Log::RECORD) {
+			FAILED(__LINE__);
+			break;
+		}
+		here += com::diag::amigo::Log::varint(address, reinterpret_cast<uintptr_t>(EXTENDED));
+		while ((*(here++) & 0x80) != 0) {}
+		if (static_cast<size_t>((buffer + length) - here) != (sizeof(double) + 1)) {
+			FAILED(__LINE__);
+			break;
+		}
+		double value;
+		memcpy(&value, here, sizeof(value));
+		here += sizeof(value);
+		if (value != 2.5) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (*here != 0x05) {
+			FAILED(__LINE__);
+			break;
+		}
+		static const char BENCHMARK[] PROGMEM = "task=%s tick=%u free=%u value=%d\n";
+		static const int ITERATIONS = 200;
+		CountingSink counter;
+		com::diag::amigo::Print print(counter, true);
+		com::diag::amigo::ticks_t then = elapsed();
+		for (int ii = 0; ii < ITERATIONS; ++ii) {
+			print(BENCHMARK, getName(), ii, 1234U, -ii);
+		}
+		uint32_t printms = ticks2milliseconds(elapsed() - then);
+		size_t printbytes = counter.count;
+		counter.count = 0;
+		com::diag::amigo::Log logger(counter);
+		then = elapsed();
+		for (int ii = 0; ii < ITERATIONS; ++ii) {
+			logger(BENCHMARK, getName(), ii, 1234U, -ii);
+		}
+		uint32_t logms = ticks2milliseconds(elapsed() - then);
+		size_t logbytes = counter.count;
+		if (logbytes >= printbytes) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (logms > printms) {
+			FAILED(__LINE__);
+			break;
+		}
+		PASSED();
+		printf(PSTR("print=%lucycles/%ubytes log=%lucycles/%ubytes per call\n"), (printms * (F_CPU / 1000UL)) / ITERATIONS, printbytes / ITERATIONS, (logms * (F_CPU / 1000UL)) / ITERATIONS, logbytes / ITERATIONS);
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("Formatter");
+	do {
+		static const char FORMAT1[] PROGMEM = "%d %u %x %X %s %lu %ld %p %c\n";
+		static const char FORMAT2[] PROGMEM = "%-8s|%10lu|%4s|%02x|%2.2x|%5d|%-5u|%+d|%%\n";
+		uint8_t expected[64];
+		uint8_t actual[64];
+		BufferSink expectedsink(expected, sizeof(expected));
+		BufferSink actualsink(actual, sizeof(actual));
+		com::diag::amigo::Print print(expectedsink, true);
+		com::diag::amigo::Formatter<true> format(actualsink);
+		size_t expectedlength = print(FORMAT1, -42, 42U, 0xbeefU, 0xbeefU, "ram", 4000000000UL, -2000000000L, reinterpret_cast<void *>(0x1234), 'c');
+		size_t actuallength = format(FORMAT1, -42, 42U, 0xbeefU, 0xbeefU, "ram", 4000000000UL, -2000000000L, reinterpret_cast<void *>(0x1234), 'c');
+		if ((actuallength != expectedlength) || (memcmp(actual, expected, expectedlength) != 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		expectedsink.here = expected;
+		actualsink.here = actual;
+		expectedsink.remaining = actualsink.remaining = sizeof(expected);
+		expectedlength = print(FORMAT2, "abc", 7UL, "abcdef", 5U, 0xaU, -42, 42U, 42);
+		actuallength = format(FORMAT2, "abc", 7UL, "abcdef", 5U, 0xaU, -42, 42U, 42);
+		if ((actuallength != expectedlength) || (memcmp(actual, expected, expectedlength) != 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		// A data space format string, a program space string argument, and
+		// a line longer than Print can produce.
+		static const char PROGRAM[] PROGMEM = "program";
+		static const char LONGER[] = "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789";
+		CountingSink counter;
+		com::diag::amigo::Formatter<false> dataformat(counter);
+		if (dataformat("%S %s", PROGRAM, LONGER) != (sizeof(PROGRAM) - 1 + 1 + sizeof(LONGER) - 1)) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Each measurement of stack usage is made in a new task so that the
+		// high water mark is that of the one call.
+		size_t before = tasks();
+		printingtask.start(PRINTINGDEPTH);
+		formattingtask.start(PRINTINGDEPTH);
+		while (!(printingtask.done && formattingtask.done)) {
+			delay(milliseconds2ticks(100));
+		}
+		size_t printstack = PRINTINGDEPTH - printingtask.unused;
+		size_t formatstack = PRINTINGDEPTH - formattingtask.unused;
+		printingtask.stop();
+		formattingtask.stop();
+		while ((printingtask != false) || (formattingtask != false) || (tasks() != before)) {
+			delay(milliseconds2ticks(100));
+		}
+		if (formatstack >= printstack) {
+			FAILED(__LINE__);
+			break;
+		}
+		static const int ITERATIONS = 200;
+		counter.count = 0;
+		com::diag::amigo::Print printer(counter, true);
+		com::diag::amigo::ticks_t then = elapsed();
+		for (int ii = 0; ii < ITERATIONS; ++ii) {
+			printer(PRINTING, getName(), 4000000000UL, -ii, ii, ii, "string");
+		}
+		uint32_t printms = ticks2milliseconds(elapsed() - then);
+		com::diag::amigo::Formatter<true> formatter(counter);
+		then = elapsed();
+		for (int ii = 0; ii < ITERATIONS; ++ii) {
+			formatter(PRINTING, getName(), 4000000000UL, -ii, ii, ii, "string");
+		}
+		uint32_t formatms = ticks2milliseconds(elapsed() - then);
+		PASSED();
+		printf(PSTR("print=%lucycles/%ubytes formatter=%lucycles/%ubytes per call\n"), (printms * (F_CPU / 1000UL)) / ITERATIONS, printstack, (formatms * (F_CPU / 1000UL)) / ITERATIONS, formatstack);
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("convert");
+	do {
+		struct Golden { uint64_t value; uint8_t base; char alpha; PGM_P expected; };
+		static const char GOLDEN0[] PROGMEM = "0";
+		static const char GOLDEN1[] PROGMEM = "18446744073709551615";
+		static const char GOLDEN2[] PROGMEM = "FFFFFFFFFFFFFFFF";
+		static const char GOLDEN3[] PROGMEM = "1777777777777777777777";
+		static const char GOLDEN4[] PROGMEM = "1111111111111111111111111111111111111111111111111111111111111111";
+		static const char GOLDEN5[] PROGMEM = "10000000000000000000";
+		static const char GOLDEN6[] PROGMEM = "9999999999999999999";
+		static const char GOLDEN7[] PROGMEM = "4294967296";
+		static const char GOLDEN8[] PROGMEM = "deadbeefcafebabe";
+		static const char GOLDEN9[] PROGMEM = "3W5E11264SGSF";
+		static const Golden GOLDEN[] = {
+			{ 0ULL, 10, 'A', GOLDEN0 },
+			{ 0xffffffffffffffffULL, 10, 'A', GOLDEN1 },
+			{ 0xffffffffffffffffULL, 16, 'A', GOLDEN2 },
+			{ 0xffffffffffffffffULL, 8, 'A', GOLDEN3 },
+			{ 0xffffffffffffffffULL, 2, 'A', GOLDEN4 },
+			{ 10000000000000000000ULL, 10, 'A', GOLDEN5 },
+			{ 9999999999999999999ULL, 0, 'A', GOLDEN6 },
+			{ 4294967296ULL, 10, 'A', GOLDEN7 },
+			{ 0xdeadbeefcafebabeULL, 16, 'a', GOLDEN8 },
+			{ 0xffffffffffffffffULL, 36, 'A', GOLDEN9 },
+		};
+		char digits[AMIGO_CONVERT_DIGITS];
+		size_t ii;
+		for (ii = 0; ii < (sizeof(GOLDEN) / sizeof(GOLDEN[0])); ++ii) {
+			uint8_t count = com::diag::amigo::convert(digits, GOLDEN[ii].value, GOLDEN[ii].base, GOLDEN[ii].alpha);
+			if (count != strlen_P(GOLDEN[ii].expected)) { break; }
+			uint8_t jj;
+			for (jj = 0; jj < count; ++jj) {
+				if (digits[count - 1 - jj] != static_cast<char>(pgm_read_byte(&GOLDEN[ii].expected[jj]))) { break; }
+			}
+			if (jj < count) { break; }
+		}
+		if (ii < (sizeof(GOLDEN) / sizeof(GOLDEN[0]))) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Each conversion is timed against the repeated sixty-four bit
+		// division that LongLongPrint used to do, for the largest value of
+		// each width. Reading the value through a volatile keeps the compiler
+		// from hoisting the conversion out of the loop.
+		static const uint8_t WIDTHS[] = { 8, 16, 32, 64 };
+		static const uint8_t BASES[] = { 2, 8, 10, 16 };
+		static const int ITERATIONS = 500;
+		uint32_t convertcycles[sizeof(WIDTHS) / sizeof(WIDTHS[0])][sizeof(BASES) / sizeof(BASES[0])];
+		uint32_t dividecycles[sizeof(WIDTHS) / sizeof(WIDTHS[0])][sizeof(BASES) / sizeof(BASES[0])];
+		volatile uint64_t source;
+		for (size_t ww = 0; ww < (sizeof(WIDTHS) / sizeof(WIDTHS[0])); ++ww) {
+			source = (WIDTHS[ww] < 64) ? ((1ULL << WIDTHS[ww]) - 1) : 0xffffffffffffffffULL;
+			for (size_t bb = 0; bb < (sizeof(BASES) / sizeof(BASES[0])); ++bb) {
+				uint8_t base = BASES[bb];
+				com::diag::amigo::ticks_t then = elapsed();
+				for (int kk = 0; kk < ITERATIONS; ++kk) {
+					com::diag::amigo::convert(digits, source, base);
+				}
+				convertcycles[ww][bb] = (ticks2milliseconds(elapsed() - then) * (F_CPU / 1000UL)) / ITERATIONS;
+				then = elapsed();
+				for (int kk = 0; kk < ITERATIONS; ++kk) {
+					uint64_t n = source;
+					uint8_t count = 0;
+					do {
+						uint64_t m = n;
+						n /= base;
+						digits[count++] = m - (base * n);
+					} while (n > 0);
+				}
+				dividecycles[ww][bb] = (ticks2milliseconds(elapsed() - then) * (F_CPU / 1000UL)) / ITERATIONS;
+			}
+		}
+		PASSED();
+		for (size_t ww = 0; ww < (sizeof(WIDTHS) / sizeof(WIDTHS[0])); ++ww) {
+			printf(PSTR("%ubits base2=%lu/%lu base8=%lu/%lu base10=%lu/%lu base16=%lu/%lu cycles convert/divide\n"), WIDTHS[ww], convertcycles[ww][0], dividecycles[ww][0], convertcycles[ww][1], dividecycles[ww][1], convertcycles[ww][2], dividecycles[ww][2], convertcycles[ww][3], dividecycles[ww][3]);
+		}
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("BufferedSink");
+	do {
+		static const char EXPECTED[] = "abc\n0123456789xyz012301234567890123456789z";
+		static const char DIGITS[] PROGMEM = "0123456789";
+		uint8_t output[sizeof(EXPECTED)];
+		BufferSink buffersink(output, sizeof(output));
+		com::diag::amigo::BufferedSink<16> buffered(buffersink);
+		if (buffered.capacity() != 16) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Nothing reaches the wrapped Sink until a newline.
+		if ((buffered.write("abc") != 3) || (buffered.pending() != 3) || (buffersink.remaining != sizeof(output))) {
+			FAILED(__LINE__);
+			break;
+		}
+		if ((buffered.write('\n') != 1) || (buffered.pending() != 0) || (buffersink.remaining != (sizeof(output) - 4))) {
+			FAILED(__LINE__);
+			break;
+		}
+		// A full buffer is forwarded and the remainder kept.
+		if ((buffered.write_P(DIGITS, 10) != 10) || (buffered.pending() != 10)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if ((buffered.write("xyz0123", 7) != 7) || (buffered.pending() != 1) || (buffersink.remaining != (sizeof(output) - 20))) {
+			FAILED(__LINE__);
+			break;
+		}
+		// A write as large as the buffer goes straight through after it.
+		if ((buffered.write("01234567890123456789", 20) != 20) || (buffered.pending() != 0) || (buffersink.remaining != (sizeof(output) - 41))) {
+			FAILED(__LINE__);
+			break;
+		}
+		buffered.write('z');
+		buffered.flush();
+		if ((buffered.pending() != 0) || (buffersink.remaining != (sizeof(output) - 42)) || (memcmp(output, EXPECTED, sizeof(EXPECTED) - 1) != 0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		// What the wrapped Sink doesn't accept stays buffered until the
+		// buffer is full.
+		buffersink.here = output;
+		buffersink.remaining = 4;
+		size_t accepted = 0;
+		for (int ii = 0; ii < 32; ++ii) {
+			accepted += buffered.write('a');
+		}
+		if ((accepted != (4 + 16)) || (buffered.pending() != 16)) {
+			FAILED(__LINE__);
+			break;
+		}
+		buffersink.here = output;
+		buffersink.remaining = sizeof(output);
+		{
+			com::diag::amigo::BufferedSink<16> destroyed(buffersink);
+			destroyed.write('q');
+		}
+		if ((buffersink.remaining != (sizeof(output) - 1)) || (output[0] != 'q')) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Without newlines but with a latency of two ticks, a byte is
+		// forwarded once it has waited that long.
+		buffersink.here = output;
+		buffersink.remaining = sizeof(output);
+		{
+			com::diag::amigo::BufferedSink<16> latent(buffersink, false, 2);
+			latent.write('\n');
+			if ((latent.pending() != 1) || (latent.poll() != 0)) {
+				FAILED(__LINE__);
+				break;
+			}
+			delay(3);
+			if ((latent.poll() != 1) || (latent.pending() != 0) || (buffersink.remaining != (sizeof(output) - 1))) {
+				FAILED(__LINE__);
+				break;
+			}
+		}
+		// The same Print and Dump output is written to a CallingSink directly
+		// and through a BufferedSink, counting the calls that reach it.
+		static const char LINE[] PROGMEM = "%-8s|%10lu|%d|%u|%02x|%s\n";
+		static const int ITERATIONS = 100;
+		CallingSink direct;
+		com::diag::amigo::Print directprint(direct, true);
+		com::diag::amigo::Dump directdump(direct);
+		com::diag::amigo::ticks_t then = elapsed();
+		for (int ii = 0; ii < ITERATIONS; ++ii) {
+			directprint(LINE, getName(), 4000000000UL, -ii, ii, ii, "string");
+			directdump(EXPECTED, 16);
+		}
+		uint32_t directms = ticks2milliseconds(elapsed() - then);
+		CallingSink indirect;
+		uint32_t bufferedms;
+		{
+			com::diag::amigo::BufferedSink<64> coalescing(indirect);
+			com::diag::amigo::Print bufferedprint(coalescing, true);
+			com::diag::amigo::Dump buffereddump(coalescing);
+			then = elapsed();
+			for (int ii = 0; ii < ITERATIONS; ++ii) {
+				bufferedprint(LINE, getName(), 4000000000UL, -ii, ii, ii, "string");
+				buffereddump(EXPECTED, 16);
+			}
+			coalescing.flush();
+			bufferedms = ticks2milliseconds(elapsed() - then);
+		}
+		if ((indirect.bytes != direct.bytes) || (indirect.calls >= direct.calls)) {
+			FAILED(__LINE__);
+			break;
+		}
+		PASSED();
+		printf(PSTR("direct=%lucalls/%lucycles buffered=%lucalls/%lucycles per %lubytes\n"), static_cast<unsigned long>(direct.calls), directms * (F_CPU / 1000UL), static_cast<unsigned long>(indirect.calls), bufferedms * (F_CPU / 1000UL), static_cast<unsigned long>(direct.bytes));
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("GPIO");
+	// This is not a very good unit test. But I'm surprised about how much
+	// variance there is among megaAVRs in GPIO port nomenclature. For example,
+	// the ATmega328P (used on the Arduino Uno) starts with GPIO B. I'm sure
+	// there's a rhyme or reason for it, but I clueless as to what it is. The
+	// pins I check for below are the ones used by the Freetronics EtherMega
+	// 2560 (ATmega2560) and the Arduino Uno (ATmega328p) respectively for
+	// their diagnostic LEDs, and hence would be the pins likely used by Morse.
+	do {
+		if (com::diag::amigo::GPIO::gpio2base(com::diag::amigo::GPIO::PIN_B7) != &PINB) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::GPIO::gpio2offset(com::diag::amigo::GPIO::PIN_B7) != 7) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::GPIO::gpio2mask(com::diag::amigo::GPIO::PIN_B7) != _BV(7)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::GPIO::gpio2base(com::diag::amigo::GPIO::PIN_B4) != &PINB) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::GPIO::gpio2offset(com::diag::amigo::GPIO::PIN_B4) != 4) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::GPIO::gpio2mask(com::diag::amigo::GPIO::PIN_B4) != _BV(4)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::GPIO::gpio2base(com::diag::amigo::GPIO::INVALID) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::GPIO::gpio2offset(com::diag::amigo::GPIO::INVALID) != static_cast<uint8_t>(~0)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::GPIO::gpio2mask(com::diag::amigo::GPIO::INVALID) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::GPIO::arduino2gpio(~0) != com::diag::amigo::GPIO::INVALID) {
+			FAILED(__LINE__);
+			break;
+		}
+		PASSED();
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("Digital I/O (requires text fixture on EtherMega)");
+	// This is a separate test because it requires a simple text fixture to be
+	// wired up on the board. It is specific to the EtherMega 2560 board.
+	// PE4 (Arduino Mega pin 2) wired to ground.
+	// PE5 (Arduino Mega pin 3) wired to 5V.
+	// PG5 (Arduino Mega pin 4) is otherwise in use (and may read high or low).
+	// PE3 (Arduino Mega pin 5) connected to PH3 (Arduino Mega pin 6).
+	// PH4 (Arduino Mega pin 7) not connected.
+	do {
 		typedef com::diag::amigo::GPIO GPIO;
 		GPIO::Pin pin2 = GPIO::arduino2gpio(2);
 		if (pin2 != GPIO::PIN_E4) {
@@ -1497,6 +2809,107 @@ void UnitTestTask::task() {
 	} while (false);
 #endif
 
+#if 1
+	UNITTEST("GPIO output initial (uses LED)");
+	// Setting a pin to output with an initial value must leave the pin at
+	// that value, and only the pins in the mask are changed.
+	do {
+		com::diag::amigo::GPIO::Pin pin = com::diag::amigo::GPIO::arduino2gpio(13);
+		com::diag::amigo::GPIO gpio(pin);
+		uint8_t mask = com::diag::amigo::GPIO::gpio2mask(pin);
+		gpio.output(mask, mask);
+		if (gpio.get(mask) != mask) {
+			FAILED(__LINE__);
+			break;
+		}
+		gpio.output(mask, 0);
+		if (gpio.get(mask) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		gpio.output(mask, ~mask);
+		if (gpio.get(mask) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		gpio.output(mask, 0xff);
+		if (gpio.get(mask) != mask) {
+			FAILED(__LINE__);
+			break;
+		}
+		gpio.clear(mask);
+		PASSED();
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("FastPin (uses LED)");
+	// FastPin and GPIO drive the same pin, so each should see what the other
+	// did. Then the two are timed against one another. FastPin should be
+	// many times faster since each operation is a single SBI or CBI
+	// instruction instead of a table lookup and an uninterruptible
+	// read-modify-write.
+	do {
+#if defined(__AVR_ATmega2560__)
+		static const com::diag::amigo::GPIO::Pin LEDPIN = com::diag::amigo::GPIO::PIN_B7;
+#else
+		static const com::diag::amigo::GPIO::Pin LEDPIN = com::diag::amigo::GPIO::PIN_B5;
+#endif
+		typedef com::diag::amigo::FastPin<LEDPIN> LED;
+		static const uint16_t ITERATIONS = 20000;
+		LED::output(false);
+		if (LED::get()) {
+			FAILED(__LINE__);
+			break;
+		}
+		LED::set();
+		if (!com::diag::amigo::GPIO::get(LEDPIN)) {
+			FAILED(__LINE__);
+			break;
+		}
+		LED::toggle();
+		if (com::diag::amigo::GPIO::get(LEDPIN)) {
+			FAILED(__LINE__);
+			break;
+		}
+		com::diag::amigo::GPIO::set(LEDPIN);
+		if (!LED::get()) {
+			FAILED(__LINE__);
+			break;
+		}
+		{
+			com::diag::amigo::FastToggleOff<LEDPIN> off;
+			if (LED::get()) {
+				FAILED(__LINE__);
+				break;
+			}
+		}
+		if (!LED::get()) {
+			FAILED(__LINE__);
+			break;
+		}
+		com::diag::amigo::ticks_t then = elapsed();
+		for (uint16_t ii = 0; ii < ITERATIONS; ++ii) {
+			com::diag::amigo::GPIO::clear(LEDPIN);
+			com::diag::amigo::GPIO::set(LEDPIN);
+		}
+		com::diag::amigo::ticks_t gpioticks = elapsed() - then;
+		then = elapsed();
+		for (uint16_t ii = 0; ii < ITERATIONS; ++ii) {
+			LED::clear();
+			LED::set();
+		}
+		com::diag::amigo::ticks_t fastticks = elapsed() - then;
+		LED::clear();
+		if (fastticks > gpioticks) {
+			FAILED(__LINE__);
+			break;
+		}
+		printf(PSTR("gpio=%ums fastpin=%ums per %u pulses "), ticks2milliseconds(gpioticks), ticks2milliseconds(fastticks), ITERATIONS);
+		PASSED();
+	} while (false);
+#endif
+
 #if 1
 	UNITTEST("PWM");
 	// This should work on either the 2560 (Arduino Mega and compatibles) or
@@ -1513,116 +2926,340 @@ void UnitTestTask::task() {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::HIGH != 0xffU) {
+		if (com::diag::amigo::PWM::HIGH != 0xffU) {
+			FAILED(__LINE__);
+			break;
+		}
+#if defined(TCCR0B) && !defined(portUSE_TIMER0)
+		if (com::diag::amigo::PWM::pwm2control(com::diag::amigo::PWM::PIN_0B) != &TCCR0A) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2outputcompare8(com::diag::amigo::PWM::PIN_0B) != &OCR0B) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2outputcompare16(com::diag::amigo::PWM::PIN_0B) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2offset(com::diag::amigo::PWM::PIN_0B) != COM0B1) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2mask(com::diag::amigo::PWM::PIN_0B) != _BV(COM0B1)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2timer(com::diag::amigo::PWM::PIN_0B) != com::diag::amigo::PWM::TIMER_0) {
+			FAILED(__LINE__);
+			break;
+		}
+#endif
+#if defined(TCCR1A) && !defined(portUSE_TIMER1)
+		if (com::diag::amigo::PWM::pwm2control(com::diag::amigo::PWM::PIN_1A) != &TCCR1A) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2outputcompare8(com::diag::amigo::PWM::PIN_1A) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2outputcompare16(com::diag::amigo::PWM::PIN_1A) != &OCR1A) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2offset(com::diag::amigo::PWM::PIN_1A) != COM1A1) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2mask(com::diag::amigo::PWM::PIN_1A) != _BV(COM1A1)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2timer(com::diag::amigo::PWM::PIN_1A) != com::diag::amigo::PWM::TIMER_1) {
+			FAILED(__LINE__);
+			break;
+		}
+#endif
+#if defined(TCCR2A) && !defined(portUSE_TIMER2)
+		if (com::diag::amigo::PWM::pwm2control(com::diag::amigo::PWM::PIN_2A) != &TCCR2A) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2outputcompare8(com::diag::amigo::PWM::PIN_2A) != &OCR2A) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2outputcompare16(com::diag::amigo::PWM::PIN_2A) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2offset(com::diag::amigo::PWM::PIN_2A) != COM2A1) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2mask(com::diag::amigo::PWM::PIN_2A) != _BV(COM2A1)) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::pwm2timer(com::diag::amigo::PWM::PIN_2A) != com::diag::amigo::PWM::TIMER_2) {
 			FAILED(__LINE__);
 			break;
 		}
-#if defined(TCCR0B) && !defined(portUSE_TIMER0)
-		if (com::diag::amigo::PWM::pwm2control(com::diag::amigo::PWM::PIN_0B) != &TCCR0A) {
+#endif
+		if (com::diag::amigo::PWM::pwm2control(com::diag::amigo::PWM::INVALID) != 0) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2outputcompare8(com::diag::amigo::PWM::PIN_0B) != &OCR0B) {
+		if (com::diag::amigo::PWM::pwm2outputcompare8(com::diag::amigo::PWM::INVALID) != 0) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2outputcompare16(com::diag::amigo::PWM::PIN_0B) != 0) {
+		if (com::diag::amigo::PWM::pwm2outputcompare16(com::diag::amigo::PWM::INVALID) != 0) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2offset(com::diag::amigo::PWM::PIN_0B) != COM0B1) {
+		if (com::diag::amigo::PWM::pwm2offset(com::diag::amigo::PWM::INVALID) != static_cast<uint8_t>(~0)) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2mask(com::diag::amigo::PWM::PIN_0B) != _BV(COM0B1)) {
+		if (com::diag::amigo::PWM::pwm2mask(com::diag::amigo::PWM::INVALID) != 0) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2timer(com::diag::amigo::PWM::PIN_0B) != com::diag::amigo::PWM::TIMER_0) {
+		if (com::diag::amigo::PWM::pwm2timer(com::diag::amigo::PWM::INVALID) != com::diag::amigo::PWM::NONE) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (com::diag::amigo::PWM::arduino2pwm(~0) != com::diag::amigo::PWM::INVALID) {
 			FAILED(__LINE__);
 			break;
 		}
+		PASSED();
+	} while (false);
 #endif
-#if defined(TCCR1A) && !defined(portUSE_TIMER1)
-		if (com::diag::amigo::PWM::pwm2control(com::diag::amigo::PWM::PIN_1A) != &TCCR1A) {
+
+#if 1
+	UNITTEST("PWM 16-bit");
+	// This checks the timer registers against a table of frequencies computed
+	// for a 16MHz CPU clock. It uses timer 1, so it is suppressed if that
+	// timer provides the FreeRTOS tick. PIN_1A isn't wired to anything on the
+	// test boards.
+	do {
+		typedef com::diag::amigo::PWM PWM;
+		if (PWM::prestart(PWM::TIMER_2, 1000) != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+#if defined(TCCR1A) && !defined(portUSE_TIMER1) && (F_CPU == 16000000L)
+		static const struct { uint32_t hertz; uint16_t top; uint8_t cs; } TABLE[] = {
+			{ 0, 0, 0 },
+			{ 1, 62499, _BV(CS12) },
+			{ 50, 39999, _BV(CS11) },
+			{ 244, 8195, _BV(CS11) },
+			{ 245, 65305, _BV(CS10) },
+			{ 490, 32652, _BV(CS10) },
+			{ 20000, 799, _BV(CS10) },
+			{ 4000000, 3, _BV(CS10) },
+			{ 8000000, 0, 0 },
+			{ 16000000, 0, 0 },
+			{ 1000, 15999, _BV(CS10) },
+		};
+		uint8_t ii;
+		for (ii = 0; ii < (sizeof(TABLE) / sizeof(TABLE[0])); ++ii) {
+			if (PWM::prestart(PWM::TIMER_1, TABLE[ii].hertz) != TABLE[ii].top) {
+				break;
+			}
+			if (TABLE[ii].top == 0) {
+				continue;
+			}
+			if (ICR1 != TABLE[ii].top) {
+				break;
+			}
+			if ((TCCR1A & (_BV(WGM11) | _BV(WGM10))) != _BV(WGM11)) {
+				break;
+			}
+			if (TCCR1B != (_BV(WGM13) | _BV(WGM12) | TABLE[ii].cs)) {
+				break;
+			}
+		}
+		if (ii < (sizeof(TABLE) / sizeof(TABLE[0]))) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2outputcompare8(com::diag::amigo::PWM::PIN_1A) != 0) {
+		// The last entry left timer 1 at 1000Hz with a TOP of 15999.
+		PWM pwm(PWM::PIN_1A);
+		if (!pwm) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2outputcompare16(com::diag::amigo::PWM::PIN_1A) != &OCR1A) {
+		pwm.start16(32768);
+		if (OCR1A != 8000) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2offset(com::diag::amigo::PWM::PIN_1A) != COM1A1) {
+		if ((TCCR1A & _BV(COM1A1)) == 0) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2mask(com::diag::amigo::PWM::PIN_1A) != _BV(COM1A1)) {
+		pwm.start16(65535);
+		if (OCR1A != 15999) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2timer(com::diag::amigo::PWM::PIN_1A) != com::diag::amigo::PWM::TIMER_1) {
+		pwm.start16(1);
+		if ((TCCR1A & _BV(COM1A1)) != 0) {
 			FAILED(__LINE__);
 			break;
 		}
-#endif
-#if defined(TCCR2A) && !defined(portUSE_TIMER2)
-		if (com::diag::amigo::PWM::pwm2control(com::diag::amigo::PWM::PIN_2A) != &TCCR2A) {
+		if (com::diag::amigo::GPIO::get(PWM::pwm2gpio(PWM::PIN_1A))) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2outputcompare8(com::diag::amigo::PWM::PIN_2A) != &OCR2A) {
+		// Back to eight-bit phase correct mode, where the sixteen-bit duty
+		// cycle is scaled to eight bits.
+		if (PWM::prestart(PWM::TIMER_1) != PWM::TIMER_1) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2outputcompare16(com::diag::amigo::PWM::PIN_2A) != 0) {
+		pwm.start16(32768);
+		if (OCR1A != 128) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2offset(com::diag::amigo::PWM::PIN_2A) != COM2A1) {
+		pwm.stop();
+#endif
+		PASSED();
+	} while (false);
+#endif
+
+#if 1
+	UNITTEST("PWMGroup");
+	// The pins are never connected to their timers, so nothing is driven;
+	// only the output compare registers are checked.
+	do {
+		typedef com::diag::amigo::PWM PWM;
+		typedef com::diag::amigo::PWMGroup<4> PWMGroup;
+		static const PWM::Pin PINS[] = { PWM::PIN_2A, PWM::PIN_0B, PWM::PIN_2B };
+		if (PWM::prestart(PWM::TIMER_0) != PWM::TIMER_0) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2mask(com::diag::amigo::PWM::PIN_2A) != _BV(COM2A1)) {
+#if defined(COM_DIAG_AMIGO_RUNTIME_TIMER5)
+		// Timer5 is the counter for the run time statistics.
+		if ((PWM::prestart(PWM::TIMER_5) != PWM::NONE) || (PWM::prestart(PWM::TIMER_5, 1000) != 0) || (PWM::timer2interruptflag(PWM::TIMER_5) != 0)) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2timer(com::diag::amigo::PWM::PIN_2A) != com::diag::amigo::PWM::TIMER_2) {
+#endif
+		if (PWM::prestart(PWM::TIMER_2) != PWM::TIMER_2) {
 			FAILED(__LINE__);
 			break;
 		}
+		{
+			static const PWM::Pin TOOMANY[] = { PWM::PIN_2A, PWM::PIN_0B, PWM::PIN_2B, PWM::PIN_0A, PWM::PIN_2A };
+			PWMGroup bogus(TOOMANY, sizeof(TOOMANY) / sizeof(TOOMANY[0]));
+			if (bogus) {
+				FAILED(__LINE__);
+				break;
+			}
+		}
+#if !defined(portUSE_TIMER4) && defined(ICR4)
+		{
+			// Eight-bit duty cycles can't be committed to a sixteen-bit TOP.
+			static const PWM::Pin WIDE[] = { PWM::PIN_4A };
+			PWMGroup wide(WIDE, sizeof(WIDE) / sizeof(WIDE[0]));
+			if (!wide) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (PWM::prestart(PWM::TIMER_4, 1000) == 0) {
+				FAILED(__LINE__);
+				break;
+			}
+			bool committed = wide.commit();
+			PWM::prestart(PWM::TIMER_4);
+			if (committed) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (!wide.commit()) {
+				FAILED(__LINE__);
+				break;
+			}
+			// The ten-bit phase correct mode 3 has a TOP of 0x3ff, but the
+			// eight-bit fast PWM mode 5 has a TOP of 0xff like mode 1.
+			TCCR4A |= _BV(WGM41);
+			committed = wide.commit();
+			TCCR4A &= ~_BV(WGM41);
+			if (committed) {
+				FAILED(__LINE__);
+				break;
+			}
+			TCCR4B |= _BV(WGM42);
+			committed = wide.commit();
+			TCCR4B &= ~_BV(WGM42);
+			if (!committed) {
+				FAILED(__LINE__);
+				break;
+			}
+		}
 #endif
-		if (com::diag::amigo::PWM::pwm2control(com::diag::amigo::PWM::INVALID) != 0) {
+		PWMGroup group(PINS, sizeof(PINS) / sizeof(PINS[0]));
+		if (!group) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2outputcompare8(com::diag::amigo::PWM::INVALID) != 0) {
+		if (group.size() != 2) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2outputcompare16(com::diag::amigo::PWM::INVALID) != 0) {
+		static const PWMGroup::Setting SETTINGS[] = {
+			{ PWM::PIN_0B, 10 },
+			{ PWM::PIN_2A, 20 },
+			{ PWM::PIN_2B, 30 },
+		};
+		if (!group.update(SETTINGS, sizeof(SETTINGS) / sizeof(SETTINGS[0]))) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2offset(com::diag::amigo::PWM::INVALID) != static_cast<uint8_t>(~0)) {
+		if ((OCR0B != 10) || (OCR2A != 20) || (OCR2B != 30)) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2mask(com::diag::amigo::PWM::INVALID) != 0) {
+		if (group.stage(PWM::PIN_0A, 40)) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::pwm2timer(com::diag::amigo::PWM::INVALID) != com::diag::amigo::PWM::NONE) {
+		if (!group.stage(PWM::PIN_2B, 50)) {
 			FAILED(__LINE__);
 			break;
 		}
-		if (com::diag::amigo::PWM::arduino2pwm(~0) != com::diag::amigo::PWM::INVALID) {
+		if (OCR2B != 30) {
+			FAILED(__LINE__);
+			break;
+		}
+		if (!group.commit()) {
 			FAILED(__LINE__);
 			break;
 		}
+		if ((OCR0B != 10) || (OCR2A != 20) || (OCR2B != 50)) {
+			FAILED(__LINE__);
+			break;
+		}
+		// The cost of an update without waiting for the periods, which is what
+		// an overflow interrupt service routine would pay.
+		static const uint16_t ITERATIONS = 10000;
+		com::diag::amigo::ticks_t then = elapsed();
+		for (uint16_t ii = 0; ii < ITERATIONS; ++ii) {
+			group.stage(PWM::PIN_0B, ii);
+			group.stage(PWM::PIN_2A, ii);
+			group.stage(PWM::PIN_2B, ii);
+			group.commit(false);
+		}
+		uint32_t ms = ticks2milliseconds(elapsed() - then);
+		printf(PSTR("%lucycles/update "), (ms * (F_CPU / 1000UL)) / ITERATIONS);
 		PASSED();
 	} while (false);
 #endif
@@ -2057,6 +3694,184 @@ void UnitTestTask::task() {
 	}
 #endif
 
+#if 1
+	UNITTEST("A2D Scan");
+	// A scan converts every channel in the list once per sweep and wakes the
+	// consumer once per sweep, where doing the same with convert() takes a
+	// request, a conversion and a wakeup per channel. The samples aren't
+	// checked against a test fixture, just against the ten-bit range.
+	{
+		typedef com::diag::amigo::A2D A2D;
+#if defined(__AVR_ATmega2560__)
+		static const uint8_t CHANNELS = 16;
+#else
+		static const uint8_t CHANNELS = 6;
+#endif
+		static const uint8_t SWEEPS = 32;
+		uint8_t list[CHANNELS];
+		uint16_t frames[2 * CHANNELS];
+		for (uint8_t ii = 0; ii < CHANNELS; ++ii) {
+			list[ii] = A2D::encode(static_cast<A2D::Pin>(ii));
+		}
+		A2D a2d;
+		do {
+			if (!a2d) {
+				FAILED(__LINE__);
+				break;
+			}
+			a2d.start(A2D::FREE_RUNNING);
+			com::diag::amigo::ticks_t then = elapsed();
+			a2d.scan(list, CHANNELS, frames);
+			uint8_t wakeups = 0;
+			const uint16_t * frame = 0;
+			while (wakeups < SWEEPS) {
+				frame = a2d.frame(milliseconds2ticks(1000));
+				if (frame == 0) {
+					break;
+				}
+				++wakeups;
+			}
+			a2d.scan(0, 0, 0);
+			com::diag::amigo::ticks_t scanticks = elapsed() - then;
+			if (frame == 0) {
+				FAILED(__LINE__);
+				break;
+			}
+			if ((frame != &frames[0]) && (frame != &frames[CHANNELS])) {
+				FAILED(__LINE__);
+				break;
+			}
+			uint8_t ii;
+			for (ii = 0; ii < CHANNELS; ++ii) {
+				if (frame[ii] > 1023) {
+					break;
+				}
+			}
+			if (ii < CHANNELS) {
+				FAILED(__LINE__);
+				break;
+			}
+			uint16_t sweeps = a2d.sweeps();
+			if (sweeps < wakeups) {
+				FAILED(__LINE__);
+				break;
+			}
+			// Requests are serviced again once the scan has ended.
+			then = elapsed();
+			uint16_t conversions;
+			for (conversions = 0; conversions < (CHANNELS * SWEEPS); ++conversions) {
+				if (a2d.convert(static_cast<A2D::Pin>(conversions % CHANNELS), A2D::AVCC, milliseconds2ticks(1000)) < 0) {
+					break;
+				}
+			}
+			com::diag::amigo::ticks_t convertticks = elapsed() - then;
+			if (conversions < (CHANNELS * SWEEPS)) {
+				FAILED(__LINE__);
+				break;
+			}
+			uint32_t scanms = ticks2milliseconds(scanticks);
+			uint32_t convertms = ticks2milliseconds(convertticks);
+			PASSED();
+			printf(PSTR("scan=%lusamples/s wakeups=%u sweeps=%u overruns=%u\n"), (CHANNELS * SWEEPS * 1000UL) / ((scanms > 0) ? scanms : 1), wakeups, sweeps, static_cast<uint8_t>(a2d));
+			printf(PSTR("convert=%lusamples/s wakeups=%u\n"), (CHANNELS * SWEEPS * 1000UL) / ((convertms > 0) ? convertms : 1), conversions);
+		} while (false);
+		a2d.stop();
+	}
+#endif
+
+#if 1
+	UNITTEST("A2D Rate");
+	// Timer/counter 1 triggers every conversion, so the samples are evenly
+	// spaced no matter what the tasks are doing. The spacing is checked by
+	// making sure that no sweep is missed and that the number of samples taken
+	// matches the elapsed time measured by the FreeRTOS tick.
+	{
+		typedef com::diag::amigo::A2D A2D;
+		static const uint32_t HERTZ = 1000;
+		static const uint8_t CHANNELS = 8;
+		static const uint8_t SWEEPS = 64;
+		uint8_t list[CHANNELS];
+		uint16_t frames[2 * CHANNELS];
+		for (uint8_t ii = 0; ii < CHANNELS; ++ii) {
+			list[ii] = A2D::encode(A2D::PIN_0);
+		}
+		A2D a2d;
+		do {
+			if (!a2d) {
+				FAILED(__LINE__);
+				break;
+			}
+#if defined(portUSE_TIMER1)
+			// Timer/counter 1 is the FreeRTOS tick.
+			if (a2d.rate(HERTZ) != 0) {
+				FAILED(__LINE__);
+				break;
+			}
+#else
+			if (a2d.rate(0) != 0) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (a2d.rate(1) != 1000000UL) {
+				FAILED(__LINE__);
+				break;
+			}
+			uint32_t period = a2d.rate(HERTZ);
+			if (period != (1000000UL / HERTZ)) {
+				FAILED(__LINE__);
+				break;
+			}
+			a2d.start(A2D::MATCH1B);
+			a2d.scan(list, CHANNELS, frames);
+			// The interval starts when the first frame is complete, so its
+			// sweep is the one the count starts from.
+			uint16_t first = 0;
+			const uint16_t * frame = a2d.frame(milliseconds2ticks(1000), first);
+			com::diag::amigo::ticks_t then = elapsed();
+			uint16_t sweep;
+			uint16_t last = first;
+			uint8_t missed = 0;
+			for (uint8_t ii = 0; (frame != 0) && (ii < SWEEPS); ++ii) {
+				frame = a2d.frame(milliseconds2ticks(1000), sweep);
+				if (sweep != static_cast<uint16_t>(last + 1)) {
+					++missed;
+				} else {
+					// Do nothing.
+				}
+				last = sweep;
+			}
+			com::diag::amigo::ticks_t now = elapsed();
+			a2d.scan(0, 0, 0);
+			a2d.rate(0);
+			if (frame == 0) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (missed > 0) {
+				FAILED(__LINE__);
+				break;
+			}
+			// The samples between the first and last frame, at the period, should
+			// take as long as the tick says they did, give or take a tick.
+			uint32_t expected = (static_cast<uint32_t>(last - first) * CHANNELS * period) / 1000;
+			uint32_t actual = ticks2milliseconds(now - then);
+			uint32_t slop = ticks2milliseconds(1);
+			if ((actual + slop) < expected) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (actual > (expected + slop)) {
+				FAILED(__LINE__);
+				break;
+			}
+			printf(PSTR("period=%luus sweeps=%u expected=%lums actual=%lums "), period, last - first, expected, actual);
+#endif
+			PASSED();
+		} while (false);
+		a2d.stop();
+	}
+#endif
+
 #if 1
 	UNITTEST("SPI (requires WIZnet W5100)");
 	// There seems to be an issue with reset on the W5100 ("WIZRST" on the
@@ -2103,43 +3918,238 @@ void UnitTestTask::task() {
 				FAILED(__LINE__);
 				break;
 			}
-			if (rtr1 != 0xd0) {
+			if (rtr1 != 0xd0) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (rcr != 0x08) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (static_cast<uint8_t>(spi) > 0) {
+				FAILED(__LINE__);
+				break;
+			}
+			PASSED();
+		} while (false);
+		spi.stop();
+	}
+#endif
+
+#if 1
+	UNITTEST("SPI block (requires WIZnet W5100)");
+	// Same caveats as above. This reads the same W5100 registers using the
+	// byte-at-a-time ring buffers and using block transfers, at each clock
+	// divisor, and reports how long each takes.
+	{
+		com::diag::amigo::SPI spi;
+		com::diag::amigo::GPIO gpio(com::diag::amigo::GPIO::gpio2base(com::diag::amigo::GPIO::arduino2gpio(10)));
+		uint8_t mask = com::diag::amigo::GPIO::gpio2mask(com::diag::amigo::GPIO::arduino2gpio(10));
+		static const com::diag::amigo::SPI::Divisor DIVISORS[] = {
+			com::diag::amigo::SPI::D2,
+			com::diag::amigo::SPI::D4,
+			com::diag::amigo::SPI::D8,
+			com::diag::amigo::SPI::D16,
+			com::diag::amigo::SPI::D32,
+			com::diag::amigo::SPI::D64,
+			com::diag::amigo::SPI::D128,
+		};
+		static const uint16_t ITERATIONS = 256;
+		do {
+			spi.start();
+			W5100 w5100(*mutexsemaphorep, com::diag::amigo::GPIO::arduino2gpio(10), spi);
+			uint8_t ii;
+			for (ii = 0; ii < (sizeof(DIVISORS) / sizeof(DIVISORS[0])); ++ii) {
+				spi.stop();
+				spi.start(DIVISORS[ii]);
+				uint8_t queued = 0;
+				com::diag::amigo::ticks_t then = elapsed();
+				for (uint16_t nn = 0; nn < ITERATIONS; ++nn) {
+					com::diag::amigo::ToggleOff ss(gpio, mask);
+					spi.master(0x0f);
+					spi.master(0x00);
+					spi.master(0x19); // RCR
+					queued = spi.master();
+				}
+				com::diag::amigo::ticks_t queuedms = ticks2milliseconds(elapsed() - then);
+				uint8_t frame[4] = { 0x0f, 0x00, 0x19, 0x00 };
+				then = elapsed();
+				for (uint16_t nn = 0; nn < ITERATIONS; ++nn) {
+					com::diag::amigo::ToggleOff ss(gpio, mask);
+					frame[0] = 0x0f;
+					frame[1] = 0x00;
+					frame[2] = 0x19; // RCR
+					if (spi.transfer(frame, frame, sizeof(frame)) != sizeof(frame)) {
+						break;
+					}
+				}
+				com::diag::amigo::ticks_t blockms = ticks2milliseconds(elapsed() - then);
+				printf(PSTR("divisor=%u queued=%ums block=%ums\n"), ii, queuedms, blockms);
+				if ((queued != 0x08) || (frame[3] != 0x08)) {
+					break;
+				}
+			}
+			if (ii < (sizeof(DIVISORS) / sizeof(DIVISORS[0]))) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (static_cast<uint8_t>(spi) > 0) {
+				FAILED(__LINE__);
+				break;
+			}
+			PASSED();
+		} while (false);
+		spi.stop();
+	}
+#endif
+
+#if 1
+	UNITTEST("W5100 (requires WIZnet W5100)");
+	// Same caveats as above.
+	{
+		com::diag::amigo::SPI spi;
+		com::diag::amigo::W5100::W5100 w5100(*mutexsemaphorep, com::diag::amigo::GPIO::arduino2gpio(10), spi);
+		do {
+			spi.start();
+			w5100.start();
+			uint16_t rtr = w5100.getRetransmissionTime();
+			if (rtr != 2000) {
+				FAILED(__LINE__);
+				break;
+			}
+			uint8_t rcr = w5100.getRetransmissionCount();
+			if (rcr != 8) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (static_cast<uint8_t>(spi) > 0) {
+				FAILED(__LINE__);
+				break;
+			}
+			PASSED();
+		} while (false);
+		w5100.stop();
+		spi.stop();
+	}
+#endif
+
+#if 1
+	UNITTEST("W5100 bulk (requires WIZnet W5100)");
+	// Same caveats as above. This writes directly into the buffer memory of
+	// socket 0 so that both halves of a wrap around the end of the circular
+	// buffer are exercised, then times the bulk transfers.
+	{
+		com::diag::amigo::SPI spi;
+		W5100Bulk w5100(*mutexsemaphorep, com::diag::amigo::GPIO::arduino2gpio(10), spi);
+		do {
+			static const size_t LENGTH = 128;
+			static const size_t ITERATIONS = 64;
+			uint8_t pattern[LENGTH];
+			uint8_t buffer[LENGTH];
+			for (size_t ii = 0; ii < sizeof(pattern); ++ii) { pattern[ii] = ii ^ 0xa5; }
+			spi.start();
+			w5100.start();
+			// Transmit: the last sixty-four bytes land at the end of the
+			// buffer and the rest wrap around to the beginning. Tx write
+			// pointer is zero following a reset.
+			w5100.send_data_processing_offset(0, w5100.txsize(0) - (LENGTH / 2), pattern, sizeof(pattern));
+			memset(buffer, 0, sizeof(buffer));
+			w5100.myread(w5100.mysbase(0) + w5100.txsize(0) - (LENGTH / 2), buffer, LENGTH / 2);
+			w5100.myread(w5100.mysbase(0), buffer + (LENGTH / 2), LENGTH / 2);
+			if (memcmp(buffer, pattern, sizeof(buffer)) != 0) {
 				FAILED(__LINE__);
 				break;
 			}
-			if (rcr != 0x08) {
+			// Receive: put the pattern across the end of the buffer and read
+			// it back through the wrapping method.
+			w5100.mywrite(w5100.myrbase(0) + w5100.rxsize(0) - (LENGTH / 2), pattern, LENGTH / 2);
+			w5100.mywrite(w5100.myrbase(0), pattern + (LENGTH / 2), LENGTH / 2);
+			memset(buffer, 0, sizeof(buffer));
+			w5100.read_data(0, w5100.rxsize(0) - (LENGTH / 2), buffer, sizeof(buffer));
+			if (memcmp(buffer, pattern, sizeof(buffer)) != 0) {
 				FAILED(__LINE__);
 				break;
 			}
+			com::diag::amigo::ticks_t then = com::diag::amigo::Task::elapsed();
+			for (size_t ii = 0; ii < ITERATIONS; ++ii) {
+				w5100.mywrite(w5100.mysbase(0), pattern, sizeof(pattern));
+				w5100.myread(w5100.mysbase(0), buffer, sizeof(buffer));
+			}
+			com::diag::amigo::ticks_t now = com::diag::amigo::Task::elapsed();
+			uint32_t ms = com::diag::amigo::Task::ticks2milliseconds(now - then);
+			uint32_t bytes = 2UL * ITERATIONS * LENGTH;
+			printf(PSTR("bytes=%lu ms=%lu B/s=%lu\n"), bytes, ms, (ms > 0) ? ((bytes * 1000UL) / ms) : 0UL);
 			if (static_cast<uint8_t>(spi) > 0) {
 				FAILED(__LINE__);
 				break;
 			}
 			PASSED();
 		} while (false);
+		w5100.stop();
 		spi.stop();
 	}
 #endif
 
 #if 1
-	UNITTEST("W5100 (requires WIZnet W5100)");
-	// Same caveats as above.
+	UNITTEST("W5100 memory (requires WIZnet W5100)");
+	// Same caveats as above. This checks the per-socket buffer layout for a
+	// few memory configurations, and times filling the socket 0 transmit
+	// buffer under each one.
 	{
 		com::diag::amigo::SPI spi;
-		com::diag::amigo::W5100::W5100 w5100(*mutexsemaphorep, com::diag::amigo::GPIO::arduino2gpio(10), spi);
+		W5100Bulk w5100(*mutexsemaphorep, com::diag::amigo::GPIO::arduino2gpio(10), spi);
 		do {
 			spi.start();
 			w5100.start();
-			uint16_t rtr = w5100.getRetransmissionTime();
-			if (rtr != 2000) {
+			uint8_t ii;
+			for (ii = 0; ii < W5100Bulk::SOCKETS; ++ii) {
+				if (w5100.txsize(ii) != W5100Bulk::SSIZE) { break; }
+				if (w5100.rxsize(ii) != W5100Bulk::RSIZE) { break; }
+				if (w5100.mysbase(ii) != (0x4000 + (W5100Bulk::SSIZE * ii))) { break; }
+				if (w5100.myrbase(ii) != (0x6000 + (W5100Bulk::RSIZE * ii))) { break; }
+			}
+			if (ii < W5100Bulk::SOCKETS) {
 				FAILED(__LINE__);
 				break;
 			}
-			uint8_t rcr = w5100.getRetransmissionCount();
-			if (rcr != 8) {
+			if (W5100Bulk::msr(2048, 2048, 2048, 2048) != W5100Bulk::MSR) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (W5100Bulk::msr(8192) != 0x03) {
+				FAILED(__LINE__);
+				break;
+			}
+			if (W5100Bulk::msr(4096, 2048, 1024, 1024) != 0x06) {
+				FAILED(__LINE__);
+				break;
+			}
+			w5100.configure(W5100Bulk::msr(8192), W5100Bulk::msr(4096, 2048, 1024, 1024));
+			if ((w5100.txsize(0) != 8192) || (w5100.txsize(1) != 0) || (w5100.txsize(2) != 0) || (w5100.txsize(3) != 0)) {
+				FAILED(__LINE__);
+				break;
+			}
+			if ((w5100.rxsize(0) != 4096) || (w5100.rxsize(1) != 2048) || (w5100.rxsize(2) != 1024) || (w5100.rxsize(3) != 1024)) {
 				FAILED(__LINE__);
 				break;
 			}
+			if ((w5100.myrbase(1) != 0x7000) || (w5100.myrbase(2) != 0x7800) || (w5100.myrbase(3) != 0x7c00)) {
+				FAILED(__LINE__);
+				break;
+			}
+			static const uint8_t LAYOUTS[] = { 0x00, 0x55, 0xaa, 0x03 };
+			uint8_t buffer[128];
+			memset(buffer, 0xa5, sizeof(buffer));
+			for (ii = 0; ii < sizeof(LAYOUTS); ++ii) {
+				w5100.configure(LAYOUTS[ii], LAYOUTS[ii]);
+				com::diag::amigo::ticks_t then = elapsed();
+				for (size_t nn = 0; nn < w5100.txsize(0); nn += sizeof(buffer)) {
+					w5100.send_data_processing(0, buffer, sizeof(buffer));
+				}
+				com::diag::amigo::ticks_t ms = ticks2milliseconds(elapsed() - then);
+				printf(PSTR("msr=0x%02x socket0=%u ms=%u\n"), LAYOUTS[ii], w5100.txsize(0), ms);
+			}
+			w5100.configure(W5100Bulk::MSR, W5100Bulk::MSR);
 			if (static_cast<uint8_t>(spi) > 0) {
 				FAILED(__LINE__);
 				break;
@@ -2606,6 +4616,295 @@ void UnitTestTask::task() {
 	}
 #endif
 
+#if 1
+	UNITTEST("Socket stream (requires internet connectivity)");
+	// Same caveats as above. This sends the request from a Source and
+	// receives the response into a Sink without any application buffer
+	// between them and the W5100, then relays the rest of the response to
+	// the serial port, reporting the throughput and the stack high water
+	// mark of this task.
+	{
+		com::diag::amigo::SPI spi;
+		com::diag::amigo::W5100::W5100 w5100(*mutexsemaphorep, com::diag::amigo::GPIO::PIN_B4, spi);
+		{
+			com::diag::amigo::W5100::Socket socket(w5100);
+			socket.provide(*mutexsemaphorep);
+			do {
+				spi.start();
+				w5100.start();
+				w5100.setMACAddress(com::diag::amigo::IPV4Address_P(MACADDRESS));
+				w5100.setIPAddress(com::diag::amigo::IPV4Address_P(IPADDRESS));
+				w5100.setGatewayIp(com::diag::amigo::IPV4Address_P(GATEWAY));
+				w5100.setSubnetMask(com::diag::amigo::IPV4Address_P(SUBNET));
+				if (!socket.socket()) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (!socket.bind(socket.PROTOCOL_TCP, socket.NOPORT)) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (!socket.connect(com::diag::amigo::IPV4Address_P(WEBSERVER), HTTP)) {
+					FAILED(__LINE__);
+					break;
+				}
+				while ((!socket.connected()) && (!socket.closed())) {
+					delay(milliseconds2ticks(10));
+				}
+				if (!socket.connected()) {
+					FAILED(__LINE__);
+					break;
+				}
+				static const char GET[] = "GET /expect404.html HTTP/1.0\r\nFrom: coverclock@diag.com\r\nUser-Agent: Amigo/1.0\r\n\r\n";
+				BufferSource source(GET, sizeof(GET) - 1 /* Not including terminating NUL. */);
+				ssize_t sent = socket.send(source, sizeof(GET));
+				if (sent != (sizeof(GET) - 1)) {
+					FAILED(__LINE__);
+					break;
+				}
+				for (uint8_t ii = 0; (ii < 100) && (socket.available() == 0); ++ii) {
+					delay(milliseconds2ticks(100));
+				}
+				if (socket.available() == 0) {
+					FAILED(__LINE__);
+					break;
+				}
+				static const char EXPECTED[] = "HTTP/1.1 404 Not Found";
+				char buffer[sizeof(EXPECTED)];
+				BufferSink sink(buffer, sizeof(buffer) - 1 /* Not including terminating NUL. */);
+				ssize_t received = socket.recv(sink, sizeof(buffer));
+				if (received != (sizeof(buffer) - 1)) {
+					FAILED(__LINE__);
+					break;
+				}
+				buffer[received] = '\0';
+				if (strcmp(buffer, EXPECTED) != 0) {
+					FAILED(__LINE__);
+					break;
+				}
+				serialsink.write(buffer);
+				size_t total = 0;
+				com::diag::amigo::ticks_t then = elapsed();
+				while ((received = socket.recv(serialsink, ~static_cast<size_t>(0))) != 0) {
+					if (received > 0) {
+						total += received;
+					} else if ((elapsed() - then) > milliseconds2ticks(10000)) {
+						break;
+					} else {
+						delay(milliseconds2ticks(10));
+					}
+				}
+				com::diag::amigo::ticks_t ms = ticks2milliseconds(elapsed() - then);
+				serialsink.write("\r\n");
+				printf(PSTR("relayed=%u ms=%u unused=%u\n"), total, ms, com::diag::amigo::Task::stackSelf());
+				socket.disconnect();
+				socket.close();
+				if (static_cast<uint8_t>(spi) > 0) {
+					FAILED(__LINE__);
+					break;
+				}
+				PASSED();
+			} while (false);
+			socket.disconnect();
+			socket.close();
+		}
+		w5100.stop();
+		spi.stop();
+	}
+#endif
+
+#if 1
+	UNITTEST("Socket asynchronous client (requires internet connectivity)");
+	// Same caveats as above. Here the request is sent with post() and this
+	// task keeps doing useful work, counting, while a Poller timer watches
+	// for the W5100 to complete the send.
+	{
+		com::diag::amigo::SPI spi;
+		com::diag::amigo::W5100::W5100 w5100(*mutexsemaphorep, com::diag::amigo::GPIO::PIN_B4, spi);
+		{
+			com::diag::amigo::W5100::Socket socket(w5100);
+			socket.provide(*mutexsemaphorep);
+			com::diag::amigo::W5100::Poller poller(1);
+			com::diag::amigo::BinarySemaphore sent;
+			do {
+				if (!poller) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (!sent) {
+					FAILED(__LINE__);
+					break;
+				}
+				// FreeRTOS binary semaphores are created full.
+				sent.take(com::diag::amigo::IMMEDIATELY);
+				spi.start();
+				w5100.start();
+				w5100.setMACAddress(com::diag::amigo::IPV4Address_P(MACADDRESS));
+				w5100.setIPAddress(com::diag::amigo::IPV4Address_P(IPADDRESS));
+				w5100.setGatewayIp(com::diag::amigo::IPV4Address_P(GATEWAY));
+				w5100.setSubnetMask(com::diag::amigo::IPV4Address_P(SUBNET));
+				if (!socket.socket()) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (socket.post("", 1, &sent) != 0) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (!socket.bind(socket.PROTOCOL_TCP, socket.NOPORT)) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (!socket.connect(com::diag::amigo::IPV4Address_P(WEBSERVER), HTTP)) {
+					FAILED(__LINE__);
+					break;
+				}
+				while ((!socket.connected()) && (!socket.closed())) {
+					delay(milliseconds2ticks(10));
+				}
+				if (!socket.connected()) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (!poller.start()) {
+					FAILED(__LINE__);
+					break;
+				}
+				static const char GET[] = "GET /expect404.html HTTP/1.0\r\nFrom: coverclock@diag.com\r\nUser-Agent: Amigo/1.0\r\n\r\n";
+				com::diag::amigo::ticks_t then = elapsed();
+				ssize_t posted = socket.post(GET, sizeof(GET) - 1 /* Not including terminating NUL. */, &sent);
+				if (posted != (sizeof(GET) - 1)) {
+					FAILED(__LINE__);
+					break;
+				}
+				uint32_t work = 0;
+				while (!sent.take(com::diag::amigo::IMMEDIATELY)) {
+					if ((elapsed() - then) > milliseconds2ticks(10000)) {
+						break;
+					}
+					++work;
+					yield();
+				}
+				com::diag::amigo::ticks_t ms = ticks2milliseconds(elapsed() - then);
+				printf(PSTR("sent=%d ms=%u work=%lu\n"), socket.result(), ms, work);
+				if (socket.posted()) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (socket.result() != posted) {
+					FAILED(__LINE__);
+					break;
+				}
+				for (uint8_t ii = 0; (ii < 100) && (socket.available() == 0); ++ii) {
+					delay(milliseconds2ticks(100));
+				}
+				if (socket.available() == 0) {
+					FAILED(__LINE__);
+					break;
+				}
+				socket.disconnect();
+				socket.close();
+				if (static_cast<uint8_t>(spi) > 0) {
+					FAILED(__LINE__);
+					break;
+				}
+				PASSED();
+			} while (false);
+			poller.stop();
+			socket.disconnect();
+			socket.close();
+		}
+		w5100.stop();
+		spi.stop();
+	}
+#endif
+
+#if 1
+	UNITTEST("Socket dispatcher (requires internet connectivity and W5100 /INT on pin 2)");
+	// Same caveats as above. This makes the same request twice, first polling
+	// the W5100 and then blocking on the W5100 Dispatcher, and reports the
+	// latency from connect to connected and from connect to the first byte of
+	// the response for each. The Dispatcher requires that the W5100 /INT
+	// output be jumpered to Arduino digital pin 2.
+	{
+		com::diag::amigo::SPI spi;
+		com::diag::amigo::W5100::W5100 w5100(*mutexsemaphorep, com::diag::amigo::GPIO::PIN_B4, spi);
+		com::diag::amigo::W5100::Dispatcher dispatcher(w5100);
+		{
+			com::diag::amigo::W5100::Socket socket(w5100);
+			socket.provide(*mutexsemaphorep);
+			do {
+				spi.start();
+				w5100.start();
+				w5100.setMACAddress(com::diag::amigo::IPV4Address_P(MACADDRESS));
+				w5100.setIPAddress(com::diag::amigo::IPV4Address_P(IPADDRESS));
+				w5100.setGatewayIp(com::diag::amigo::IPV4Address_P(GATEWAY));
+				w5100.setSubnetMask(com::diag::amigo::IPV4Address_P(SUBNET));
+				static const char GET[] = "GET /expect404.html HTTP/1.0\r\nFrom: coverclock@diag.com\r\nUser-Agent: Amigo/1.0\r\n\r\n";
+				uint8_t pass;
+				for (pass = 0; pass < 2; ++pass) {
+					if (pass > 0) {
+						dispatcher.start(256);
+						socket.provide(&dispatcher);
+					}
+					if (!socket.socket()) {
+						break;
+					}
+					if (!socket.bind(socket.PROTOCOL_TCP, socket.NOPORT)) {
+						break;
+					}
+					com::diag::amigo::ticks_t then = elapsed();
+					if (!socket.connect(com::diag::amigo::IPV4Address_P(WEBSERVER), HTTP)) {
+						break;
+					}
+					while ((!socket.connected()) && (!socket.closed())) {
+						socket.wait(socket.ITERATION);
+					}
+					com::diag::amigo::ticks_t connected = ticks2milliseconds(elapsed() - then);
+					if (!socket.connected()) {
+						break;
+					}
+					if (socket.send(GET, sizeof(GET) - 1 /* Not including terminating NUL. */) != (sizeof(GET) - 1)) {
+						break;
+					}
+					while ((socket.available() == 0) && ((elapsed() - then) < milliseconds2ticks(10000))) {
+						socket.wait(socket.ITERATION);
+					}
+					com::diag::amigo::ticks_t responded = ticks2milliseconds(elapsed() - then);
+					if (socket.available() == 0) {
+						break;
+					}
+					printf(PSTR("%s connected=%ums responded=%ums\n"), (pass > 0) ? "dispatched" : "polled", connected, responded);
+					socket.disconnect();
+					socket.close();
+				}
+				if (pass < 2) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (dispatcher.interrupts() == 0) {
+					FAILED(__LINE__);
+					break;
+				}
+				if (static_cast<uint8_t>(spi) > 0) {
+					FAILED(__LINE__);
+					break;
+				}
+				PASSED();
+			} while (false);
+			socket.provide(static_cast<com::diag::amigo::W5100::Dispatcher *>(0));
+			socket.disconnect();
+			socket.close();
+		}
+		dispatcher.stop();
+		while (dispatcher) {
+			delay(dispatcher.PATIENCE);
+		}
+		w5100.stop();
+		spi.stop();
+	}
+#endif
+
 #if 1
 	UNITTESTLN("Socket server (requires remote '" SOCKET_SERVER_COMMAND "')");
 	{
@@ -2746,6 +5045,51 @@ void UnitTestTask::task() {
 
 	printf(PSTR("Unit Test errors=%d (so far)\n"), errors);
 
+#if 1
+	UNITTESTLN("Serial threshold (paste some text then type <control d> to exit)");
+	do {
+		static const com::diag::amigo::ticks_t T4 = 100;
+		static const size_t THRESHOLD = 8;
+		uint8_t buffer[16];
+		serialp->clear();
+		serialp->threshold(THRESHOLD);
+		com::diag::amigo::ticks_t then = elapsed();
+		size_t size = serialp->read(buffer, 0, milliseconds2ticks(T4));
+		if (size != 0) {
+			FAILED(__LINE__);
+			break;
+		}
+		size = serialp->read(buffer, sizeof(buffer), milliseconds2ticks(T4));
+		com::diag::amigo::ticks_t waited = elapsed() - then;
+		if ((size == 0) && (waited < milliseconds2ticks(T4))) {
+			FAILED(__LINE__);
+			break;
+		}
+		// Each read should return a batch of characters instead of one, even
+		// when pasting a continuous stream; when typing by hand the idle line
+		// timeout returns each character promptly.
+		unsigned int reads = 0;
+		unsigned long total = 0;
+		bool done = false;
+		while (!done) {
+			size = serialp->read(buffer, sizeof(buffer));
+			++reads;
+			for (size_t ii = 0; ii < size; ++ii) {
+				if (buffer[ii] == '\004') {
+					size = ii;
+					done = true;
+					break;
+				}
+			}
+			serialsink.write(buffer, size);
+			total += size;
+		}
+		printf(PSTR("\nreads=%u characters=%lu "), reads, total);
+		PASSED();
+	} while (false);
+	serialp->threshold(0);
+#endif
+
 #if 1
 	UNITTESTLN("Source (type <control d> to exit)");
 	{
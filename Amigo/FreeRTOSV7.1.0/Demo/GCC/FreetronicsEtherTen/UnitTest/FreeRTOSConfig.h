@@ -152,6 +152,18 @@
 #define configUSE_ALTERNATIVE_API       0
 #define configCHECK_FOR_STACK_OVERFLOW  1
 #define configQUEUE_REGISTRY_SIZE	    0
+/* v coverclock@diag.com 2012-07-14 */
+// Per-task CPU usage, reported by Task::cpu(), is measured with a free running
+// hardware timer; see com/diag/amigo/target/runtime.h. It costs Timer2, about
+// sixty bytes of SRAM, and four more bytes for every task, which the 328p can't
+// spare.
+#define configGENERATE_RUN_TIME_STATS	0
+#if (configGENERATE_RUN_TIME_STATS == 1)
+#	include "com/diag/amigo/target/runtime.h"
+#	define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() amigo_runtime_start()
+#	define portGET_RUN_TIME_COUNTER_VALUE() amigo_runtime_counter()
+#endif
+/* ^ coverclock@diag.com 2012-07-14 */
 
 /* Timer definitions. */
 #define configUSE_TIMERS				1
@@ -0,0 +1,140 @@
+/*
+    FreeRTOS V7.1.0 - Copyright (C) 2011 Real Time Engineers Ltd.
+
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+ * Application specific definitions.
+ *
+ * These definitions should be adjusted for your particular hardware and
+ * application requirements.
+ *
+ * THESE PARAMETERS ARE DESCRIBED WITHIN THE 'CONFIGURATION' SECTION OF THE
+ * FreeRTOS API DOCUMENTATION AVAILABLE ON THE FreeRTOS.org WEB SITE.
+ *
+ * See http://www.freertos.org/a00110.html.
+ *----------------------------------------------------------*/
+
+/* v coverclock@diag.com 2012-06-30 */
+// The POSIX simulator port runs each task as a POSIX thread on the build host
+// and drives the tick from an interval timer signal. 16-bit ticks are kept so
+// that tick arithmetic behaves the same as on the megaAVR, and a 1000Hz tick
+// makes a tick a millisecond. The heap and stacks have to be much larger since
+// the host uses them for its own (larger) stack frames and C library calls.
+#define configCPU_CLOCK_HZ		( ( unsigned long ) F_CPU )
+#define configTICK_RATE_HZ		( ( portTickType ) 1000 )
+#define configTOTAL_HEAP_SIZE	( ( size_t ) ( 1024 * 1024 ) )	// used for heap_1.c and heap2.c only
+/* ^ coverclock@diag.com 2012-06-30 */
+
+// And on to the things the same as on the AVR...
+#define configUSE_PREEMPTION		    1
+#define configUSE_IDLE_HOOK		        0
+#define configUSE_TICK_HOOK		        0
+#define configMAX_PRIORITIES		    ( ( unsigned portBASE_TYPE ) 4 )
+/* v coverclock@diag.com 2012-06-30 */
+#define configMINIMAL_STACK_SIZE	    ( ( unsigned short ) 4096 )
+/* ^ coverclock@diag.com 2012-06-30 */
+#define configMAX_TASK_NAME_LEN		    ( 16 )
+#define configUSE_TRACE_FACILITY	    0
+#define configUSE_16_BIT_TICKS		    1
+#define configIDLE_SHOULD_YIELD		    1
+#define configUSE_MUTEXES               1
+#define configUSE_RECURSIVE_MUTEXES     1
+#define configUSE_COUNTING_SEMAPHORES   1
+#define configUSE_ALTERNATIVE_API       0
+#define configCHECK_FOR_STACK_OVERFLOW  1
+#define configQUEUE_REGISTRY_SIZE	    0
+/* v coverclock@diag.com 2012-07-14 */
+// Per-task CPU usage, reported by Task::cpu(), is measured with a free running
+// hardware timer; see com/diag/amigo/target/runtime.h.
+#define configGENERATE_RUN_TIME_STATS	1
+#include "com/diag/amigo/target/runtime.h"
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() amigo_runtime_start()
+#define portGET_RUN_TIME_COUNTER_VALUE() amigo_runtime_counter()
+/* ^ coverclock@diag.com 2012-07-14 */
+
+/* Timer definitions. */
+#define configUSE_TIMERS				1
+#define configTIMER_TASK_PRIORITY       ( ( unsigned portBASE_TYPE ) 7 )
+#define configTIMER_QUEUE_LENGTH        ( ( unsigned portBASE_TYPE ) 10 )
+/* v coverclock@diag.com 2012-06-30 */
+#define configTIMER_TASK_STACK_DEPTH    ( ( unsigned short ) 8192 )
+/* ^ coverclock@diag.com 2012-06-30 */
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES 		    0
+#define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+
+#define INCLUDE_vTaskPrioritySet		        1
+#define INCLUDE_uxTaskPriorityGet		        1
+#define INCLUDE_vTaskDelete			            1
+#define INCLUDE_vTaskCleanUpResources		    0
+#define INCLUDE_vTaskSuspend			        1
+#define INCLUDE_vResumeFromISR                  1
+#define INCLUDE_vTaskDelayUntil			        1
+#define INCLUDE_vTaskDelay			            1
+#define INCLUDE_xTaskGetSchedulerState          0
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
+#define INCLUDE_xTaskGetIdleTaskHandle          1
+#define INCLUDE_pcTaskGetTaskName				1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle	1
+
+
+
+#endif /* FREERTOS_CONFIG_H */
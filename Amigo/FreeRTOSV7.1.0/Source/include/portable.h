@@ -357,6 +357,26 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * A snapshot of the state of the heap, for the memory managers that keep one.
+ * The minimum number of free bytes ever seen is the high water mark of heap
+ * usage. Comparing the largest free block with the number of free bytes
+ * shows how fragmented the heap is. Sizes include the header the memory
+ * manager keeps at the start of every block.
+ */
+typedef struct xHEAP_STATISTICS
+{
+	size_t xFreeBytes;			/*<< The number of free bytes. */
+	size_t xMinimumFreeBytes;	/*<< The fewest free bytes there have ever been. */
+	size_t xLargestFreeBlock;	/*<< The size of the largest free block in bytes. */
+	size_t xFreeBlocks;			/*<< The number of free blocks. */
+	size_t xAllocations;		/*<< The number of successful allocations. */
+	size_t xFrees;				/*<< The number of frees. */
+	size_t xFailures;			/*<< The number of failed allocations. */
+} xHeapStatistics;
+
+void vPortGetHeapStatistics( xHeapStatistics *pxStatistics ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
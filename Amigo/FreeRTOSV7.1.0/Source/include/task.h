@@ -1071,6 +1071,53 @@ void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
  */
 void vTaskGetRunTimeStats( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * The accumulated execution time of one task, as returned by
+ * uxTaskGetRunTimeCounters().
+ */
+typedef struct xTASK_RUN_TIME
+{
+	xTaskHandle xHandle;				/*<< The handle of the task. */
+	const signed char *pcTaskName;		/*<< The name of the task. */
+	unsigned long ulRunTimeCounter;		/*<< The execution time of the task so far. */
+} xTaskRunTime;
+
+/**
+ * task. h
+ * <PRE>unsigned long ulTaskGetRunTimeCounter( xTaskHandle xTask );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function
+ * to be available.
+ *
+ * @param xTask Handle of the task, or NULL for the calling task.
+ *
+ * @return The total execution time of the task, in the units of the counter
+ * configured by portCONFIGURE_TIMER_FOR_RUN_TIME_STATS(), up to when it was
+ * last switched out.
+ */
+unsigned long ulTaskGetRunTimeCounter( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>unsigned portBASE_TYPE uxTaskGetRunTimeCounters( xTaskRunTime *pxTaskRunTimeArray, unsigned portBASE_TYPE uxArraySize );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function
+ * to be available.
+ *
+ * Like vTaskGetRunTimeStats(), but fills in an array instead of formatting
+ * text, so that it needs neither sprintf() nor a large buffer. The scheduler
+ * is suspended, not interrupts disabled, while the task lists are walked.
+ *
+ * @param pxTaskRunTimeArray An array into which the execution time of each
+ * task is written.
+ *
+ * @param uxArraySize The number of entries in the array. Tasks beyond this
+ * number are left out.
+ *
+ * @return The number of entries written.
+ */
+unsigned portBASE_TYPE uxTaskGetRunTimeCounters( xTaskRunTime *pxTaskRunTimeArray, unsigned portBASE_TYPE uxArraySize ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <PRE>void vTaskStartTrace( char * pcBuffer, unsigned portBASE_TYPE uxBufferSize );</PRE>
@@ -102,6 +102,12 @@ static xBlockLink xStart, xEnd;
 fragmentation. */
 static size_t xFreeBytesRemaining = configTOTAL_HEAP_SIZE;
 
+/* Amigo: counters reported by vPortGetHeapStatistics(). */
+static size_t xMinimumEverFreeBytesRemaining = configTOTAL_HEAP_SIZE;
+static size_t xNumberOfAllocations = 0;
+static size_t xNumberOfFrees = 0;
+static size_t xNumberOfFailures = 0;
+
 /* STATIC FUNCTIONS ARE DEFINED AS MACROS TO MINIMIZE THE FUNCTION CALL DEPTH. */
 
 /*
@@ -222,8 +228,18 @@ void *pvReturn = NULL;
 				}
 				
 				xFreeBytesRemaining -= pxBlock->xBlockSize;
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				++xNumberOfAllocations;
 			}
 		}
+
+		if( pvReturn == NULL )
+		{
+			++xNumberOfFailures;
+		}
 	}
 	xTaskResumeAll();
 
@@ -260,6 +276,7 @@ xBlockLink *pxLink;
 			/* Add this block to the list of free blocks. */
 			prvInsertBlockIntoFreeList( ( ( xBlockLink * ) pxLink ) );
 			xFreeBytesRemaining += pxLink->xBlockSize;
+			++xNumberOfFrees;
 		}
 		xTaskResumeAll();
 	}
@@ -272,6 +289,42 @@ size_t xPortGetFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+void vPortGetHeapStatistics( xHeapStatistics *pxStatistics )
+{
+xBlockLink *pxBlock;
+
+	pxStatistics->xLargestFreeBlock = 0;
+	pxStatistics->xFreeBlocks = 0;
+
+	vTaskSuspendAll();
+	{
+		/* The list is sorted by size so the largest block is the last one
+		before the end marker. Before the first allocation the list hasn't
+		been initialised, but then the whole heap is one free block. */
+		if( xStart.pxNextFreeBlock == NULL )
+		{
+			pxStatistics->xLargestFreeBlock = configTOTAL_HEAP_SIZE;
+			pxStatistics->xFreeBlocks = 1;
+		}
+		else
+		{
+			for( pxBlock = xStart.pxNextFreeBlock; pxBlock != &xEnd; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				pxStatistics->xLargestFreeBlock = pxBlock->xBlockSize;
+				++pxStatistics->xFreeBlocks;
+			}
+		}
+
+		pxStatistics->xFreeBytes = xFreeBytesRemaining;
+		pxStatistics->xMinimumFreeBytes = xMinimumEverFreeBytesRemaining;
+		pxStatistics->xAllocations = xNumberOfAllocations;
+		pxStatistics->xFrees = xNumberOfFrees;
+		pxStatistics->xFailures = xNumberOfFailures;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
 	/* This just exists to keep the linker quiet. */
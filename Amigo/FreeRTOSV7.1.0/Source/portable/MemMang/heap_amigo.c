@@ -0,0 +1,335 @@
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+/*
+ * An implementation of pvPortMalloc() and vPortFree() that is a drop-in
+ * replacement for heap_2.c, selected by HEAP=heap_amigo in the Makefile. It
+ * differs from heap_2 in two ways. The free list is kept in address order
+ * instead of size order, so that a block being freed is merged with the free
+ * blocks immediately before and after it; the heap can therefore always satisfy
+ * a request as large as the largest run of adjacent free memory. And instead of
+ * taking the first block that is big enough, the allocator remembers the
+ * smallest of the first heapBEST_FIT_CANDIDATES blocks that are big enough,
+ * stopping early at an exact fit, which wastes less of large blocks without
+ * requiring a search of the entire list. Either way the list is walked under
+ * vTaskSuspendAll(), as it is in heap_2, so neither may be called from an
+ * interrupt service routine. It also keeps the statistics reported by
+ * vPortGetHeapStatistics().
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* The number of adequate free blocks examined before settling on the smallest
+of them. One makes this a first-fit allocator. */
+#if defined( configHEAP_BEST_FIT_CANDIDATES )
+	#define heapBEST_FIT_CANDIDATES	configHEAP_BEST_FIT_CANDIDATES
+#else
+	#define heapBEST_FIT_CANDIDATES	4
+#endif
+
+/* Allocate the memory for the heap.  The struct is used to force byte
+alignment without using any non-portable code. */
+static union xRTOS_HEAP
+{
+	#if portBYTE_ALIGNMENT == 8
+		volatile portDOUBLE dDummy;
+	#else
+		volatile unsigned long ulDummy;
+	#endif
+	unsigned char ucHeap[ configTOTAL_HEAP_SIZE ];
+} xHeap;
+
+/* Define the linked list structure.  This is used to link free blocks in order
+of their address.  An allocated block keeps only its size. */
+typedef struct A_BLOCK_LINK
+{
+	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next free block in the list. */
+	size_t xBlockSize;						/*<< The size of the block including this header. */
+} xBlockLink;
+
+static const unsigned short heapSTRUCT_SIZE = ( ( sizeof( xBlockLink ) + portBYTE_ALIGNMENT_MASK ) & ~portBYTE_ALIGNMENT_MASK );
+#define heapMINIMUM_BLOCK_SIZE	( ( size_t ) ( heapSTRUCT_SIZE * 2 ) )
+#define heapTOTAL_HEAP_SIZE		( ( size_t ) ( configTOTAL_HEAP_SIZE & ~portBYTE_ALIGNMENT_MASK ) )
+
+/* Create a couple of list links to mark the start and end of the list. The end
+marker is never merged with anything, and since it isn't in the heap its
+address is never compared with those of the blocks. */
+static xBlockLink xStart, xEnd;
+
+/* Keeps track of the number of free bytes remaining, and the statistics
+reported by vPortGetHeapStatistics(). */
+static size_t xFreeBytesRemaining = heapTOTAL_HEAP_SIZE;
+static size_t xMinimumEverFreeBytesRemaining = heapTOTAL_HEAP_SIZE;
+static size_t xNumberOfAllocations = 0;
+static size_t xNumberOfFrees = 0;
+static size_t xNumberOfFailures = 0;
+
+/*
+ * Insert a block into the list of free blocks, which is ordered by address,
+ * merging it with the blocks on either side of it if they are adjacent.
+ */
+static void prvInsertBlockIntoFreeList( xBlockLink *pxBlockToInsert )
+{
+xBlockLink *pxIterator;
+xBlockLink *pxNext;
+
+	/* Iterate through the list until the next block is at a higher address
+	than the block we are inserting. */
+	for( pxIterator = &xStart; ( pxIterator->pxNextFreeBlock != &xEnd ) && ( pxIterator->pxNextFreeBlock < pxBlockToInsert ); pxIterator = pxIterator->pxNextFreeBlock )
+	{
+		/* There is nothing to do here - just iterate to the correct position. */
+	}
+
+	pxNext = pxIterator->pxNextFreeBlock;
+
+	/* If the preceding free block ends where this one begins, the preceding
+	block simply grows to include this one. */
+	if( ( pxIterator != &xStart ) && ( ( ( unsigned char * ) pxIterator ) + pxIterator->xBlockSize == ( unsigned char * ) pxBlockToInsert ) )
+	{
+		pxIterator->xBlockSize += pxBlockToInsert->xBlockSize;
+		pxBlockToInsert = pxIterator;
+	}
+
+	/* If the following free block begins where this one ends, this block
+	absorbs it. */
+	if( ( pxNext != &xEnd ) && ( ( ( unsigned char * ) pxBlockToInsert ) + pxBlockToInsert->xBlockSize == ( unsigned char * ) pxNext ) )
+	{
+		pxBlockToInsert->xBlockSize += pxNext->xBlockSize;
+		pxBlockToInsert->pxNextFreeBlock = pxNext->pxNextFreeBlock;
+	}
+	else
+	{
+		pxBlockToInsert->pxNextFreeBlock = pxNext;
+	}
+
+	if( pxIterator != pxBlockToInsert )
+	{
+		pxIterator->pxNextFreeBlock = pxBlockToInsert;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+xBlockLink *pxFirstFreeBlock;
+
+	/* To start with there is a single free block that is sized to take up the
+	entire heap space. */
+	pxFirstFreeBlock = ( void * ) xHeap.ucHeap;
+	pxFirstFreeBlock->xBlockSize = heapTOTAL_HEAP_SIZE;
+	pxFirstFreeBlock->pxNextFreeBlock = &xEnd;
+
+	/* xStart is used to hold a pointer to the first item in the list of free
+	blocks. */
+	xStart.pxNextFreeBlock = pxFirstFreeBlock;
+	xStart.xBlockSize = ( size_t ) 0;
+
+	/* xEnd is used to mark the end of the list of free blocks. */
+	xEnd.pxNextFreeBlock = NULL;
+	xEnd.xBlockSize = ( size_t ) 0;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+xBlockLink *pxBlock, *pxPreviousBlock, *pxBestBlock, *pxBestPreviousBlock, *pxNewBlockLink;
+unsigned portBASE_TYPE uxCandidates;
+static portBASE_TYPE xHeapHasBeenInitialised = pdFALSE;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the list of free blocks. */
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+			xHeapHasBeenInitialised = pdTRUE;
+		}
+
+		/* The wanted size is increased so it can contain a xBlockLink
+		structure in addition to the requested amount of bytes. */
+		if( xWantedSize > 0 )
+		{
+			xWantedSize += heapSTRUCT_SIZE;
+
+			/* Ensure that blocks are always aligned to the required number of bytes. */
+			if( xWantedSize & portBYTE_ALIGNMENT_MASK )
+			{
+				/* Byte alignment required. */
+				xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+			}
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+		{
+			/* Walk the list in address order remembering the smallest block of
+			adequate size until enough candidates have been seen or one fits
+			exactly. */
+			pxBestBlock = NULL;
+			pxBestPreviousBlock = NULL;
+			uxCandidates = 0;
+			pxPreviousBlock = &xStart;
+			pxBlock = xStart.pxNextFreeBlock;
+			while( pxBlock != &xEnd )
+			{
+				if( pxBlock->xBlockSize >= xWantedSize )
+				{
+					if( ( pxBestBlock == NULL ) || ( pxBlock->xBlockSize < pxBestBlock->xBlockSize ) )
+					{
+						pxBestBlock = pxBlock;
+						pxBestPreviousBlock = pxPreviousBlock;
+					}
+
+					if( ( pxBlock->xBlockSize == xWantedSize ) || ( ++uxCandidates >= heapBEST_FIT_CANDIDATES ) )
+					{
+						break;
+					}
+				}
+
+				pxPreviousBlock = pxBlock;
+				pxBlock = pxBlock->pxNextFreeBlock;
+			}
+
+			if( pxBestBlock != NULL )
+			{
+				/* Return the memory space - jumping over the xBlockLink structure
+				at its start. */
+				pvReturn = ( void * ) ( ( ( unsigned char * ) pxBestBlock ) + heapSTRUCT_SIZE );
+
+				/* If the block is larger than required it can be split into two,
+				the remainder taking the place of the block in the list, which
+				keeps the list in address order. Otherwise the block is just
+				taken out of the list. */
+				if( ( pxBestBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+				{
+					pxNewBlockLink = ( void * ) ( ( ( unsigned char * ) pxBestBlock ) + xWantedSize );
+					pxNewBlockLink->xBlockSize = pxBestBlock->xBlockSize - xWantedSize;
+					pxNewBlockLink->pxNextFreeBlock = pxBestBlock->pxNextFreeBlock;
+					pxBestPreviousBlock->pxNextFreeBlock = pxNewBlockLink;
+					pxBestBlock->xBlockSize = xWantedSize;
+				}
+				else
+				{
+					pxBestPreviousBlock->pxNextFreeBlock = pxBestBlock->pxNextFreeBlock;
+				}
+
+				xFreeBytesRemaining -= pxBestBlock->xBlockSize;
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				++xNumberOfAllocations;
+			}
+		}
+
+		if( pvReturn == NULL )
+		{
+			++xNumberOfFailures;
+		}
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+unsigned char *puc = ( unsigned char * ) pv;
+xBlockLink *pxLink;
+
+	if( pv )
+	{
+		/* The memory being freed will have an xBlockLink structure immediately
+		before it. */
+		puc -= heapSTRUCT_SIZE;
+
+		/* This casting is to keep the compiler from issuing warnings. */
+		pxLink = ( void * ) puc;
+
+		vTaskSuspendAll();
+		{
+			/* Add this block to the list of free blocks. The size has to be
+			accumulated first since the block may be merged away. */
+			xFreeBytesRemaining += pxLink->xBlockSize;
+			prvInsertBlockIntoFreeList( pxLink );
+			++xNumberOfFrees;
+		}
+		xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStatistics( xHeapStatistics *pxStatistics )
+{
+xBlockLink *pxBlock;
+
+	pxStatistics->xLargestFreeBlock = 0;
+	pxStatistics->xFreeBlocks = 0;
+
+	vTaskSuspendAll();
+	{
+		/* Before the first allocation the list hasn't been initialised, but
+		then the whole heap is one free block. */
+		if( xStart.pxNextFreeBlock == NULL )
+		{
+			pxStatistics->xLargestFreeBlock = heapTOTAL_HEAP_SIZE;
+			pxStatistics->xFreeBlocks = 1;
+		}
+		else
+		{
+			for( pxBlock = xStart.pxNextFreeBlock; pxBlock != &xEnd; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( pxBlock->xBlockSize > pxStatistics->xLargestFreeBlock )
+				{
+					pxStatistics->xLargestFreeBlock = pxBlock->xBlockSize;
+				}
+				++pxStatistics->xFreeBlocks;
+			}
+		}
+
+		pxStatistics->xFreeBytes = xFreeBytesRemaining;
+		pxStatistics->xMinimumFreeBytes = xMinimumEverFreeBytesRemaining;
+		pxStatistics->xAllocations = xNumberOfAllocations;
+		pxStatistics->xFrees = xNumberOfFrees;
+		pxStatistics->xFailures = xNumberOfFailures;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
@@ -176,6 +176,7 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
 	PRIVILEGED_DATA static char pcStatsString[ 50 ] ;
 	PRIVILEGED_DATA static unsigned long ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
 	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime ) PRIVILEGED_FUNCTION;
+	static unsigned portBASE_TYPE prvListRunTimeCountersInList( xTaskRunTime *pxTaskRunTimeArray, unsigned portBASE_TYPE uxArraySize, xList *pxList ) PRIVILEGED_FUNCTION;
 
 #endif
 
@@ -1399,6 +1400,88 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 #endif
 /*----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	unsigned long ulTaskGetRunTimeCounter( xTaskHandle xTask )
+	{
+	tskTCB *pxTCB;
+	unsigned long ulRunTimeCounter;
+
+		/* The counter is updated by the context switch, and may be wider than
+		the processor can read atomically. */
+		portENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			ulRunTimeCounter = pxTCB->ulRunTimeCounter;
+		}
+		portEXIT_CRITICAL();
+
+		return ulRunTimeCounter;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	unsigned portBASE_TYPE uxTaskGetRunTimeCounters( xTaskRunTime *pxTaskRunTimeArray, unsigned portBASE_TYPE uxArraySize )
+	{
+	unsigned portBASE_TYPE uxQueue;
+	unsigned portBASE_TYPE uxCount = ( unsigned portBASE_TYPE ) 0U;
+
+		vTaskSuspendAll();
+		{
+			/* Run through all the lists that could potentially contain a TCB,
+			just as vTaskGetRunTimeStats() does. */
+
+			uxQueue = uxTopUsedPriority + ( unsigned portBASE_TYPE ) 1U;
+
+			do
+			{
+				uxQueue--;
+
+				if( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxQueue ] ) ) == pdFALSE )
+				{
+					uxCount += prvListRunTimeCountersInList( &( pxTaskRunTimeArray[ uxCount ] ), uxArraySize - uxCount, ( xList * ) &( pxReadyTasksLists[ uxQueue ] ) );
+				}
+			}while( uxQueue > ( unsigned short ) tskIDLE_PRIORITY );
+
+			if( listLIST_IS_EMPTY( pxDelayedTaskList ) == pdFALSE )
+			{
+				uxCount += prvListRunTimeCountersInList( &( pxTaskRunTimeArray[ uxCount ] ), uxArraySize - uxCount, ( xList * ) pxDelayedTaskList );
+			}
+
+			if( listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) == pdFALSE )
+			{
+				uxCount += prvListRunTimeCountersInList( &( pxTaskRunTimeArray[ uxCount ] ), uxArraySize - uxCount, ( xList * ) pxOverflowDelayedTaskList );
+			}
+
+			#if ( INCLUDE_vTaskDelete == 1 )
+			{
+				if( listLIST_IS_EMPTY( &xTasksWaitingTermination ) == pdFALSE )
+				{
+					uxCount += prvListRunTimeCountersInList( &( pxTaskRunTimeArray[ uxCount ] ), uxArraySize - uxCount, &xTasksWaitingTermination );
+				}
+			}
+			#endif
+
+			#if ( INCLUDE_vTaskSuspend == 1 )
+			{
+				if( listLIST_IS_EMPTY( &xSuspendedTaskList ) == pdFALSE )
+				{
+					uxCount += prvListRunTimeCountersInList( &( pxTaskRunTimeArray[ uxCount ] ), uxArraySize - uxCount, &xSuspendedTaskList );
+				}
+			}
+			#endif
+		}
+		xTaskResumeAll();
+
+		return uxCount;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
 #if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
 
 	xTaskHandle xTaskGetIdleTaskHandle( void )
@@ -2247,6 +2330,41 @@ tskTCB *pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	static unsigned portBASE_TYPE prvListRunTimeCountersInList( xTaskRunTime *pxTaskRunTimeArray, unsigned portBASE_TYPE uxArraySize, xList *pxList )
+	{
+	volatile tskTCB *pxNextTCB, *pxFirstTCB;
+	unsigned portBASE_TYPE uxCount = ( unsigned portBASE_TYPE ) 0U;
+
+		/* Copy the run time counters of the TCB's in pxList into the array
+		until it is full. */
+		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
+		do
+		{
+			/* Get next TCB in from the list. */
+			listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+
+			if( uxCount < uxArraySize )
+			{
+				pxTaskRunTimeArray[ uxCount ].xHandle = ( xTaskHandle ) pxNextTCB;
+				pxTaskRunTimeArray[ uxCount ].pcTaskName = ( const signed char * ) pxNextTCB->pcTaskName;
+				portENTER_CRITICAL();
+				{
+					pxTaskRunTimeArray[ uxCount ].ulRunTimeCounter = pxNextTCB->ulRunTimeCounter;
+				}
+				portEXIT_CRITICAL();
+				uxCount++;
+			}
+
+		} while( pxNextTCB != pxFirstTCB );
+
+		return uxCount;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) )
 
 	static unsigned short usTaskCheckFreeStackSpace( const unsigned char * pucStackByte )
@@ -0,0 +1,196 @@
+#ifndef _COM_DIAG_AMIGO_BUFFEREDSINK_H_
+#define _COM_DIAG_AMIGO_BUFFEREDSINK_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/constants.h"
+#include "com/diag/amigo/Sink.h"
+#include "com/diag/amigo/target/harvard.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * BufferedSinkBase implements the buffering used by BufferedSink. It is not
+ * intended to be used directly.
+ */
+class BufferedSinkBase
+: public Sink
+{
+
+public:
+
+	/**
+	 * Destructor. The deriving class forwards any pending bytes.
+	 */
+	virtual ~BufferedSinkBase();
+
+	/**
+	 * Buffer a single byte, forwarding the buffer to the wrapped Sink if the
+	 * flush policy says so.
+	 * @param ch is the byte to write.
+	 * @return the number of byte written (nominally one) or zero for fail,
+	 * which happens only if the buffer is full and the wrapped Sink accepts
+	 * none of it.
+	 */
+	virtual size_t write(uint8_t ch);
+
+	/**
+	 * Buffer a sequence of contiguous bytes from data space, forwarding the
+	 * buffer to the wrapped Sink if the flush policy says so. A sequence at
+	 * least as large as the buffer is written straight through to the
+	 * wrapped Sink after whatever is already buffered.
+	 * @param datum points to a contiguous sequence of bytes to write.
+	 * @param size is the number of bytes to write.
+	 * @return the number of bytes written or zero for fail.
+	 */
+	virtual size_t write(const void * datum, size_t size);
+
+	/**
+	 * Buffer a sequence of contiguous bytes from program space, forwarding
+	 * the buffer to the wrapped Sink if the flush policy says so. A sequence
+	 * at least as large as the buffer is written straight through to the
+	 * wrapped Sink after whatever is already buffered.
+	 * @param datum points to a contiguous sequence of bytes to write.
+	 * @param size is the number of bytes to write.
+	 * @return the number of bytes written or zero for fail.
+	 */
+	virtual size_t write_P(PGM_VOID_P datum, size_t size);
+
+	/**
+	 * Forward the buffer to the wrapped Sink and then flush the wrapped Sink.
+	 */
+	virtual void flush();
+
+	/**
+	 * Forward the buffer to the wrapped Sink if the oldest byte in it has
+	 * waited at least the latency. Since nothing else looks at the clock
+	 * between writes, an application that uses a latency and may stop
+	 * writing for a while calls this periodically from the task that writes.
+	 * @return the number of bytes forwarded.
+	 */
+	size_t poll();
+
+	/**
+	 * Return the number of bytes the buffer can hold.
+	 * @return the number of bytes the buffer can hold.
+	 */
+	size_t capacity() const { return limit; }
+
+	/**
+	 * Return the number of bytes waiting in the buffer.
+	 * @return the number of bytes waiting in the buffer.
+	 */
+	size_t pending() const { return length; }
+
+	using Sink::write;
+
+	using Sink::write_P;
+
+protected:
+
+	/**
+	 * Constructor.
+	 * @param outputsink refers to the wrapped Sink.
+	 * @param storage points to the buffer.
+	 * @param size is the size of the buffer in bytes.
+	 * @param lines if true forwards the buffer whenever a newline is written.
+	 * @param interval is the number of ticks after which a byte is forwarded
+	 * at the next write or poll, or NEVER.
+	 */
+	explicit BufferedSinkBase(Sink & outputsink, uint8_t * storage, size_t size, bool lines, ticks_t interval);
+
+	/**
+	 * Write the buffer to the wrapped Sink using its bulk write method.
+	 * Whatever the wrapped Sink doesn't accept stays in the buffer.
+	 * @return the number of bytes forwarded.
+	 */
+	size_t forward();
+
+	size_t append(const void * datum, size_t size, bool progmem);
+
+	bool stale() const;
+
+	Sink * sink;
+	uint8_t * buffer;
+	size_t limit;
+	size_t length;
+	ticks_t latency;
+	ticks_t then;
+	bool newline;
+
+private:
+
+    /**
+     *  Copy constructor. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	BufferedSinkBase(const BufferedSinkBase & that);
+
+    /**
+     *  Assignment operator. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	BufferedSinkBase & operator=(const BufferedSinkBase & that);
+
+};
+
+/**
+ * BufferedSink is a Sink that wraps another Sink, collecting the bytes
+ * written to it in a buffer of _SIZE_ bytes and forwarding them to the
+ * wrapped Sink in blocks using its bulk write method. A Sink like SerialSink,
+ * whose bulk write costs one call and one critical section instead of one of
+ * each per byte, then does its work once per block. The buffer is forwarded
+ * when it is full, when a newline is written if so configured, when a write
+ * or poll finds that the oldest byte in it has waited the latency if one is
+ * configured, when flush is called, and when the BufferedSink is destroyed.
+ * Like the Sinks it wraps, a BufferedSink is not safe to share among tasks
+ * without a MutexSemaphore. Since Amigo is built with the GCC option
+ * -fno-implicit-templates, BufferedSink.cpp instantiates the sizes 16, 32
+ * and 64; an application that uses another size instantiates it the same
+ * way.
+ */
+template <size_t _SIZE_>
+class BufferedSink
+: public BufferedSinkBase
+{
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param outputsink refers to the wrapped Sink.
+	 * @param lines if true forwards the buffer whenever a newline is written.
+	 * @param interval is the number of ticks after which a byte is forwarded
+	 * at the next write or poll, or NEVER.
+	 */
+	explicit BufferedSink(Sink & outputsink, bool lines = true, ticks_t interval = NEVER)
+	: BufferedSinkBase(outputsink, storage, _SIZE_, lines, interval)
+	{}
+
+	/**
+	 * Destructor. Any pending bytes are forwarded to the wrapped Sink.
+	 */
+	virtual ~BufferedSink() { forward(); }
+
+protected:
+
+	uint8_t storage[_SIZE_];
+
+};
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_BUFFEREDSINK_H_ */
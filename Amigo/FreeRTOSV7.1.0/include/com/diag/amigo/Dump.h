@@ -21,13 +21,26 @@ namespace amigo {
  * hexadecimal digits to the specified Sink. Note that dumping primitive
  * multi-byte data types like short, int, or long may yield reversed results
  * if the host (as in the case of the megaAVR) stores data in little-endian
- * byte order.
+ * byte order. Dump can also format a block a line at a time, with an offset,
+ * the bytes in groups, and the printable characters alongside, writing each
+ * line to the Sink with a single bulk write.
  */
 class Dump
 {
 
 public:
 
+	/**
+	 * This is the number of bytes dumped on each line by lines().
+	 */
+	static const size_t WIDTH = 16;
+
+	/**
+	 * This is the number of bytes in each group of hexadecimal digits on a
+	 * line.
+	 */
+	static const size_t GROUP = 4;
+
 	/**
 	 * Constructor.
 	 * @param outputsink refers to the Sink.
@@ -52,6 +65,21 @@ public:
 	 */
 	size_t operator() (const void * data, size_t size);
 
+	/**
+	 * Dump a memory block to the Sink a line of WIDTH bytes at a time. Each
+	 * line is the offset of its first byte in hexadecimal, a colon, the bytes
+	 * in hexadecimal in groups of GROUP, and between vertical bars the bytes
+	 * themselves with each unprintable byte shown as a period, followed like
+	 * the output of Print by a newline and a carriage return. A short last
+	 * line is padded so that its characters line up with those above.
+	 * @param data points to the memory block to be dumped.
+	 * @param size is the size of the memory block in bytes.
+	 * @param offset is the offset shown for the first byte, for example zero
+	 * or the address of the memory block.
+	 * @return the number of bytes written to the Sink.
+	 */
+	size_t lines(const void * data, size_t size, uintptr_t offset = 0);
+
 protected:
 
 	Sink * sink;
@@ -0,0 +1,146 @@
+#ifndef _COM_DIAG_AMIGO_FILTER_H_
+#define _COM_DIAG_AMIGO_FILTER_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/Sink.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * Filter implements a functor that reduces a stream of ten-bit samples, for
+ * example the frames from an A2D scan, to a much smaller stream of Summary
+ * records written to the specified Sink. It does so in three stages using
+ * only integer arithmetic. First, a boxcar (a first order CIC) decimator
+ * averages each group of samples into one. Second, an exponential moving
+ * average smooths the decimated samples. Third, each window of decimated
+ * samples is summarized by its minimum, maximum, mean and root mean square.
+ * All three lengths are powers of two so that every division is a shift.
+ * The Summary is written in the byte order of the target, which for the
+ * megaAVR is little-endian.
+ */
+class Filter
+{
+
+public:
+
+	/**
+	 * This is the record written to the Sink at the end of each window.
+	 */
+	struct Summary {
+		uint16_t sequence;	// Number of this summary, which wraps around.
+		uint16_t minimum;	// Smallest decimated sample in the window.
+		uint16_t maximum;	// Largest decimated sample in the window.
+		uint16_t mean;		// Mean of the decimated samples in the window.
+		uint16_t rms;		// Root mean square of the same.
+		uint16_t average;	// Moving average at the end of the window.
+	};
+
+	/**
+	 * This is the largest log2 of the window length. It keeps the sum of the
+	 * squares of a window of ten-bit samples within thirty-two bits.
+	 */
+	static const uint8_t WINDOW = 12;
+
+	/**
+	 * Constructor.
+	 * @param outputsink refers to the Sink.
+	 * @param decimation is log2 of the number of samples averaged into each
+	 * decimated sample; zero means no decimation.
+	 * @param window is log2 of the number of decimated samples summarized in
+	 * each Summary; it is limited to WINDOW.
+	 * @param smoothing is log2 of the time constant, in decimated samples, of
+	 * the exponential moving average; zero means no smoothing.
+	 */
+	explicit Filter(Sink & outputsink, uint8_t decimation = 0, uint8_t window = 6, uint8_t smoothing = 3);
+
+	/**
+	 * Destructor.
+	 */
+	~Filter() {}
+
+	/**
+	 * Start over as if newly constructed, except that the sequence number
+	 * continues.
+	 */
+	void reset();
+
+	/**
+	 * Consume one sample.
+	 * @param sample is the ten-bit sample.
+	 * @return the number of Summary records written, zero or one.
+	 */
+	size_t operator() (uint16_t sample);
+
+	/**
+	 * Consume a block of samples.
+	 * @param samples points to the ten-bit samples.
+	 * @param size is the number of samples.
+	 * @return the number of Summary records written.
+	 */
+	size_t operator() (const uint16_t * samples, size_t size);
+
+	/**
+	 * Return the current value of the exponential moving average.
+	 * @return the current value of the exponential moving average.
+	 */
+	uint16_t average() const { return (ema + 0x80) >> 8; }
+
+	/**
+	 * Return the integer square root, rounded down, of a value.
+	 * @param value is the value.
+	 * @return the integer square root.
+	 */
+	static uint16_t root(uint32_t value);
+
+protected:
+
+	Sink * sink;
+	uint32_t accumulator;	// Sum of the samples in the decimation group.
+	uint32_t sum;			// Sum of the decimated samples in the window.
+	uint32_t squares;		// Sum of their squares.
+	int32_t ema;			// Moving average scaled by 256.
+	uint16_t phase;			// Samples so far in the decimation group.
+	uint16_t count;			// Decimated samples so far in the window.
+	uint16_t minimum;
+	uint16_t maximum;
+	uint16_t sequence;
+	uint8_t decimate;
+	uint8_t width;
+	uint8_t smooth;
+	bool primed;
+
+	/**
+	 * Consume one decimated sample.
+	 * @param sample is the decimated sample.
+	 * @return the number of Summary records written, zero or one.
+	 */
+	size_t decimated(uint16_t sample);
+
+};
+
+inline size_t Filter::operator() (uint16_t sample) {
+	size_t result = 0;
+	accumulator += sample;
+	if ((++phase) >> decimate) {
+		result = decimated((accumulator + ((1UL << decimate) >> 1)) >> decimate);
+		accumulator = 0;
+		phase = 0;
+	}
+	return result;
+}
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_FILTER_H_ */
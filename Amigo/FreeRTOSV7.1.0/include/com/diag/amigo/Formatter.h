@@ -0,0 +1,274 @@
+#ifndef _COM_DIAG_AMIGO_FORMATTER_H_
+#define _COM_DIAG_AMIGO_FORMATTER_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include <stdarg.h>
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/Sink.h"
+#include "com/diag/amigo/target/harvard.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * FormatterBase implements the conversions used by Formatter. It is not
+ * intended to be used directly.
+ */
+class FormatterBase
+{
+
+public:
+
+	/**
+	 * This is the number of characters collected on the stack before they are
+	 * written to the Sink.
+	 */
+	static const size_t BUFFER = 16;
+
+protected:
+
+	static const uint8_t NONE = 0xff;
+
+	enum Flag {
+		LEFT		= (1 << 0),		// -
+		ZERO		= (1 << 1),		// 0
+		PLUS		= (1 << 2),		// +
+		SPACE		= (1 << 3),		// space
+		ALTERNATE	= (1 << 4)		// #
+	};
+
+	struct Specification {
+		uint8_t flags;
+		uint8_t width;
+		uint8_t precision;
+	};
+
+	class Output {
+	public:
+		explicit Output(Sink & mysink) : sink(&mysink), total(0), length(0) {}
+		void put(char ch) { buffer[length++] = ch; if (length >= sizeof(buffer)) { flush(); } }
+		size_t flush();
+		Sink * sink;
+		size_t total;
+		uint8_t length;
+		char buffer[BUFFER];
+	};
+
+	/**
+	 * Constructor.
+	 * @param outputsink refers to the Sink.
+	 */
+	explicit FormatterBase(Sink & outputsink)
+	: sink(&outputsink)
+	{}
+
+	/**
+	 * Destructor.
+	 */
+	~FormatterBase() {}
+
+	static void pad(Output & output, char ch, uint8_t count);
+
+	static void integer(Output & output, const Specification & specification, unsigned long value, bool negative, uint8_t base, bool upper);
+
+	static void string(Output & output, const Specification & specification, const char * string, bool progmem);
+
+	Sink * sink;
+
+};
+
+/**
+ * Formatter implements a printf-style functor, like Print, whose output is
+ * directed to the specified Sink. Unlike Print it does not format into a
+ * buffer the size of a line using vsnprintf; it writes the output as it parses
+ * the format string, a few characters at a time, so it never truncates, needs
+ * little stack, and doesn't link in the avr-libc printf core. It supports the
+ * subset of printf that Amigo uses: the conversions %d %i %u %x %X %o %c %s
+ * %p and %%, the avr-libc %S for a string in program memory, the l (and the
+ * ignored h) length modifiers, the - 0 + space and # flags, and a decimal
+ * field width and precision. Anything else is written as is. Like Print, a
+ * newline at the end of the format string is followed by a carriage return.
+ * Whether the format string is in program memory or data memory is decided at
+ * compile time by the template parameter, for example Formatter<true> for a
+ * PSTR format string.
+ */
+template <bool _PROGMEM_>
+class Formatter
+: public FormatterBase
+{
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param outputsink refers to the Sink.
+	 */
+	explicit Formatter(Sink & outputsink)
+	: FormatterBase(outputsink)
+	{}
+
+	/**
+	 * Destructor.
+	 */
+	~Formatter() {}
+
+	/**
+	 * Functor which formats a variable length argument list using the
+	 * specified format string and writes the result to the Sink.
+	 * @param format points to the format string.
+	 * @return the number of bytes written to the Sink.
+	 */
+	size_t operator() (const char * format, ...);
+
+	/**
+	 * Format a variable length argument list using the specified format string
+	 * and write the result to the Sink.
+	 * @param format points to the format string.
+	 * @param ap is the variable length argument list.
+	 * @return the number of bytes written to the Sink.
+	 */
+	size_t vformat(const char * format, va_list ap);
+
+protected:
+
+	static char read(const char * here) { return _PROGMEM_ ? static_cast<char>(pgm_read_byte(here)) : *here; }
+
+private:
+
+    /**
+     *  Copy constructor. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Formatter(const Formatter & that);
+
+    /**
+     *  Assignment operator. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Formatter & operator=(const Formatter & that);
+
+};
+
+template <bool _PROGMEM_>
+size_t Formatter<_PROGMEM_>::operator() (const char * format, ...) {
+	va_list ap;
+	va_start(ap, format);
+	size_t total = vformat(format, ap);
+	va_end(ap);
+	return total;
+}
+
+template <bool _PROGMEM_>
+size_t Formatter<_PROGMEM_>::vformat(const char * format, va_list ap) {
+	Output output(*sink);
+	char ch;
+	while ((ch = read(format++)) != '\0') {
+		if (ch != '%') {
+			output.put(ch);
+			if ((ch == '\n') && (read(format) == '\0')) {
+				output.put('\r');
+			}
+			continue;
+		}
+		Specification specification = { 0, 0, NONE };
+		bool longs = false;
+		while (true) {
+			ch = read(format++);
+			if (ch == '-') {
+				specification.flags |= LEFT;
+			} else if (ch == '0') {
+				specification.flags |= ZERO;
+			} else if (ch == '+') {
+				specification.flags |= PLUS;
+			} else if (ch == ' ') {
+				specification.flags |= SPACE;
+			} else if (ch == '#') {
+				specification.flags |= ALTERNATE;
+			} else {
+				break;
+			}
+		}
+		while (('0' <= ch) && (ch <= '9')) {
+			specification.width = (specification.width * 10) + (ch - '0');
+			ch = read(format++);
+		}
+		if (ch == '.') {
+			specification.precision = 0;
+			ch = read(format++);
+			while (('0' <= ch) && (ch <= '9')) {
+				specification.precision = (specification.precision * 10) + (ch - '0');
+				ch = read(format++);
+			}
+		}
+		while ((ch == 'l') || (ch == 'h')) {
+			if (ch == 'l') { longs = true; }
+			ch = read(format++);
+		}
+		switch (ch) {
+		case 'd':
+		case 'i':
+			{
+				long value = longs ? va_arg(ap, long) : va_arg(ap, int);
+				integer(output, specification, (value < 0) ? (0UL - static_cast<unsigned long>(value)) : static_cast<unsigned long>(value), value < 0, 10, false);
+			}
+			break;
+		case 'u':
+			integer(output, specification, longs ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int), false, 10, false);
+			break;
+		case 'x':
+			integer(output, specification, longs ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int), false, 16, false);
+			break;
+		case 'X':
+			integer(output, specification, longs ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int), false, 16, true);
+			break;
+		case 'o':
+			integer(output, specification, longs ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int), false, 8, false);
+			break;
+		case 'p':
+			specification.flags |= ALTERNATE;
+			integer(output, specification, reinterpret_cast<uintptr_t>(va_arg(ap, void *)), false, 16, false);
+			break;
+		case 'c':
+			{
+				uint8_t padding = (specification.width > 1) ? (specification.width - 1) : 0;
+				if ((specification.flags & LEFT) == 0) { pad(output, ' ', padding); }
+				output.put(static_cast<char>(va_arg(ap, int)));
+				if ((specification.flags & LEFT) != 0) { pad(output, ' ', padding); }
+			}
+			break;
+		case 's':
+			string(output, specification, va_arg(ap, const char *), false);
+			break;
+		case 'S':
+			string(output, specification, va_arg(ap, const char *), true);
+			break;
+		case '%':
+			output.put('%');
+			break;
+		case '\0':
+			--format;
+			break;
+		default:
+			output.put('%');
+			output.put(ch);
+			break;
+		}
+	}
+	return output.flush();
+}
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_FORMATTER_H_ */
@@ -0,0 +1,103 @@
+#ifndef _COM_DIAG_AMIGO_LOG_H_
+#define _COM_DIAG_AMIGO_LOG_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/Sink.h"
+#include "com/diag/amigo/target/harvard.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * Log implements a functor that, like Print, takes a printf-style format
+ * string in program memory and a variable length argument list, but instead
+ * of formatting them on the target it writes a compact binary record to the
+ * specified Sink, leaving the formatting to the host. The record is the byte
+ * RECORD, the address of the format string, the tick count, and then, in the
+ * order in which the format string consumes them, the arguments. Integers,
+ * addresses and lengths are encoded as variable length integers, seven bits
+ * per byte least significant first with the high bit set on every byte but
+ * the last; signed integers are first zig-zag encoded so that small negative
+ * values are short too. A %s argument is written as its length followed by
+ * its characters, since the string isn't in program memory. A %S argument
+ * (the avr-libc conversion for a string in program memory) is written as its
+ * address. A floating point argument, including a long double given with %L,
+ * is written as the bytes of a double in the native order of the target.
+ * Widths and precisions given as * are written as signed integers. Seven-bit
+ * ASCII text written by Print never contains the byte RECORD, so the two may
+ * share the same Sink. Other text, for example a %c of 0xa5 or a Latin-1 %s,
+ * may; the scripts/amigolog.py tool, which reads the format strings out of the
+ * ELF file of the application and renders the records as text, passes through
+ * as text any RECORD byte that doesn't begin a record it can decode, and
+ * resumes with the byte after it.
+ */
+class Log
+{
+
+public:
+
+	/**
+	 * This is the byte that begins every record.
+	 */
+	static const uint8_t RECORD = 0xa5;
+
+	/**
+	 * Constructor.
+	 * @param outputsink refers to the Sink.
+	 */
+	explicit Log(Sink & outputsink)
+	: sink(&outputsink)
+	{}
+
+	/**
+	 * Destructor.
+	 */
+	~Log() {}
+
+	/**
+	 * Functor which encodes a variable length argument list as directed by
+	 * the specified format string and writes the resulting record to the
+	 * Sink. The format string is scanned but nothing is formatted.
+	 * @param format points to the format string in program memory.
+	 * @return the number of bytes written to the Sink.
+	 */
+	size_t operator() (PGM_P format, ...);
+
+	/**
+	 * Encode an unsigned value as a variable length integer.
+	 * @param buffer points to at least (((sizeof(value) * 8) + 6) / 7) bytes.
+	 * @param value is the value.
+	 * @return the number of bytes used.
+	 */
+	static size_t varint(uint8_t * buffer, unsigned long value);
+
+	/**
+	 * Encode a signed value as a zig-zag variable length integer.
+	 * @param buffer points to at least (((sizeof(value) * 8) + 6) / 7) bytes.
+	 * @param value is the value.
+	 * @return the number of bytes used.
+	 */
+	static size_t zigzag(uint8_t * buffer, long value) {
+		return varint(buffer, (static_cast<unsigned long>(value) << 1) ^ static_cast<unsigned long>(value >> ((sizeof(value) * 8) - 1)));
+	}
+
+protected:
+
+	Sink * sink;
+
+};
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_LOG_H_ */
@@ -10,7 +10,7 @@
  */
 
 #include <string.h>
-#include <avr/pgmspace.h>
+#include "com/diag/amigo/target/harvard.h"
 #include "com/diag/amigo/types.h"
 #include "com/diag/amigo/byteorder.h"
 
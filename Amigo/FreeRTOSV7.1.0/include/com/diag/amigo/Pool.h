@@ -0,0 +1,207 @@
+#ifndef _COM_DIAG_AMIGO_POOL_H_
+#define _COM_DIAG_AMIGO_POOL_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/types.h"
+
+/**
+ * @def COM_DIAG_AMIGO_POOL_STRIDE
+ * Compute the number of bytes each block of _SIZE_ bytes occupies in a pool,
+ * including the pointer-sized header that precedes it, rounded up so that
+ * every header is aligned.
+ */
+#define COM_DIAG_AMIGO_POOL_STRIDE(_SIZE_) ((((_SIZE_) + sizeof(void *) + sizeof(void *) - 1) / sizeof(void *)) * sizeof(void *))
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * Allocator manages a pool of fixed-size blocks carved out of storage provided
+ * by the application. Free blocks are kept on a singly linked list threaded
+ * through their headers, so allocating and freeing a block are each a couple
+ * of pointer assignments, take the same time no matter what has happened
+ * before, and never fragment. (The FreeRTOS heap_2 allocator that the C++ new
+ * operator uses instead searches a list sorted by size and never coalesces
+ * adjacent free blocks.) While a block is allocated its header points back to
+ * the Allocator that owns it, so that it can be freed knowing only its
+ * address. Both operations disable interrupts briefly, so they may be used by
+ * tasks and by interrupt service routines alike. See Pool for a template that
+ * provides its own storage.
+ */
+class Allocator
+{
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param storage points to COM_DIAG_AMIGO_POOL_STRIDE(blocksize) * blocks
+	 * bytes of memory aligned for a pointer.
+	 * @param blocksize is the usable size of each block in bytes.
+	 * @param blocks is the number of blocks.
+	 */
+	explicit Allocator(void * storage, size_t blocksize, size_t blocks);
+
+	/**
+	 * Destructor. Any blocks still allocated become invalid.
+	 */
+	~Allocator() {}
+
+	/**
+	 * Allocate a block.
+	 * @param size is the number of bytes needed, which may not be more than
+	 * the block size.
+	 * @return a pointer to the block or 0 if the size is too large or if every
+	 * block is already allocated.
+	 */
+	void * allocate(size_t size = 0);
+
+	/**
+	 * Free a block, returning it to the Allocator from which it came.
+	 * @param ptr points to a block allocated by any Allocator, or is 0 in
+	 * which case nothing is done.
+	 */
+	static void deallocate(void * ptr);
+
+	/**
+	 * Return the usable size of each block in bytes.
+	 * @return the usable size of each block in bytes.
+	 */
+	size_t size() const { return blocksize; }
+
+	/**
+	 * Return the number of blocks in the pool.
+	 * @return the number of blocks in the pool.
+	 */
+	size_t capacity() const { return blocks; }
+
+	/**
+	 * Return the number of blocks that are free.
+	 * @return the number of blocks that are free.
+	 */
+	size_t available() const { return unallocated; }
+
+	/**
+	 * Return the fewest number of blocks that have ever been free. This is
+	 * useful for sizing the pool.
+	 * @return the low water mark of free blocks.
+	 */
+	size_t minimum() const { return lowwater; }
+
+protected:
+
+	struct Block {
+		union {
+			Block * next;			// When free.
+			Allocator * owner;		// When allocated.
+		} header;
+	};
+
+	Block * head;
+	size_t blocksize;
+	size_t blocks;
+	volatile size_t unallocated;
+	size_t lowwater;
+
+private:
+
+    /**
+     *  Copy constructor. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Allocator(const Allocator & that);
+
+    /**
+     *  Assignment operator. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Allocator & operator=(const Allocator & that);
+
+};
+
+/**
+ * Pool is an Allocator that contains the storage for _COUNT_ blocks each of
+ * which is _SIZE_ bytes. Typically it is given static storage duration. For
+ * example, Pool<sizeof(MyTimer), 4> holds enough blocks for four MyTimer
+ * objects, which can be allocated from it by deriving MyTimer from Pooled.
+ */
+template <size_t _SIZE_, size_t _COUNT_>
+class Pool
+: public Allocator
+{
+
+public:
+
+	/**
+	 * Constructor.
+	 */
+	explicit Pool()
+	: Allocator(storage, _SIZE_, _COUNT_)
+	{}
+
+	/**
+	 * Destructor.
+	 */
+	~Pool() {}
+
+protected:
+
+	void * storage[(COM_DIAG_AMIGO_POOL_STRIDE(_SIZE_) / sizeof(void *)) * _COUNT_];
+
+};
+
+/**
+ * Pooled is a mix-in class whose operator new and operator delete allocate
+ * objects from an Allocator instead of from the heap. A class that derives
+ * from it is created with, for example, new (pool) MyTimer(...) and destroyed
+ * with delete as usual, which returns the block to its Allocator. Because the
+ * class-specific operator new hides the global one, an attempt to allocate
+ * such an object from the heap doesn't compile. If the pool is exhausted or
+ * its blocks are too small, new returns 0 and no constructor is called. To
+ * delete through a pointer to a base class, such as Timer or Socket, the base
+ * class must have a virtual destructor, which in Amigo they do.
+ */
+class Pooled
+{
+
+public:
+
+	/**
+	 * Allocate an object from an Allocator.
+	 * @param size is the size of the object in bytes.
+	 * @param allocator refers to the Allocator.
+	 * @return a pointer to the block or 0 if none could be allocated.
+	 */
+	static void * operator new(size_t size, Allocator & allocator) throw() { return allocator.allocate(size); }
+
+	/**
+	 * Return an object to the Allocator from which it came.
+	 * @param ptr points to the object.
+	 */
+	static void operator delete(void * ptr) { Allocator::deallocate(ptr); }
+
+	/**
+	 * Return an object to an Allocator. This is only called if a constructor
+	 * throws an exception.
+	 * @param ptr points to the object.
+	 * @param allocator refers to the Allocator.
+	 */
+	static void operator delete(void * ptr, Allocator & allocator) { Allocator::deallocate(ptr); }
+
+};
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_POOL_H_ */
@@ -0,0 +1,250 @@
+#ifndef _COM_DIAG_AMIGO_POSIX_CONSOLE_H_
+#define _COM_DIAG_AMIGO_POSIX_CONSOLE_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/cxxcapi.h"
+#include "com/diag/amigo/target/harvard.h"
+
+#if defined(__cplusplus)
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * Console implements a special debugging interface which on a POSIX host
+ * writes synchronously to standard error. It does not rely on any underlying
+ * FreeRTOS software. This makes it inappropriate for real-time applications,
+ * but extremely useful for low level debugging. The API encourages the use of method chaining, which makes
+ * writing debugging code much easier. Typically I would put the following
+ * example all on one line.
+ *
+ * Console::instance()
+ * .start()
+ * .write("TASK=0x")
+ * .dump(&task, sizeof(task))
+ * .write("\r\n")
+ * .flush()
+ * .stop();
+ *
+ * There is also a CXXC API that allows Console to be used from C code. In the
+ * following example, the default Console instance is used implicitly.
+ *
+ * amigo_console_start();
+ * amigo_console_write_string("TASK=0x");
+ * amigo_console_dump(&task, sizeof(task));
+ * amigo_console_write_string("\r\n");
+ * amigo_console_flush();
+ * amigo_console_stop();
+ */
+class Console
+{
+	/***************************************************************************
+	 * TYPES AND CONSTANTS
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * This is the default serial rate in bits per second.
+	 */
+	static const uint32_t RATE = 115200UL;
+
+	/***************************************************************************
+	 * CONSTRUCTING AND DESTRUCTING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * This returns a reference to a pre-built Console object.
+	 * @return a reference to a pre-built Console object.
+	 */
+	static Console & instance();
+
+	/**
+	 * Constructor.
+	 */
+	explicit Console();
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~Console();
+
+	/***************************************************************************
+	 * STARTING AND STOPPING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Start the Console. On the host this does nothing; the rate is ignored.
+	 * @param rate is the desired serial rate in bits per second.
+	 * @return a reference to this Console object.
+	 */
+	Console & start(uint32_t rate = RATE);
+
+	/**
+	 * Stop the Console. On the host this does nothing.
+	 * @return a reference to this Console object.
+	 */
+	Console & stop();
+
+	/***************************************************************************
+	 * READING AND WRITING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Display a character on standard error.
+	 * @param ch is a character to be displayed.
+	 * @return a reference to this Console object.
+	 */
+	Console & write(uint8_t ch);
+
+	/**
+	 * Display a nul-terminated C string in data space.
+	 * @param string points to the string to be displayed.
+	 * @return a reference to this Console object.
+	 */
+	Console & write(const char * string);
+
+	/**
+	 * Display a nul-terminated C string in program space.
+	 * @param string points to the string to be displayed.
+	 * @return a reference to this Console object.
+	 */
+	Console & write_P(PGM_P string);
+
+	/**
+	 * Display a fixed data block in data space.
+	 * @param data points to the data block to be displayed.
+	 * @param size is the size of the data block in bytes.
+	 * @return a reference to this Console object.
+	 */
+	Console & write(const void * data, size_t size);
+
+	/**
+	 * Display a fixed data block in program space.
+	 * @param data points to the data block to be displayed.
+	 * @param size is the size of the data block in bytes.
+	 * @return a reference to this Console object.
+	 */
+	Console & write_P(PGM_VOID_P data, size_t size);
+
+	/**
+	 * Dump a fixed data block in data space in printable hex digits.
+	 * @param data points to the data block to be dumped.
+	 * @param size is the size of the data block in bytes.
+	 * @return a reference to this Console object.
+	 */
+	Console & dump(const void * data, size_t size);
+
+	/**
+	 * Dump a fixed data block in program space in printable hex digits.
+	 * @param data points to the data block to be dumped.
+	 * @param size is the size of the data block in bytes.
+	 * @return a reference to this Console object.
+	 */
+	Console & dump_P(PGM_VOID_P data, size_t size);
+
+	/**
+	 * Wait until all requested data has been displayed. Since the host writes
+	 * are synchronous, this does nothing.
+	 * @return a reference to this Console object.
+	 */
+	Console & flush();
+
+protected:
+
+	void emit(uint8_t ch);
+
+};
+
+}
+}
+}
+
+#endif
+
+/**
+ * Start the default Console.
+ */
+CXXCAPI void amigo_console_start();
+
+/**
+ * Stop the default Console.
+ */
+CXXCAPI void amigo_console_stop(void);
+
+/**
+ * Display a character on standard error.
+ * @param ch is a character to be displayed.
+ */
+CXXCAPI void amigo_console_write_char(uint8_t ch);
+
+/**
+ * Display a nul-terminated C string in data space.
+ * @param string points to the string to be displayed.
+ */
+CXXCAPI void amigo_console_write_string(const char * string);
+
+/**
+ * Display a nul-terminated C string in program space.
+ * @param string points to the string to be displayed.
+ */
+CXXCAPI void amigo_console_write_string_P(PGM_P string);
+
+/**
+ * Display a fixed data block in data space.
+ * @param data points to the data block to be displayed.
+ * @param size is the size of the data block in bytes.
+ */
+CXXCAPI void amigo_console_write_data(const void * data, size_t size);
+
+/**
+ * Display a fixed data block in program space.
+ * @param data points to the data block to be displayed.
+ * @param size is the size of the data block in bytes.
+ */
+CXXCAPI void amigo_console_write_data_P(PGM_VOID_P data, size_t size);
+
+/**
+ * Dump a fixed data block in data space in printable hex digits.
+ * @param data points to the data block to be dumped.
+ * @param size is the size of the data block in bytes.
+ */
+CXXCAPI void amigo_console_dump(const void * data, size_t size);
+
+/**
+ * Dump a fixed data block in program space in printable hex digits.
+ * @param data points to the data block to be dumped.
+ * @param size is the size of the data block in bytes.
+ */
+CXXCAPI void amigo_console_dump_P(PGM_VOID_P data, size_t size);
+
+/**
+ * Wait until all requested data has been displayed. Since the host writes
+ * are synchronous, this does nothing.
+ */
+CXXCAPI void amigo_console_flush(void);
+
+/**
+ * This functions calls all of the other functions with the sole purpose of
+ * emitting a single character to the default serial port. It is used for
+ * very low level debugging, including of C code.
+ * @param ch is the character to emit.
+ */
+CXXCAPI void amigo_console_trace(char ch);
+
+#endif /* _COM_DIAG_AMIGO_POSIX_CONSOLE_H_ */
@@ -0,0 +1,258 @@
+#ifndef _COM_DIAG_AMIGO_POSIX_SPI_H_
+#define _COM_DIAG_AMIGO_POSIX_SPI_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ * This code is gratefully inspired by FreeRTOS lib_spi and Arduino SPI.
+ */
+
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/constants.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * SPI implements the same API as the megaAVR interrupt-driven SPI driver on a
+ * POSIX host. There is no SPI bus on the host, so this SPI behaves like a
+ * master whose MOSI pin is wired to its own MISO pin: every byte transmitted
+ * is received back, synchronously, in the calling task. This is enough to
+ * exercise and profile code layered on SPI natively. Use of the SPI must still
+ * be serialized with a MutexSemaphore, as on the target.
+ */
+class SPI
+{
+
+	/***************************************************************************
+	 * TYPES AND CONSTANTS
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Identifies the specific SPI controller to be associated with a particular
+	 * SPI object. Generally there is only one SPI controller.
+	 */
+	enum Controller {
+		SPI0 = 0,
+		FAIL = 255
+	};
+
+	/**
+	 * Identifies the bit order for transmission onto the SPI bus: Most
+	 * Significant Bit first, or Least Significant Bit first.
+	 */
+	enum Order {
+		MSB,
+		LSB
+	};
+
+	/**
+	 * Specifies the role of this SPI bus, Master or Slave. My long experience
+	 * with another common embedded bus standard, I2C (a.k.a. TWI) suggests
+	 * that it is a mistake to architect a system that switches back and forth
+	 * between roles; the inability to reliably synchronize who is playing what
+	 * role on the bus leads to wackiness ensuing. (I have no way currently to
+	 * test the slave role.)
+	 */
+	enum Role {
+		SLAVE,
+		MASTER
+	};
+
+	/**
+	 * Specifies signal polarity, normal or inverted.
+	 */
+	enum Polarity {
+		NORMAL,
+		INVERTED
+	};
+
+	/**
+	 * Specifies the signal phase used to detect bits on the SPI bus, leading or
+	 * trailing.
+	 */
+	enum Phase {
+		LEADING,
+		TRAILING
+	};
+
+	/**
+	 * SPI devices require a SPI clock (pin SCK)  to drive the shift registers
+	 * that clock bits onto and off of the SPI bus (pins MISO for Master In
+	 * Slave Out and MOSI for Master Out Slave In). The SPI clock frequency
+	 * depends on the abilities of both the master and slave device. For
+	 * example, a divisor of D4 on a 16MHz ATmega328p or ATmega2560 requires
+	 * that the master and slave devices be able to keep up with a 4MHz clock
+	 * rate. Your mileage may vary.
+	 */
+	enum Divisor {
+		D2,
+		D4,
+		D8,
+		D16,
+		D32,
+		D64,
+		D128
+	};
+
+	/**
+	 * Defines the default receive ring buffer size in bytes. This is accepted
+	 * for compatibility.
+	 */
+	static const size_t RECEIVES = 1;
+
+	/**
+	 * Defines the default transmit ring buffer size in bytes. This is accepted
+	 * for compatibility.
+	 */
+	static const size_t TRANSMITS = 1;
+
+	/***************************************************************************
+	 * CONSTRUCTING AND DESTRUCTING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param mycontroller identities the SPI that this object manages.
+	 * @param transmits is ignored.
+	 * @param receives is ignored.
+	 */
+	explicit SPI(Controller mycontroller = SPI0, size_t transmits = TRANSMITS, size_t receives = RECEIVES);
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~SPI();
+
+	/**
+	 * Return true if construction was successful false otherwise.
+	 * @return true if construction was successful, false otherwise.
+	 */
+	operator bool() const { return (controller != FAIL); }
+
+	/***************************************************************************
+	 * STARTING AND STOPPING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Start I/O operations. The settings are accepted but have no effect.
+	 * @param divisor specifies the oscillator frequency divisor.
+	 * @param role specifies whether this SPI controller is Master or Slave.
+	 * @param order specifies Most or Least Significant Bit transmission order.
+	 * @param polarity specifies Positive or Negative signal polarity.
+	 * @param phase specifies signal phase Leading or Trailing.
+	 */
+	void start(Divisor divisor = D4, Role role = MASTER, Order order = MSB, Polarity polarity = NORMAL, Phase phase = LEADING);
+
+	/**
+	 * Stop I/O operations. Transfers fail until restart().
+	 */
+	void stop();
+
+	/**
+	 * Restart I/O operations after a stop().
+	 */
+	void restart();
+
+	/***************************************************************************
+	 * READING AND WRITING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Transmit a byte and return the byte received in exchange, which on the
+	 * host is the same byte.
+	 * @param ch is the byte to transmit.
+	 * @param timeout is ignored.
+	 * @return the received byte or <0 if fail.
+	 */
+	int master(uint8_t ch = 0, ticks_t timeout = NEVER);
+
+	/**
+	 * Transmit a byte and return the byte received in exchange. On the host
+	 * this is the same as master().
+	 * @param ch is the byte to transmit.
+	 * @param timeout is ignored.
+	 * @return the received byte or <0 if fail.
+	 */
+	int slave(uint8_t ch = 0, ticks_t timeout = NEVER);
+
+	/**
+	 * Transfer a block of bytes as a master. Each byte in the transmit buffer
+	 * is transmitted and the byte received in exchange is stored in the
+	 * receive buffer. The transmit and receive buffers may be the same buffer.
+	 * @param data points to the bytes to transmit, or NULL to transmit zeros.
+	 * @param buffer points to where to store the received bytes, or NULL to
+	 * discard them.
+	 * @param length is the number of bytes to transfer.
+	 * @param timeout is ignored.
+	 * @return the number of bytes transferred or <0 if fail.
+	 */
+	ssize_t transfer(const void * data, void * buffer, size_t length, ticks_t timeout = NEVER);
+
+	/***************************************************************************
+	 * CHECKING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Cast this object to an integer by returning the error counter. The error
+	 * counter is cumulative. The application is responsible for interrogating
+	 * it using this operator and resetting it.
+	 * @return the error counter.
+	 */
+	operator uint8_t() const { return errors; }
+
+	/**
+	 * Set the error counter to the specified integer value. Zero is a good
+	 * value, which resets the error counter.
+	 * @param value is the new error counter value.
+	 * @return a reference to this object.
+	 */
+	SPI & operator=(uint8_t value);
+
+protected:
+
+	Controller controller;
+	uint8_t errors;
+	bool running;
+
+private:
+
+    /**
+     *  Copy constructor. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	SPI(const SPI & that);
+
+    /**
+     *  Assignment operator. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	SPI & operator=(const SPI& that);
+
+};
+
+inline int SPI::slave(uint8_t ch, ticks_t timeout) {
+	return master(ch, timeout);
+}
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_POSIX_SPI_H_ */
@@ -0,0 +1,378 @@
+#ifndef _COM_DIAG_AMIGO_POSIX_SERIAL_H_
+#define _COM_DIAG_AMIGO_POSIX_SERIAL_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/constants.h"
+#include "com/diag/amigo/target/harvard.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * Serial implements the same API as the megaAVR interrupt-driven USART
+ * driver on a POSIX host so that code that uses a Serial, a SerialSink, or a
+ * SerialSource can be run and profiled natively. USART0 is the standard input
+ * and standard output of the process, which lets the unit test output be
+ * displayed or captured as usual. Any other port is the master side of a
+ * pseudo-terminal whose slave side can be opened by a terminal program. All
+ * I/O is synchronous: writes go straight to the file descriptor, and reads
+ * poll it, delaying the calling task for a tick between polls. The line
+ * settings passed to start() are accepted but have no effect except on the
+ * computed character time used for idle line detection.
+ */
+class Serial
+{
+
+	/***************************************************************************
+	 * TYPES AND CONSTANTS
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Identifies the port to be associated with a particular Serial object.
+	 */
+	enum Port {
+		USART0 = 0,
+		USART1 = 1,
+		USART2 = 2,
+		USART3 = 3,
+		FAIL = 255
+	};
+
+	/**
+	 * Specifies the desired baud rate in bits per second.
+	 */
+	enum Baud {
+		B50,
+		B75,
+		B110,
+		B134,
+		B150,
+		B200,
+		B300,
+		B600,
+		B1200,
+		B1800,
+		B2400,
+		B4800,
+		B9600,
+		B19200,
+		B38400,
+		B57600,
+		B115200
+	};
+
+	/**
+	 * Specifies the number of data bits per character.
+	 */
+	enum Data {
+		FIVE,
+		SIX,
+		SEVEN,
+		EIGHT
+	};
+
+	/**
+	 * Specifies the number of parity bits per character.
+	 */
+	enum Parity {
+		NONE,
+		EVEN,
+		ODD
+	};
+
+	/**
+	 * Specifies the number of stop bits per character.
+	 */
+	enum Stop {
+		ONE,
+		TWO
+	};
+
+	/**
+	 * Defines the default receive buffer size in bytes. This is accepted for
+	 * compatibility but the host buffers input itself.
+	 */
+	static const size_t RECEIVES = 16;
+
+	/**
+	 * Defines the default transmit buffer size in bytes. This is accepted for
+	 * compatibility, but it is also the size of the formatting buffer in
+	 * Print, so it has the same value as on the target.
+	 */
+	static const size_t TRANSMITS = 82;
+
+	/**
+	 * Defines the character that would be returned for a received character
+	 * with a framing error. The host never reports one.
+	 */
+	static const uint8_t BAD = '?';
+
+	/**
+	 * Defines the default number of idle character times that satisfy a bulk
+	 * read().
+	 */
+	static const uint8_t IDLE = 4;
+
+	/**
+	 * Defines the bulk write burst size. This is accepted for compatibility;
+	 * the host writes each buffer in as few system calls as it can.
+	 */
+	static const size_t BURST = 16;
+
+	/**
+	 * Defines the size of the buffer holding the name of the pseudo-terminal
+	 * slave device, including the terminating NUL.
+	 */
+	static const size_t DEVICE = 64;
+
+	/***************************************************************************
+	 * CONSTRUCTING AND DESTRUCTING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Constructor. USART0 uses standard input and output; any other port
+	 * opens a new pseudo-terminal.
+	 * @param myport identities the port that this object manages.
+	 * @param transmits is ignored.
+	 * @param receives is ignored.
+	 * @param mybad specifies the character to be used for a receive error.
+	 */
+	explicit Serial(Port myport = USART0, size_t transmits = TRANSMITS, size_t receives = RECEIVES, uint8_t mybad = BAD);
+
+	/**
+	 * Destructor. A pseudo-terminal is closed.
+	 */
+	virtual ~Serial();
+
+	/**
+	 * Return true if construction was successful false otherwise.
+	 * @return true if construction was successful, false otherwise.
+	 */
+	operator bool() const { return ((input >= 0) && (output >= 0)); }
+
+	/**
+	 * Return the name of the pseudo-terminal slave device that a terminal
+	 * program can open to talk to this port, or NULL for USART0.
+	 * @return the name of the slave device or NULL.
+	 */
+	const char * device() const { return (name[0] != '\0') ? name : 0; }
+
+	/***************************************************************************
+	 * STARTING AND STOPPING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Start I/O operations.
+	 * @param baud specifies the desired baud rate.
+	 * @param data specifies the desired number of data bits per character.
+	 * @param parity specifies the desired parity bits per character.
+	 * @param stop specifies the number of parity bits per character.
+	 */
+	void start(Baud baud = B115200, Data data = EIGHT, Parity parity = NONE, Stop stop = ONE);
+
+	/**
+	 * Start I/O operations.
+	 * @param rate specifies the desired baud rate in bits per second.
+	 * @param data specifies the desired number of data bits per character.
+	 * @param parity specifies the desired parity bits per character.
+	 * @param stop specifies the number of parity bits per character.
+	 */
+	void start(uint32_t rate, Data data = EIGHT, Parity parity = NONE, Stop stop = ONE);
+
+	/**
+	 * Stop I/O operations. Reads and writes fail until restart().
+	 */
+	void stop();
+
+	/**
+	 * Restart I/O operations after a stop().
+	 */
+	void restart();
+
+	/***************************************************************************
+	 * READING AND WRITING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Return the number of characters available to be read.
+	 * @return the number of characters available or <0 if fail.
+	 */
+	int available() const;
+
+	/**
+	 * Wait until all written characters have been handed to the host.
+	 */
+	void flush();
+
+	/**
+	 * Discard all the characters available to be read.
+	 * @param timeout is the number of ticks to wait for more to arrive.
+	 */
+	void clear(ticks_t timeout = IMMEDIATELY);
+
+	/**
+	 * Return the first character without consuming it.
+	 * @param timeout is the number of ticks to wait when none is available.
+	 * @return the first character or <0 if fail.
+	 */
+	int peek(ticks_t timeout = NEVER);
+
+	/**
+	 * Return and consume the first character.
+	 * @param timeout is the number of ticks to wait when none is available.
+	 * @return the first character or <0 if fail.
+	 */
+	int read(ticks_t timeout = NEVER);
+
+	/**
+	 * Set the receive threshold used by the bulk read(). See the megaAVR
+	 * Serial for the semantics; here the idle line is detected by polling.
+	 * @param count is the number of characters that satisfies a bulk read.
+	 * @param characters is the number of idle character times that satisfies
+	 * a bulk read once at least one character is available.
+	 */
+	void threshold(size_t count, uint8_t characters = IDLE);
+
+	/**
+	 * Consume as many characters as are available, up to the size of the
+	 * buffer, waiting as determined by the receive threshold.
+	 * @param buffer points to where the characters are stored.
+	 * @param size is the size of the buffer in bytes.
+	 * @param timeout is the number of ticks to wait when none is available.
+	 * @return the number of characters stored, which may be zero.
+	 */
+	size_t read(void * buffer, size_t size, ticks_t timeout = NEVER);
+
+	/**
+	 * Write a character.
+	 * @param ch is the character to be written.
+	 * @param timeout is ignored.
+	 * @return one if the function was successful, zero otherwise.
+	 */
+	size_t write(uint8_t ch, ticks_t timeout = NEVER);
+
+	/**
+	 * Write a buffer from data space.
+	 * @param data points to the characters to be written.
+	 * @param size is the number of characters to be written.
+	 * @param timeout is ignored.
+	 * @return the number of characters written.
+	 */
+	size_t write(const void * data, size_t size, ticks_t timeout = NEVER);
+
+	/**
+	 * Write a buffer from program space, which on the host is data space.
+	 * @param data points to the characters to be written.
+	 * @param size is the number of characters to be written.
+	 * @param timeout is ignored.
+	 * @return the number of characters written.
+	 */
+	size_t write_P(PGM_VOID_P data, size_t size, ticks_t timeout = NEVER);
+
+	/**
+	 * Write a character ahead of any pending characters. Since nothing is ever
+	 * pending on the host, this is the same as write().
+	 * @param ch is the character to be written.
+	 * @param timeout is ignored.
+	 * @return one if the function was successful, zero otherwise.
+	 */
+	size_t express(uint8_t ch, ticks_t timeout = NEVER);
+
+	/***************************************************************************
+	 * CHECKING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Cast this object to an integer by returning the error counter.
+	 * @return the error counter.
+	 */
+	operator uint8_t() const { return errors; }
+
+	/**
+	 * Set the error counter to the specified integer value.
+	 * @param value is the new error counter value.
+	 * @return a reference to this object.
+	 */
+	Serial & operator=(uint8_t value);
+
+protected:
+
+	int input;
+	int output;
+	char name[DEVICE];
+	Port port;
+	double microseconds;
+	size_t batch;
+	ticks_t quiet;
+	int pending;
+	uint8_t idle;
+	uint8_t bad;
+	uint8_t errors;
+	bool running;
+
+	/**
+	 * Wait up to the timeout for at least one character to be available.
+	 * @param timeout is the number of ticks to wait.
+	 * @return true if a character is available, false otherwise.
+	 */
+	bool wait(ticks_t timeout);
+
+	/**
+	 * Compute the idle interval in ticks.
+	 */
+	void quiesce();
+
+private:
+
+    /**
+     *  Copy constructor. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Serial(const Serial & that);
+
+    /**
+     *  Assignment operator. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Serial & operator=(const Serial& that);
+
+};
+
+inline size_t Serial::write(uint8_t ch, ticks_t timeout) {
+	return write(&ch, sizeof(ch), timeout);
+}
+
+inline size_t Serial::write_P(PGM_VOID_P data, size_t size, ticks_t timeout) {
+	return write(data, size, timeout);
+}
+
+inline size_t Serial::express(uint8_t ch, ticks_t timeout) {
+	return write(ch, timeout);
+}
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_POSIX_SERIAL_H_ */
@@ -0,0 +1,29 @@
+#ifndef _COM_DIAG_AMIGO_POSIX_DELAY_H_
+#define _COM_DIAG_AMIGO_POSIX_DELAY_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ * This provides the busy wait functions from <util/delay.h> that Amigo uses
+ * by spinning on the host monotonic clock.
+ */
+
+#include <time.h>
+
+inline void _delay_us(double microseconds) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double until = (now.tv_sec * 1000000.0) + (now.tv_nsec / 1000.0) + microseconds;
+	do {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+	} while (((now.tv_sec * 1000000.0) + (now.tv_nsec / 1000.0)) < until);
+}
+
+inline void _delay_ms(double milliseconds) {
+	_delay_us(milliseconds * 1000.0);
+}
+
+#endif /* _COM_DIAG_AMIGO_POSIX_DELAY_H_ */
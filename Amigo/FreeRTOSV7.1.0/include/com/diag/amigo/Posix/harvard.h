@@ -0,0 +1,54 @@
+#ifndef _COM_DIAG_AMIGO_POSIX_HARVARD_H_
+#define _COM_DIAG_AMIGO_POSIX_HARVARD_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ * A POSIX host has a single address space, so the program space type
+ * qualifiers and accessors from <avr/pgmspace.h> that Amigo uses are
+ * defined here to be their data space equivalents.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include "com/diag/amigo/types.h"
+
+#define PROGMEM
+
+#define PSTR(_STRING_) (_STRING_)
+
+#define PGM_P const char *
+
+#define PGM_VOID_P const void *
+
+#define pgm_read_byte(_ADDRESS_) (*(const uint8_t *)(_ADDRESS_))
+
+#define pgm_read_word(_ADDRESS_) (*(const uint16_t *)(_ADDRESS_))
+
+#define pgm_read_dword(_ADDRESS_) (*(const uint32_t *)(_ADDRESS_))
+
+#define memcpy_P memcpy
+
+#define memcmp_P memcmp
+
+#define strlen_P strlen
+
+#define strcmp_P strcmp
+
+#define strncmp_P strncmp
+
+#define strcpy_P strcpy
+
+#define strncpy_P strncpy
+
+#define printf_P printf
+
+#define snprintf_P snprintf
+
+#define vsnprintf_P vsnprintf
+
+#endif /* _COM_DIAG_AMIGO_POSIX_HARVARD_H_ */
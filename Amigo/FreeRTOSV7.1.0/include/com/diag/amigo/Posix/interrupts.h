@@ -0,0 +1,107 @@
+#ifndef _COM_DIAG_AMIGO_POSIX_INTERRUPTS_H_
+#define _COM_DIAG_AMIGO_POSIX_INTERRUPTS_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ * On a POSIX host there are no interrupts. Disabling "interrupts" enters a
+ * FreeRTOS critical section, which keeps the simulator from switching tasks,
+ * and locks a process-wide recursive mutex, which excludes any host threads
+ * that stand in for interrupt service routines. The value returned in place
+ * of SREG has the I bit set if this was the outermost disable.
+ */
+
+#include <pthread.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/cxxcapi.h"
+
+/**
+ * This is the mutex that serializes all uninterruptible sections.
+ */
+CXXCAPI pthread_mutex_t amigo_interrupts_mutex;
+
+/**
+ * This is the nesting depth of uninterruptible sections.
+ */
+CXXCAPI volatile uint8_t amigo_interrupts_depth;
+
+/**
+ * This is the I bit in the megaAVR SREG.
+ */
+#define COM_DIAG_AMIGO_INTERRUPTS_ENABLED (0x80)
+
+/**
+ * Enable interrupts system-wide. On the host this does nothing but report
+ * whether interrupts are currently enabled.
+ * @return the prior state in the form of an SREG value.
+ */
+CXXCINLINE uint8_t amigo_interrupts_enable(void) {
+	return (amigo_interrupts_depth == 0) ? COM_DIAG_AMIGO_INTERRUPTS_ENABLED : 0;
+}
+
+/**
+ * Disable interrupts and return the prior state. This function can be called
+ * from either C or C++ translation units.
+ * @return the prior state in the form of an SREG value.
+ */
+CXXCINLINE uint8_t amigo_interrupts_disable(void) {
+	portENTER_CRITICAL();
+	pthread_mutex_lock(&amigo_interrupts_mutex);
+	return (amigo_interrupts_depth++ == 0) ? COM_DIAG_AMIGO_INTERRUPTS_ENABLED : 0;
+}
+
+/**
+ * Restore the state returned by a prior disable. This function can be called
+ * from either C or C++ translation units.
+ * @param sreg is the prior state returned by disable.
+ */
+CXXCINLINE void amigo_interrupts_restore(uint8_t sreg) {
+	--amigo_interrupts_depth;
+	pthread_mutex_unlock(&amigo_interrupts_mutex);
+	portEXIT_CRITICAL();
+}
+
+#if defined(__cplusplus)
+
+namespace com {
+namespace diag {
+namespace amigo {
+namespace interrupts {
+
+/**
+ * Enable interrupts system-wide.
+ * @return the prior state in the form of an SREG value.
+ */
+inline uint8_t enable() {
+	return amigo_interrupts_enable();
+}
+
+/**
+ * Disable interrupts and return the prior state.
+ * @return the prior state in the form of an SREG value.
+ */
+inline uint8_t disable() {
+	return amigo_interrupts_disable();
+}
+
+/**
+ * Restore the state returned by a prior disable.
+ * @param sreg is the prior state.
+ */
+inline void restore(uint8_t sreg) {
+	amigo_interrupts_restore(sreg);
+}
+
+}
+}
+}
+}
+
+#endif /* defined(__cplusplus) */
+
+#endif /* _COM_DIAG_AMIGO_POSIX_INTERRUPTS_H_ */
@@ -0,0 +1,33 @@
+#ifndef _COM_DIAG_AMIGO_POSIX_RUNTIME_H_
+#define _COM_DIAG_AMIGO_POSIX_RUNTIME_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ * On a POSIX host the counter that FreeRTOS uses for its run time statistics
+ * is the monotonic clock in microseconds since the scheduler was started.
+ */
+
+#include "com/diag/amigo/cxxcapi.h"
+
+/**
+ * @def COM_DIAG_AMIGO_RUNTIME_HZ
+ * This is the frequency of the counter in Hertz.
+ */
+#define COM_DIAG_AMIGO_RUNTIME_HZ (1000000UL)
+
+/**
+ * Reset the counter to zero and start it.
+ */
+CXXCAPI void amigo_runtime_start(void);
+
+/**
+ * Return the value of the counter.
+ * @return the value of the counter.
+ */
+CXXCAPI unsigned long amigo_runtime_counter(void);
+
+#endif /* _COM_DIAG_AMIGO_POSIX_RUNTIME_H_ */
@@ -0,0 +1,90 @@
+#ifndef _COM_DIAG_AMIGO_POSIX_WATCHDOG_H_
+#define _COM_DIAG_AMIGO_POSIX_WATCHDOG_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ * A POSIX host has no watchdog timer. Enabling or resetting it does nothing,
+ * and restarting the system terminates the process abnormally so that the
+ * failure is obvious to whatever is running the unit test.
+ */
+
+#include <stdlib.h>
+#include "com/diag/amigo/cxxcapi.h"
+#include "com/diag/amigo/types.h"
+
+/**
+ * Disable the watchdog timer and return the reset reason, which on the host
+ * is always zero.
+ * @return zero.
+ */
+CXXCINLINE uint8_t amigo_watchdog_disable(void) {
+	return 0;
+}
+
+/**
+ * Restart the system by aborting the process.
+ */
+CXXCINLINE void amigo_watchdog_restart(void) {
+	abort();
+}
+
+/**
+ * Enable the watchdog timer, which does nothing on the host.
+ */
+CXXCINLINE void amigo_watchdog_enable(void) {
+}
+
+/**
+ * Reset the watchdog timer, which does nothing on the host.
+ */
+CXXCINLINE void amigo_watchdog_reset(void) {
+}
+
+#if defined(__cplusplus)
+
+namespace com {
+namespace diag {
+namespace amigo {
+namespace watchdog {
+
+/**
+ * Disable the watchdog timer.
+ * @return zero.
+ */
+inline uint8_t disable() {
+	return amigo_watchdog_disable();
+}
+
+/**
+ * Restart the system by aborting the process.
+ */
+inline void restart() {
+	amigo_watchdog_restart();
+}
+
+/**
+ * Enable the watchdog timer.
+ */
+inline void enable() {
+	amigo_watchdog_enable();
+}
+
+/**
+ * Reset the watchdog timer.
+ */
+inline void reset() {
+	amigo_watchdog_reset();
+}
+
+}
+}
+}
+}
+
+#endif
+
+#endif /* _COM_DIAG_AMIGO_POSIX_WATCHDOG_H_ */
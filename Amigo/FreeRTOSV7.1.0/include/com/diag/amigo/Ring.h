@@ -0,0 +1,341 @@
+#ifndef _COM_DIAG_AMIGO_RING_H_
+#define _COM_DIAG_AMIGO_RING_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/constants.h"
+#include "com/diag/amigo/unused.h"
+#include "com/diag/amigo/BinarySemaphore.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * Ring is a lock-free ring buffer for exactly one producer and exactly one
+ * consumer, typically an interrupt service routine on one side and a task on
+ * the other. The producer only ever writes the head index and the consumer
+ * only ever writes the tail index, and each index is a single byte which the
+ * megaAVR reads and writes atomically, so neither side has to disable
+ * interrupts. The capacity must be a power of two no larger than 128 so that
+ * the free-running eight-bit indices can be masked instead of divided and so
+ * that a full ring can be told from an empty one. Unlike a Queue, a Ring
+ * involves no FreeRTOS calls at all; see RingQueue for one that can block.
+ */
+template <typename _TYPE_, uint8_t _CAPACITY_>
+class Ring
+{
+
+	/**
+	 * This fails to compile if the capacity is not a power of two no larger
+	 * than 128.
+	 */
+	typedef char capacity_must_be_power_of_two_no_larger_than_128[(((_CAPACITY_ & (_CAPACITY_ - 1)) == 0) && (0 < _CAPACITY_) && (_CAPACITY_ <= 128)) ? 1 : -1];
+
+public:
+
+	/**
+	 * Constructor.
+	 */
+	explicit Ring()
+	: head(0)
+	, tail(0)
+	{}
+
+	/**
+	 * Return the number of elements the Ring can hold.
+	 * @return the number of elements the Ring can hold.
+	 */
+	uint8_t capacity() const { return _CAPACITY_; }
+
+	/**
+	 * Return the number of elements currently in the Ring.
+	 * @return the number of elements currently in the Ring.
+	 */
+	uint8_t available() const { return static_cast<uint8_t>(head - tail); }
+
+	/**
+	 * Return true if the Ring is empty.
+	 * @return true if the Ring is empty, false otherwise.
+	 */
+	bool empty() const { return (head == tail); }
+
+	/**
+	 * Return true if the Ring is full.
+	 * @return true if the Ring is full, false otherwise.
+	 */
+	bool full() const { return (static_cast<uint8_t>(head - tail) >= _CAPACITY_); }
+
+	/**
+	 * Append an element to the Ring. Only the producer may call this.
+	 * @param datum points to the element to append.
+	 * @param wasempty is returned true if the Ring was empty beforehand,
+	 * which is when a waiting consumer would need to be woken.
+	 * @return true if the element was appended, false if the Ring was full.
+	 */
+	bool put(const _TYPE_ * datum, bool & wasempty = unused.b) {
+		uint8_t here = head;
+		uint8_t there = tail;
+		wasempty = (here == there);
+		if (static_cast<uint8_t>(here - there) >= _CAPACITY_) {
+			return false;
+		}
+		buffer[here & (_CAPACITY_ - 1)] = *datum;
+		barrier();
+		head = here + 1;
+		return true;
+	}
+
+	/**
+	 * Append as many elements as will fit to the Ring. Only the producer may
+	 * call this.
+	 * @param data points to the elements to append.
+	 * @param count is the number of elements to append.
+	 * @param wasempty is returned true if the Ring was empty beforehand.
+	 * @return the number of elements appended.
+	 */
+	uint8_t put(const _TYPE_ * data, uint8_t count, bool & wasempty = unused.b) {
+		uint8_t here = head;
+		uint8_t there = tail;
+		uint8_t room = _CAPACITY_ - static_cast<uint8_t>(here - there);
+		wasempty = (here == there);
+		if (count > room) {
+			count = room;
+		}
+		for (uint8_t ii = 0; ii < count; ++ii) {
+			buffer[(here + ii) & (_CAPACITY_ - 1)] = data[ii];
+		}
+		barrier();
+		head = here + count;
+		return count;
+	}
+
+	/**
+	 * Remove the first element from the Ring. Only the consumer may call this.
+	 * @param datum points to where the element is stored.
+	 * @param wasfull is returned true if the Ring was full beforehand, which
+	 * is when a waiting producer would need to be woken.
+	 * @return true if an element was removed, false if the Ring was empty.
+	 */
+	bool get(_TYPE_ * datum, bool & wasfull = unused.b) {
+		uint8_t here = head;
+		uint8_t there = tail;
+		wasfull = (static_cast<uint8_t>(here - there) >= _CAPACITY_);
+		if (here == there) {
+			return false;
+		}
+		*datum = buffer[there & (_CAPACITY_ - 1)];
+		barrier();
+		tail = there + 1;
+		return true;
+	}
+
+	/**
+	 * Remove as many elements as are available, up to a limit, from the Ring.
+	 * Only the consumer may call this.
+	 * @param data points to where the elements are stored.
+	 * @param count is the maximum number of elements to remove.
+	 * @param wasfull is returned true if the Ring was full beforehand.
+	 * @return the number of elements removed.
+	 */
+	uint8_t get(_TYPE_ * data, uint8_t count, bool & wasfull = unused.b) {
+		uint8_t here = head;
+		uint8_t there = tail;
+		uint8_t have = static_cast<uint8_t>(here - there);
+		wasfull = (have >= _CAPACITY_);
+		if (count > have) {
+			count = have;
+		}
+		for (uint8_t ii = 0; ii < count; ++ii) {
+			data[ii] = buffer[(there + ii) & (_CAPACITY_ - 1)];
+		}
+		barrier();
+		tail = there + count;
+		return count;
+	}
+
+	/**
+	 * Copy the first element of the Ring without removing it. Only the
+	 * consumer may call this.
+	 * @param datum points to where the element is stored.
+	 * @return true if an element was copied, false if the Ring was empty.
+	 */
+	bool peek(_TYPE_ * datum) const {
+		uint8_t there = tail;
+		if (head == there) {
+			return false;
+		}
+		*datum = buffer[there & (_CAPACITY_ - 1)];
+		return true;
+	}
+
+	/**
+	 * Discard every element in the Ring. Only the consumer may call this.
+	 */
+	void clear() { tail = head; }
+
+protected:
+
+	/**
+	 * Keep the compiler from moving accesses to the buffer across the update
+	 * of an index. The megaAVR itself doesn't reorder memory accesses.
+	 */
+	static void barrier() { __asm__ __volatile__ ("" : : : "memory"); }
+
+	_TYPE_ buffer[_CAPACITY_];
+	volatile uint8_t head;
+	volatile uint8_t tail;
+
+};
+
+/**
+ * RingQueue is a Ring with the same element API as a TypedQueue for the
+ * common device driver case of an interrupt service routine on one side and
+ * a single task on the other, so a driver can use it in place of a
+ * TypedQueue. The ISR side never makes a FreeRTOS call except to wake the
+ * task, and it only does that when the Ring goes from empty to non-empty (if
+ * the task is the consumer) or from full to non-full (if the task is the
+ * producer), rather than for every element.
+ */
+template <typename _TYPE_, uint8_t _CAPACITY_>
+class RingQueue
+: public Ring<_TYPE_, _CAPACITY_>
+{
+
+public:
+
+	/**
+	 * Constructor.
+	 */
+	explicit RingQueue() {
+		// FreeRTOS binary semaphores are created full.
+		ready.take(IMMEDIATELY);
+	}
+
+	/**
+	 * Returns true if the construction of the RingQueue was successful.
+	 * @return true if successful, false otherwise.
+	 */
+	operator bool() const { return ready; }
+
+	/**
+	 * Return true if the RingQueue is empty. Since a Ring needs no critical
+	 * section this is the same as empty(); it exists so that a RingQueue can
+	 * replace a TypedQueue in an ISR.
+	 * @return true if the RingQueue is empty, false otherwise.
+	 */
+	bool isEmptyFromISR() const { return this->empty(); }
+
+	/**
+	 * Return true if the RingQueue is full. This is the same as full().
+	 * @return true if the RingQueue is full, false otherwise.
+	 */
+	bool isFullFromISR() const { return this->full(); }
+
+	/**
+	 * Return the number of elements in the RingQueue. This is the same as
+	 * available().
+	 * @return the number of elements in the RingQueue.
+	 */
+	size_t availableFromISR() const { return this->available(); }
+
+	/**
+	 * Copy the first element without removing it, waiting if the RingQueue
+	 * is empty. Only a consuming task may call this.
+	 * @param buffer points to where the element is stored.
+	 * @param timeout is the duration in ticks to wait if it is empty.
+	 * @return true if an element was copied, false otherwise.
+	 */
+	bool peek(_TYPE_ * buffer, ticks_t timeout = IMMEDIATELY) {
+		while (!Ring<_TYPE_, _CAPACITY_>::peek(buffer)) {
+			if (!ready.take(timeout)) {
+				return Ring<_TYPE_, _CAPACITY_>::peek(buffer);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Remove the first element, waiting if the RingQueue is empty. Only a
+	 * consuming task may call this.
+	 * @param buffer points to where the element is stored.
+	 * @param timeout is the duration in ticks to wait if it is empty.
+	 * @return true if an element was removed, false otherwise.
+	 */
+	bool receive(_TYPE_ * buffer, ticks_t timeout = NEVER) {
+		while (!this->get(buffer)) {
+			if (!ready.take(timeout)) {
+				return this->get(buffer);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Remove the first element without waiting and wake the producing task
+	 * if the RingQueue was full. Only a consuming ISR may call this.
+	 * @param buffer points to where the element is stored.
+	 * @param woken is returned true if this woke a higher priority task.
+	 * @return true if an element was removed, false otherwise.
+	 */
+	bool receiveFromISR(_TYPE_ * buffer, bool & woken = unused.b) {
+		bool wasfull;
+		bool result = this->get(buffer, wasfull);
+		woken = false;
+		if (result && wasfull) {
+			ready.giveFromISR(woken);
+		}
+		return result;
+	}
+
+	/**
+	 * Append an element, waiting if the RingQueue is full. Only a producing
+	 * task may call this.
+	 * @param datum points to the element to append.
+	 * @param timeout is the duration in ticks to wait if it is full.
+	 * @return true if the element was appended, false otherwise.
+	 */
+	bool send(const _TYPE_ * datum, ticks_t timeout = NEVER) {
+		while (!this->put(datum)) {
+			if (!ready.take(timeout)) {
+				return this->put(datum);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Append an element without waiting and wake the consuming task if the
+	 * RingQueue was empty. Only a producing ISR may call this.
+	 * @param datum points to the element to append.
+	 * @param woken is returned true if this woke a higher priority task.
+	 * @return true if the element was appended, false otherwise.
+	 */
+	bool sendFromISR(const _TYPE_ * datum, bool & woken = unused.b) {
+		bool wasempty;
+		bool result = this->put(datum, wasempty);
+		woken = false;
+		if (result && wasempty) {
+			ready.giveFromISR(woken);
+		}
+		return result;
+	}
+
+protected:
+
+	BinarySemaphore ready;
+
+};
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_RING_H_ */
@@ -49,6 +49,23 @@ public:
 	 */
 	virtual size_t write(uint8_t ch);
 
+	/**
+	 * Implement the Sink bulk write method for the Serial object.
+	 * @param datum points to a contiguous sequence of bytes to write.
+	 * @param size is the number of bytes to write.
+	 * @return the number of bytes written or zero for fail.
+	 */
+	virtual size_t write(const void * datum, size_t size);
+
+	/**
+	 * Implement the Sink bulk program space write method for the Serial
+	 * object.
+	 * @param datum points to a contiguous sequence of bytes to write.
+	 * @param size is the number of bytes to write.
+	 * @return the number of bytes written or zero for fail.
+	 */
+	virtual size_t write_P(PGM_VOID_P datum, size_t size);
+
 	/**
 	 * Implement the Sink flush method for the Serial object.
 	 */
@@ -56,6 +73,8 @@ public:
 
 	using Sink::write;
 
+	using Sink::write_P;
+
 protected:
 
 	Serial * serial;
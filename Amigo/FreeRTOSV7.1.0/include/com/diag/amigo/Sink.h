@@ -20,7 +20,10 @@ namespace amigo {
  * Sink is a partly abstract type that can consume data a character at a time.
  * The deriving class defines write(uint8_t) and flush() operations. Sink
  * defines write(const void *, size_t) and write(const char *) operations on
- * top of those provided by the deriving class.
+ * top of those provided by the deriving class. A deriving class that can
+ * consume a buffer more cheaply than a character at a time may also override
+ * write(const void *, size_t) and write_P(PGM_VOID_P, size_t), which the
+ * C string operations use.
  */
 class Sink
 {
@@ -57,7 +60,7 @@ public:
 	 * @param size is the number of bytes to write.
 	 * @return the number of bytes written or zero for fail.
 	 */
-    size_t write(const void * datum, size_t size);
+    virtual size_t write(const void * datum, size_t size);
 
 	/**
 	 * Write a sequence of contiguous bytes of a specified length from program
@@ -66,7 +69,7 @@ public:
 	 * @param size is the number of bytes to write.
 	 * @return the number of bytes written or zero for fail.
 	 */
-    size_t write_P(PGM_VOID_P datum, size_t size);
+    virtual size_t write_P(PGM_VOID_P datum, size_t size);
 
     /**
      * Write a nul-terminated C string from data space to the underlying
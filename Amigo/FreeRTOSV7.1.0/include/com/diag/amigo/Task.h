@@ -13,6 +13,7 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "com/diag/amigo/types.h"
+#include "com/diag/amigo/Sink.h"
 
 namespace com {
 namespace diag {
@@ -38,6 +39,22 @@ public:
 	 */
 	typedef uint8_t priority_t;
 
+	/**
+	 * This is a snapshot of the state of the heap: the number of free bytes
+	 * and the fewest there have ever been, the size of the largest free block
+	 * and the number of free blocks, and the numbers of allocations, frees and
+	 * failed allocations.
+	 */
+	typedef xHeapStatistics HeapStatistics;
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+	/**
+	 * This is the number of ticks of the run time counter that a task has
+	 * accumulated while it was running, along with its handle and name.
+	 */
+	typedef xTaskRunTime RunTime;
+#endif
+
 	/**
 	 * This is the default stack depth for a Task. As stated in the FreeRTOS
 	 * documentation, this is in units of the fundamental stack cell type,
@@ -318,6 +335,14 @@ public:
 	 */
 	static size_t heap();
 
+	/**
+	 * Take a snapshot of the state of the heap. If a request for fewer bytes
+	 * than are free fails, the largest free block will show that the heap is
+	 * fragmented.
+	 * @param statistics refers to where the snapshot is stored.
+	 */
+	static void heap(HeapStatistics & statistics);
+
 	/**
 	 * Return an estimate of the high water mark of stack usage for the calling
 	 * task as the smallest number of unused bytes in the stack seen when the
@@ -334,6 +359,55 @@ public:
 	 */
 	size_t stack();
 
+#if (configGENERATE_RUN_TIME_STATS == 1)
+
+	/**
+	 * Return the value of the free running run time counter. This is the
+	 * total of the run times of all tasks, living or dead, including the
+	 * idle task. The counter ticks COM_DIAG_AMIGO_RUNTIME_HZ times a second
+	 * and wraps around.
+	 * @return the value of the run time counter.
+	 */
+	static unsigned long cpuTotal();
+
+	/**
+	 * Return the accumulated run time of the calling task in run time counter
+	 * ticks.
+	 * @return the accumulated run time of the calling task.
+	 */
+	static unsigned long cpuSelf();
+
+	/**
+	 * Return the accumulated run time of this task in run time counter ticks.
+	 * @return the accumulated run time of this task or zero if it has not
+	 * been started.
+	 */
+	unsigned long cpu();
+
+	/**
+	 * Take a snapshot of the accumulated run times of up to size tasks.
+	 * @param runtimes points to an array of RunTime structures.
+	 * @param size is the number of structures in the array.
+	 * @return the number of structures filled in.
+	 */
+	static size_t cpu(RunTime * runtimes, size_t size);
+
+	/**
+	 * Print a table of the accumulated run times of up to RUNTIMES tasks, and
+	 * the percentage of the total run time each represents, to a Sink.
+	 * @param sink refers to the Sink.
+	 * @return the number of tasks printed.
+	 */
+	static size_t cpu(Sink & sink);
+
+	/**
+	 * This is the maximum number of tasks printed by cpu(Sink &). The RunTime
+	 * array used to take the snapshot is on the stack of the calling task.
+	 */
+	static const size_t RUNTIMES = 8;
+
+#endif
+
 	/***************************************************************************
 	 * IDENTIFYING
 	 **************************************************************************/
@@ -489,6 +563,30 @@ inline size_t Task::heap() {
 	return xPortGetFreeHeapSize();
 }
 
+inline void Task::heap(HeapStatistics & statistics) {
+	vPortGetHeapStatistics(&statistics);
+}
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+
+inline unsigned long Task::cpuTotal() {
+	return portGET_RUN_TIME_COUNTER_VALUE();
+}
+
+inline unsigned long Task::cpuSelf() {
+	return ulTaskGetRunTimeCounter(NULL);
+}
+
+inline unsigned long Task::cpu() {
+	return (handle != 0) ? ulTaskGetRunTimeCounter(handle) : 0;
+}
+
+inline size_t Task::cpu(RunTime * runtimes, size_t size) {
+	return uxTaskGetRunTimeCounters(runtimes, size);
+}
+
+#endif
+
 }
 }
 }
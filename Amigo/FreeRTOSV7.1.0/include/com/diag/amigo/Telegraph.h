@@ -0,0 +1,148 @@
+#ifndef _COM_DIAG_AMIGO_TELEGRAPH_H_
+#define _COM_DIAG_AMIGO_TELEGRAPH_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/Timer.h"
+#include "com/diag/amigo/Task.h"
+#include "com/diag/amigo/Ring.h"
+#include "com/diag/amigo/target/GPIO.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * Telegraph plays on/off patterns, like Morse code or blink codes, on a GPIO
+ * pin without making the caller wait. A pattern is a sequence of elements,
+ * each of which turns the pin on or off for some number of units, and it is
+ * appended to a Ring from which a periodic Timer whose period is one unit
+ * consumes it. The application returns as soon as the pattern is queued. The
+ * timing is only as good as the FreeRTOS tick, but it doesn't accumulate error
+ * since every element is a whole number of timer periods. Alternatively the
+ * Timer can be left stopped and tick() called once per unit by a hardware
+ * timer interrupt service routine. When neither is possible, for example
+ * because interrupts are disabled on the way to a fatal error, drain() plays
+ * whatever is queued by busy waiting, like Morse does. Only one task may
+ * queue patterns.
+ *
+ * A Morse string uses the same characters as Morse, with traditional timing:
+ *
+ * A dot ('.') is on for one unit.\n
+ * A dash ('-') is on for three units.\n
+ * An implicit pause after a dot or dash is off for one unit.\n
+ * A pause (',') between letters is off for three units.\n
+ * A pause (' ') between words is off for seven units.\n
+ */
+class Telegraph
+: public Timer
+{
+
+public:
+
+	/**
+	 * This bit in an element turns the pin on; without it the pin is off.
+	 */
+	static const uint8_t ON = 0x80;
+
+	/**
+	 * These bits in an element are the number of units it lasts, from one to
+	 * 127.
+	 */
+	static const uint8_t UNITS = 0x7f;
+
+	/**
+	 * This is the number of elements that can be queued.
+	 */
+	static const uint8_t CAPACITY = 64;
+
+	/**
+	 * Constructor. The Timer must be started before anything is played,
+	 * unless tick() is to be called instead.
+	 * @param pin is the GPIO pin to play the patterns on.
+	 * @param unit is the duration of a unit, for Morse a dot, in ticks.
+	 */
+	explicit Telegraph(GPIO::Pin pin, ticks_t unit = Task::milliseconds2ticks(125));
+
+	/**
+	 * Destructor. The Timer must be stopped first.
+	 */
+	virtual ~Telegraph();
+
+	/**
+	 * Queue a pattern of elements.
+	 * @param elements points to the elements.
+	 * @param count is the number of elements.
+	 * @return the number of elements queued, which is less than the count if
+	 * the queue filled up.
+	 */
+	size_t blink(const uint8_t * elements, size_t count);
+
+	/**
+	 * Queue a Morse string.
+	 * @param code points to the Morse string.
+	 * @return true if all of it was queued, false if the queue filled up.
+	 */
+	bool morse(const char * code);
+
+	/**
+	 * Return true if nothing is queued or playing.
+	 * @return true if idle, false otherwise.
+	 */
+	bool idle() const { return (ring.empty() && (remaining == 0)); }
+
+	/**
+	 * Advance the pattern by one unit. This is called by the Timer, but can
+	 * also be called by an interrupt service routine instead.
+	 */
+	void tick();
+
+	/**
+	 * Play everything queued by busy waiting, then return. This is for when
+	 * the Timer can't run; if it is running, it must be stopped first.
+	 */
+	void drain();
+
+protected:
+
+	GPIO gpio;
+	ticks_t unit;
+	Ring<uint8_t, CAPACITY> ring;
+	uint8_t mask;
+	volatile uint8_t remaining;
+
+	/**
+	 * Call tick() once per period.
+	 */
+	virtual void timer();
+
+private:
+
+    /**
+     *  Copy constructor. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Telegraph(const Telegraph & that);
+
+    /**
+     *  Assignment operator. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Telegraph & operator=(const Telegraph& that);
+
+};
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_TELEGRAPH_H_ */
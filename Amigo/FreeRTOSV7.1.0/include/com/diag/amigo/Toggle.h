@@ -91,6 +91,58 @@ private:
 
 };
 
+/**
+ * FastToggleOff is a ToggleOff for a single GPIO pin known at compile time. It
+ * uses a FastPin, so on the megaAVR the constructor and destructor are each
+ * typically a single CBI or SBI instruction.
+ */
+template <GPIO::Pin _PIN_>
+class FastToggleOff {
+
+public:
+
+	/**
+	 * Constructor. The pin is cleared.
+	 */
+	FastToggleOff() {
+		FastPin<_PIN_>::clear(); /* Active low. */
+	}
+
+	/**
+	 * Destructor. The pin is set.
+	 */
+	~FastToggleOff() {
+		FastPin<_PIN_>::set(); /* Active low. */
+	}
+
+};
+
+/**
+ * FastToggleOn is a ToggleOn for a single GPIO pin known at compile time. It
+ * uses a FastPin, so on the megaAVR the constructor and destructor are each
+ * typically a single SBI or CBI instruction.
+ */
+template <GPIO::Pin _PIN_>
+class FastToggleOn {
+
+public:
+
+	/**
+	 * Constructor. The pin is set.
+	 */
+	FastToggleOn() {
+		FastPin<_PIN_>::set();
+	}
+
+	/**
+	 * Destructor. The pin is cleared.
+	 */
+	~FastToggleOn() {
+		FastPin<_PIN_>::clear();
+	}
+
+};
+
 }
 }
 }
@@ -0,0 +1,118 @@
+#ifndef _COM_DIAG_AMIGO_W5100_DISPATCHER_H_
+#define _COM_DIAG_AMIGO_W5100_DISPATCHER_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/Task.h"
+#include "com/diag/amigo/BinarySemaphore.h"
+#include "com/diag/amigo/W5100/W5100.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+namespace W5100 {
+
+/**
+ * Dispatcher is a Task that is woken by the W5100 /INT output, collects the
+ * pending socket events from the W5100 in a single pass, and gives a
+ * BinarySemaphore for each socket that had an event (CON, DISCON, RECV,
+ * TIMEOUT or SEND_OK). Socket blocks on these semaphores instead of
+ * repeatedly polling the W5100 over the SPI bus. The /INT output must be
+ * jumpered to Arduino digital pin 2, which is external interrupt INT4 (PE4)
+ * on the ATmega2560 and INT0 (PD2) on the ATmega328P. The W5100 /INT output
+ * is level sensitive, so the interrupt is masked by the interrupt service
+ * routine and unmasked by the task once it has cleared the events in the
+ * W5100. The interrupt service routine is only compiled in when
+ * COM_DIAG_AMIGO_W5100_DISPATCHER_USES_ISR is defined, so that applications
+ * that don't use the Dispatcher keep the external interrupt vector; without
+ * it the task instead polls the W5100 once every PATIENCE ticks. The W5100
+ * object must have been constructed with a MutexSemaphore, since both this
+ * task and the application tasks use it. Only one Dispatcher should be
+ * instantiated.
+ */
+class Dispatcher
+: public Task
+{
+
+public:
+
+	/**
+	 * This is how long in ticks the task waits for an interrupt before
+	 * checking whether it has been asked to stop.
+	 */
+	static const ticks_t PATIENCE = 100 /* milliseconds */ / Task::PERIOD;
+
+	/**
+	 * Constructor.
+	 * @param myw5100 refers to the object controlling the W5100 chip.
+	 * @param myname is a C-string that names the task.
+	 */
+	explicit Dispatcher(W5100 & myw5100, const char * myname = "W5100");
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~Dispatcher();
+
+	/**
+	 * Wait for the next event on the specified socket.
+	 * @param socket identifies the socket.
+	 * @param timeout is the duration in ticks to wait.
+	 * @return true if an event occurred, false if timed out.
+	 */
+	bool wait(W5100::socket_t socket, ticks_t timeout = NEVER) { return events[socket].take(timeout); }
+
+	/**
+	 * Return the number of times the interrupt service routine has run. This
+	 * is useful for verifying that /INT is wired correctly.
+	 * @return the number of interrupts.
+	 */
+	uint16_t interrupts() const { return count; }
+
+	/**
+	 * Handle an interrupt on the /INT line. This is called by the interrupt
+	 * service routine. It must be public so that it can be called by the
+	 * ISR which has C-linkage. It is not part of the public API and you
+	 * should never call it.
+	 */
+	static void interrupt();
+
+protected:
+
+	virtual void task();
+
+	W5100 * w5100;
+	BinarySemaphore asserted;
+	BinarySemaphore events[W5100::SOCKETS];
+	volatile uint16_t count;
+
+private:
+
+    /**
+     *  Copy constructor. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Dispatcher(const Dispatcher& that);
+
+    /**
+     *  Assignment operator. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	Dispatcher& operator=(const Dispatcher& that);
+
+};
+
+}
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_W5100_DISPATCHER_H_ */
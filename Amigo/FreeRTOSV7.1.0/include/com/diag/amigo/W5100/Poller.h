@@ -0,0 +1,59 @@
+#ifndef _COM_DIAG_AMIGO_W5100_POLLER_H_
+#define _COM_DIAG_AMIGO_W5100_POLLER_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/Timer.h"
+#include "com/diag/amigo/W5100/Socket.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+namespace W5100 {
+
+/**
+ * Poller is a PeriodicTimer that checks all W5100 Sockets for the completion
+ * of asynchronous sends started with Socket::post(), so that no application
+ * task has to spin on the W5100 waiting for SEND_OK. It runs in the context
+ * of the FreeRTOS timer task, so the MutexSemaphores used by Socket and by
+ * W5100, if any, should not be held for long by other tasks. Its period is a
+ * trade-off between completion latency and SPI bandwidth.
+ */
+class Poller
+: public PeriodicTimer
+{
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param duration is the polling period in system ticks.
+	 * @param myname is a C-string that names the timer.
+	 */
+	explicit Poller(ticks_t duration, const char * myname = "W5100")
+	: PeriodicTimer(duration, myname)
+	{}
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~Poller();
+
+protected:
+
+	virtual void timer();
+
+};
+
+}
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_W5100_POLLER_H_ */
@@ -17,12 +17,17 @@
 #include "com/diag/amigo/Socket.h"
 #include "com/diag/amigo/W5100/W5100.h"
 #include "com/diag/amigo/MutexSemaphore.h"
+#include "com/diag/amigo/BinarySemaphore.h"
+#include "com/diag/amigo/Sink.h"
+#include "com/diag/amigo/Source.h"
 
 namespace com {
 namespace diag {
 namespace amigo {
 namespace W5100 {
 
+class Dispatcher;
+
 /**
  * Socket implements the Amigo Socket interface for the WizNET W5100 chip.
  * The W5100 provides not just the Ethernet physical (PHY) and Media Access
@@ -39,6 +44,13 @@ class Socket
 
 public:
 
+	/**
+	 * This is the size in bytes of the chunks in which the streaming send()
+	 * and recv() methods move data between the W5100 and a Source or Sink.
+	 * It is the only buffer they use, and it is on the stack.
+	 */
+	static const size_t CHUNK = 16;
+
 	/**
 	 * The underlying implementation optionally uses a MutexSemaphore to
 	 * serialize access to an internal database common to all objects of this
@@ -58,6 +70,31 @@ public:
 	 */
 	static void provide(MutexSemaphore & mymutex);
 
+	/**
+	 * The application may optionally provide a Dispatcher task that is woken
+	 * by the W5100 /INT output. If it does so, methods that would otherwise
+	 * poll the W5100 while they wait for a connection or for a send to
+	 * complete instead block until the Dispatcher reports an event on their
+	 * socket. This needs to be done at most once, if at all; subsequent calls
+	 * replace the prior Dispatcher. Providing NULL reverts to polling, which
+	 * must be done before the Dispatcher is destroyed.
+	 * @param mydispatcher points to a Dispatcher object or NULL for none.
+	 */
+	static void provide(Dispatcher * mydispatcher);
+
+	/**
+	 * Check every allocated socket once for the completion of an outstanding
+	 * asynchronous send started by post(), calling completed() on each one
+	 * that has finished. This never waits for the W5100 to finish anything,
+	 * nor for the Socket mutex or the W5100 mutex: if another task holds the
+	 * former, this poll is skipped, and if another task holds the latter, for
+	 * example during a bulk recv() into a Sink, the sockets on that W5100 are
+	 * checked on the next poll instead. It is intended to be called
+	 * periodically, for example by a Poller timer, instead of having the
+	 * sending task spin on the W5100.
+	 */
+	static void service();
+
 	/**
 	 * Constructor.
 	 * @param myw5100 refers to the object controlling the W5100 chip.
@@ -66,6 +103,8 @@ public:
 	explicit Socket(W5100 & myw5100, socket_t mysocket = NOSOCKET)
 	: com::diag::amigo::Socket(mysocket)
 	, w5100(&myw5100)
+	, completion(0)
+	, pending(0)
 	{}
 
 	/**
@@ -98,6 +137,82 @@ public:
 	 */
 	bool sendUDP();
 
+	/**
+	 * Send data read from a Source directly to the connected peer, streaming
+	 * it into the W5100 transmit buffer in small chunks so that no application
+	 * buffer is needed. Data is read from the Source until it has no more,
+	 * the length is reached, or the transmit buffer is full.
+	 * @param source refers to the Source from which data is read.
+	 * @param length is the maximum number of bytes to send.
+	 * @return the number of bytes sent, 0 if none, or <0 for error.
+	 */
+	ssize_t send(Source & source, size_t length);
+
+	/**
+	 * Receive data from the connected peer directly into a Sink, streaming it
+	 * out of the W5100 receive buffer in small chunks so that no application
+	 * buffer is needed. Only the data actually accepted by the Sink is
+	 * consumed from the W5100. The socket mutex is not held while writing to
+	 * the Sink, so a slow Sink does not stall other tasks using the W5100.
+	 * @param sink refers to the Sink to which data is written.
+	 * @param length is the maximum number of bytes to receive.
+	 * @return the number of bytes received, 0 for end of file, or <0 for
+	 * error or if no data is available.
+	 */
+	ssize_t recv(Sink & sink, size_t length);
+
+	/**
+	 * Start an asynchronous send of data to the connected peer (TCP) or to
+	 * the destination established by startUDP() (UDP). The data is copied
+	 * into the W5100 transmit buffer and the send command issued, but this
+	 * method returns without waiting for the W5100 to report that the send
+	 * completed. Completion is detected later by complete() or service(),
+	 * which calls completed(). Only one asynchronous send may be outstanding
+	 * on a socket at a time.
+	 * @param data points to the data to be sent.
+	 * @param length is the length of the data in bytes.
+	 * @param mycompletion points to a BinarySemaphore to be given when the
+	 * send completes, or NULL if none.
+	 * @return the number of bytes queued, 0 if a send is already outstanding,
+	 * the socket is not connected, or there is no room in the transmit
+	 * buffer, or <0 for error.
+	 */
+	ssize_t post(const void * data, size_t length, BinarySemaphore * mycompletion = 0);
+
+	/**
+	 * Check once, without waiting, for the completion of an outstanding
+	 * asynchronous send started by post(). If it has completed, the W5100
+	 * interrupt flags are cleared and completed() is called after the mutex
+	 * has been released.
+	 * @return true if no asynchronous send remains outstanding, false
+	 * otherwise.
+	 */
+	bool complete();
+
+	/**
+	 * Block the calling task until the Dispatcher reports an event (for
+	 * example, a connection, a disconnection, the arrival of data, or the
+	 * completion of a send) on this socket, or until the timeout expires.
+	 * If no Dispatcher has been provided, this simply delays for the timeout.
+	 * This can be used between calls to methods like recv(), which do not
+	 * block, to wait for data without polling the W5100.
+	 * @param timeout is the duration in ticks to wait.
+	 * @return true if the Dispatcher reported an event, false otherwise.
+	 */
+	bool wait(ticks_t timeout = NEVER);
+
+	/**
+	 * Return true if an asynchronous send is outstanding.
+	 * @return true if an asynchronous send is outstanding, false otherwise.
+	 */
+	bool posted() const { return (pending > 0); }
+
+	/**
+	 * Return the result of the most recently completed asynchronous send.
+	 * @return the number of bytes sent, or 0 if the send failed.
+	 */
+	ssize_t result() const { return (pending > 0) ? 0 : -pending; }
+
 	/*
 	 * See <com/diag/amigo/Socket.h> for descriptions of these methods.
 	 * (Doxygen automatically imports the comments from the base class.)
@@ -151,6 +266,50 @@ protected:
 
 	W5100 * w5100;
 
+	BinarySemaphore * completion;
+
+	/**
+	 * This is positive with the number of bytes of an outstanding
+	 * asynchronous send, or zero or negative with the negated number of bytes
+	 * of the most recently completed one.
+	 */
+	ssize_t pending;
+
+	/**
+	 * This is called when an asynchronous send completes, or is abandoned by
+	 * close(). It is called in the context of whatever task called
+	 * complete(), service(), or close(); when called from service() by a
+	 * Poller that is the FreeRTOS timer task, so it must not block or delay.
+	 * It is always called without the mutex held, so it may use this or any
+	 * other Socket. This base class implementation gives the BinarySemaphore
+	 * provided to post(), if any. A derived class may override it to
+	 * implement a callback.
+	 * @param sent is the number of bytes sent, or 0 if the send failed.
+	 */
+	virtual void completed(ssize_t sent);
+
+	/**
+	 * Check, with the mutex held, whether the outstanding asynchronous send
+	 * has completed and if so record its result, but do not call completed().
+	 * @return the number of bytes sent, 0 if the send failed, or -1 if it is
+	 * still outstanding.
+	 */
+	ssize_t check();
+
+	/**
+	 * Wait, without holding the mutex, for the W5100 to complete a send
+	 * command on this socket.
+	 * @return SnIR::SEND_OK if successful, SnIR::TIMEOUT if the send timed
+	 * out, or zero if the socket was closed.
+	 */
+	uint8_t sent();
+
+	/**
+	 * Give up the processor briefly while waiting on the W5100, until the
+	 * Dispatcher, if any, reports an event on this socket.
+	 */
+	void pause();
+
 	socket_t allocate(socket_t sock);
 
 	void deallocate(socket_t sock);
@@ -21,6 +21,16 @@
 #include "com/diag/amigo/MutexSemaphore.h"
 #include "com/diag/amigo/Task.h"
 
+// The W5100 Slave Select is on Arduino digital pin 10 on both the Arduino
+// Ethernet shield and the Freetronics boards. When the application uses that
+// pin, Slave Select is toggled with a FastPin instead of through GPIO.
+
+#if defined(__AVR_ATmega2560__)
+#	define COM_DIAG_AMIGO_W5100_SS_PIN com::diag::amigo::GPIO::PIN_B4
+#elif defined(__AVR_ATmega328P__)
+#	define COM_DIAG_AMIGO_W5100_SS_PIN com::diag::amigo::GPIO::PIN_B2
+#endif
+
 namespace com {
 namespace diag {
 namespace amigo {
@@ -80,17 +90,31 @@ public:
 	static const size_t SOCKETS = 4;
 
 	/**
-	 * This is the size of an individual transmit buffer for a socket. Packets
-	 * larger than this cannot be sent.
+	 * This is the total amount of buffer memory the W5100 has for transmitting,
+	 * shared among all sockets. The same amount is available for receiving.
+	 */
+	static const size_t MEMORY = 8192;
+
+	/**
+	 * This is the default size of an individual transmit buffer for a socket.
+	 * Packets larger than the transmit buffer cannot be sent. The actual size
+	 * for each socket can be changed with configure().
 	 */
 	static const size_t SSIZE = 2048;
 
 	/**
-	 * This is the size of an individual receive buffer for a socket. Packets
-	 * larger than this cannot be received.
+	 * This is the default size of an individual receive buffer for a socket.
+	 * Packets larger than the receive buffer cannot be received. The actual
+	 * size for each socket can be changed with configure().
 	 */
 	static const size_t RSIZE = 2048;
 
+	/**
+	 * This is the default value for the W5100 Transmit and Receive Memory Size
+	 * registers, which gives 2KB to each of the four sockets.
+	 */
+	static const uint8_t MSR = 0x55;
+
 	/***************************************************************************
 	 * CONSTRUCTING AND DESTRUCTING
 	 **************************************************************************/
@@ -128,8 +152,10 @@ public:
 	/**
 	 * Start the W5100.
 	 * @param resetting is the number of ticks to delay following a reset.
+	 * @param tmsr is the transmit memory layout (see configure()).
+	 * @param rmsr is the receive memory layout (see configure()).
 	 */
-	void start(ticks_t resetting = RESETTING);
+	void start(ticks_t resetting = RESETTING, uint8_t tmsr = MSR, uint8_t rmsr = MSR);
 
 	/**
 	 * Stop the W5100.
@@ -214,10 +240,6 @@ private:
 
 	static const uint8_t RST = 7; // Reset BIT
 
-	static const uint16_t SMASK = SSIZE - 1; // Tx buffer mask
-
-	static const uint16_t RMASK = RSIZE - 1; // Rx buffer mask
-
 	static const uint16_t TX_BUF = 0x1100;
 
 	static const uint16_t RX_BUF = (TX_BUF + SSIZE);
@@ -232,22 +254,75 @@ private:
 
 	void initialize();
 
+	static void layout(uint8_t msr, address_t origin, address_t * base, uint16_t * size);
+
 	/***************************************************************************
 	 * GENERAL PURPOSE REGISTER OPERATING
 	 **************************************************************************/
 
 private:
 
-	void write(address_t address, uint8_t datum);
+	static const uint8_t OP_WRITE = 0xf0;
 
-	void write(address_t address, const void * data, size_t length);
+	static const uint8_t OP_READ = 0x0f;
 
-	uint8_t read(address_t address);
+	/**
+	 * Perform a single four-byte SPI frame with Slave Select asserted around
+	 * it. The W5100 has no SPI burst mode (unlike its W5200 and W5500
+	 * successors), so every byte of W5100 memory read or written, even in
+	 * bulk, is its own frame. The caller is responsible for holding the
+	 * mutex. A failed SPI transfer is counted in errors().
+	 * @param opcode is OP_WRITE or OP_READ.
+	 * @param address is the W5100 memory address.
+	 * @param datum is the byte to write (ignored when reading).
+	 * @return the byte read (meaningless when writing), or <0 if the SPI
+	 * transfer failed.
+	 */
+	int frame(uint8_t opcode, address_t address, uint8_t datum = 0);
+
+	/**
+	 * Assert Slave Select.
+	 */
+	void select();
+
+	/**
+	 * Deassert Slave Select.
+	 */
+	void deselect();
+
+	bool write(address_t address, uint8_t datum);
 
-	void read(address_t address, void * buffer, size_t length);
+	/**
+	 * Read a single byte of W5100 memory.
+	 * @param address is the W5100 memory address.
+	 * @return the byte read, or zero if the SPI transfer failed.
+	 */
+	uint8_t read(address_t address);
 
 protected:
 
+	/**
+	 * Write a buffer into contiguous W5100 memory. The mutex is taken once
+	 * for the entire buffer, but each byte is still a frame(). The write
+	 * stops at the first failed SPI transfer.
+	 * @param address is the starting W5100 memory address.
+	 * @param data points to the data to be written.
+	 * @param length is the length of the data in bytes.
+	 * @return true if successful, false otherwise.
+	 */
+	bool write(address_t address, const void * data, size_t length);
+
+	/**
+	 * Read a buffer from contiguous W5100 memory. The mutex is taken once
+	 * for the entire buffer, but each byte is still a frame(). The read
+	 * stops at the first failed SPI transfer.
+	 * @param address is the starting W5100 memory address.
+	 * @param buffer points to the buffer into which data is read.
+	 * @param length is the length of the buffer in bytes.
+	 * @return true if successful, false otherwise.
+	 */
+	bool read(address_t address, void * buffer, size_t length);
+
 #define COM_DIAG_AMIGO_W5100_GP_8(_NAME_, _ADDRESS_)			\
 	void write##_NAME_(uint8_t datum) {							\
 		write(_ADDRESS_, datum);								\
@@ -443,16 +518,18 @@ public:
 	 * @param address specifies the W5100 memory address at which to start.
 	 * @param buffer points to a buffer in which to store data.
 	 * @param length is the length of the buffer in bytes.
+	 * @return true if successful, false if an SPI transfer failed.
 	 */
-	void read_data(socket_t socket, address_t address, void * buffer, size_t length);
+	bool read_data(socket_t socket, address_t address, void * buffer, size_t length);
 
 	/**
 	 * Send data to a W5100 socket at zero bytes displacement.
 	 * @param socket identifies the socket.
 	 * @param data points to the data to be sent.
 	 * @param length is the length of the data in bytes.
+	 * @return true if successful, false if an SPI transfer failed.
 	 */
-	void send_data_processing(socket_t socket, const void * data, size_t length) { send_data_processing_offset(socket, 0, data, length); }
+	bool send_data_processing(socket_t socket, const void * data, size_t length) { return send_data_processing_offset(socket, 0, data, length); }
 
 	/**
 	 * Send data to a W5100 socket at a specified byte displacement.
@@ -460,8 +537,10 @@ public:
 	 * @param displacement specifies a byte offset.
 	 * @param data points to the data to be sent.
 	 * @param length is the length of the data in bytes.
+	 * @return true if successful, false if an SPI transfer failed, in which
+	 * case the transmit write pointer is not advanced.
 	 */
-	void send_data_processing_offset(socket_t socket, size_t displacement, const void * data, size_t length);
+	bool send_data_processing_offset(socket_t socket, size_t displacement, const void * data, size_t length);
 
 	/**
 	 * Receive data from a W5100 socket.
@@ -469,8 +548,10 @@ public:
 	 * @param buffer points to a buffer into which the data is stored.
 	 * @param length is the length of the buffer in bytes.
 	 * @param peek is true indicates not to consume the data from the W5100.
+	 * @return true if successful, false if an SPI transfer failed, in which
+	 * case the receive read pointer is not advanced.
 	 */
-	void recv_data_processing(socket_t socket, void * buffer, size_t length, bool peek = false);
+	bool recv_data_processing(socket_t socket, void * buffer, size_t length, bool peek = false);
 
 	/**
 	 * Execute a W5100 socket command.
@@ -493,6 +574,122 @@ public:
 	 */
 	size_t getRXReceivedSize(socket_t socket);
 
+	/***************************************************************************
+	 * CONFIGURING MEMORY
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Encode per-socket buffer sizes into a value for the W5100 Transmit or
+	 * Receive Memory Size register. Each size must be 1024, 2048, 4096 or
+	 * 8192 bytes; other values are rounded down to one of these, with a
+	 * minimum of 1024. The W5100 allocates its 8KB to the sockets in order;
+	 * any socket whose buffer does not fit in what remains gets less, or
+	 * nothing at all.
+	 * @param size0 is the buffer size in bytes for socket 0.
+	 * @param size1 is the buffer size in bytes for socket 1.
+	 * @param size2 is the buffer size in bytes for socket 2.
+	 * @param size3 is the buffer size in bytes for socket 3.
+	 * @return a memory size register value.
+	 */
+	static uint8_t msr(size_t size0, size_t size1 = 0, size_t size2 = 0, size_t size3 = 0);
+
+	/**
+	 * Change how the W5100 buffer memory is divided among the sockets. Any
+	 * data in the buffers is lost, so this should only be done when all the
+	 * sockets are closed.
+	 * @param tmsr is the transmit memory layout, for example from msr().
+	 * @param rmsr is the receive memory layout, for example from msr().
+	 */
+	void configure(uint8_t tmsr, uint8_t rmsr);
+
+	/**
+	 * Return the size of the transmit buffer of a socket.
+	 * @param socket identifies the socket.
+	 * @return the size of the transmit buffer in bytes.
+	 */
+	size_t txsize(socket_t socket) const { return ssize[socket]; }
+
+	/**
+	 * Return the size of the receive buffer of a socket.
+	 * @param socket identifies the socket.
+	 * @return the size of the receive buffer in bytes.
+	 */
+	size_t rxsize(socket_t socket) const { return rsize[socket]; }
+
+	/***************************************************************************
+	 * INTERRUPTING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Enable the W5100 to assert its /INT output for events on the specified
+	 * sockets. Socket N is enabled by bit N in the mask.
+	 * @param sockets is a mask of the sockets to enable, or zero for none.
+	 */
+	void enable(uint8_t sockets = (1 << SOCKETS) - 1) { writeIMR(sockets & ((1 << SOCKETS) - 1)); }
+
+	/**
+	 * Read the W5100 interrupt register, and for each socket that has an
+	 * event pending, latch its socket interrupt register into memory and clear
+	 * it on the W5100, deasserting /INT. This is normally called only by the
+	 * W5100 Dispatcher task.
+	 * @return a mask of the sockets that had events pending.
+	 */
+	uint8_t collect();
+
+	/**
+	 * Return the events (SnIR bits) pending for a socket, whether they are
+	 * still in the W5100 or were already latched by collect().
+	 * @param socket identifies the socket.
+	 * @return the events pending for the socket.
+	 */
+	uint8_t events(socket_t socket);
+
+	/**
+	 * Acknowledge events (SnIR bits) for a socket, clearing them both in the
+	 * W5100 and in the latch.
+	 * @param socket identifies the socket.
+	 * @param acknowledged is a mask of the events to clear.
+	 */
+	void acknowledge(socket_t socket, uint8_t acknowledged);
+
+	/***************************************************************************
+	 * LOCKING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Take the mutex that serializes access to the W5100, if there is one,
+	 * so that a caller which must not block can find out beforehand whether
+	 * another task is using the W5100. The mutex is recursive, so the methods
+	 * of this object may be called while it is held.
+	 * @param timeout is the number of ticks to wait for the mutex.
+	 * @return true if the mutex was taken or there is none, false otherwise.
+	 */
+	bool take(ticks_t timeout = NEVER) { return (mutex == 0) || mutex->take(timeout); }
+
+	/**
+	 * Give the mutex taken by a successful take().
+	 */
+	void give() { if (mutex != 0) { mutex->give(); } }
+
+	/***************************************************************************
+	 * ERRORS
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Return the number of SPI frames that have failed, for example because
+	 * the SPI transfer timed out. This saturates rather than wrapping.
+	 * @return the number of failed SPI frames.
+	 */
+	uint8_t errors() const { return failures; }
+
 	/***************************************************************************
 	 * ANCILLARY STUFF
 	 **************************************************************************/
@@ -503,8 +700,13 @@ protected:
 	SPI * spi;
 	GPIO gpio;
 	uint8_t mask;
+	bool fast; // Slave Select is COM_DIAG_AMIGO_W5100_SS_PIN
 	address_t sbase[SOCKETS]; // Tx buffer base address
 	address_t rbase[SOCKETS]; // Rx buffer base address
+	uint16_t ssize[SOCKETS]; // Tx buffer size (the mask is this minus one)
+	uint16_t rsize[SOCKETS]; // Rx buffer size (the mask is this minus one)
+	uint8_t latched[SOCKETS]; // SnIR bits collected but not yet acknowledged
+	uint8_t failures; // SPI frames that failed
 
 	void reset(ticks_t resetting);
 
@@ -526,11 +728,57 @@ private:
 
 };
 
+inline int W5100::frame(uint8_t opcode, address_t address, uint8_t datum) {
+	// The whole frame is one SPI block transfer, in place.
+	uint8_t buffer[] = { opcode, static_cast<uint8_t>(address >> 8), static_cast<uint8_t>(address & 0xff), datum };
+	select();
+	ssize_t rc = spi->transfer(buffer, buffer, sizeof(buffer));
+	deselect();
+	if (rc == static_cast<ssize_t>(sizeof(buffer))) {
+		return buffer[3];
+	} else if (failures < ~static_cast<uint8_t>(0)) {
+		++failures;
+	} else {
+		// Do nothing.
+	}
+	return -1;
+}
+
+inline void W5100::select() {
+#if defined(COM_DIAG_AMIGO_W5100_SS_PIN)
+	if (fast) {
+		FastPin<COM_DIAG_AMIGO_W5100_SS_PIN>::clear(); // Active low.
+	} else {
+		gpio.clear(mask); // Active low.
+	}
+#else
+	gpio.clear(mask); // Active low.
+#endif
+}
+
+inline void W5100::deselect() {
+#if defined(COM_DIAG_AMIGO_W5100_SS_PIN)
+	if (fast) {
+		FastPin<COM_DIAG_AMIGO_W5100_SS_PIN>::set(); // Active low.
+	} else {
+		gpio.set(mask); // Active low.
+	}
+#else
+	gpio.set(mask); // Active low.
+#endif
+}
+
 inline W5100::W5100(MutexSemaphore & mymutex, GPIO::Pin myss, SPI & myspi)
 : mutex(&mymutex)
 , spi(&myspi)
 , gpio(GPIO::gpio2base(myss))
 , mask(GPIO::gpio2mask(myss))
+#if defined(COM_DIAG_AMIGO_W5100_SS_PIN)
+, fast(myss == COM_DIAG_AMIGO_W5100_SS_PIN)
+#else
+, fast(false)
+#endif
+, failures(0)
 {
 	initialize();
 }
@@ -540,6 +788,12 @@ inline W5100::W5100(GPIO::Pin myss, SPI & myspi)
 , spi(&myspi)
 , gpio(GPIO::gpio2base(myss))
 , mask(GPIO::gpio2mask(myss))
+#if defined(COM_DIAG_AMIGO_W5100_SS_PIN)
+, fast(myss == COM_DIAG_AMIGO_W5100_SS_PIN)
+#else
+, fast(false)
+#endif
+, failures(0)
 {
 	initialize();
 }
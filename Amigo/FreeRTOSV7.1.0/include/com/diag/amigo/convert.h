@@ -0,0 +1,147 @@
+#ifndef _COM_DIAG_AMIGO_CONVERT_H_
+#define _COM_DIAG_AMIGO_CONVERT_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ * The obvious way to convert an integer to digits is to repeatedly divide it
+ * by the base. But the megaAVR has no divide instruction, and dividing a long
+ * long by ten is a libgcc call that takes thousands of cycles, so printing a
+ * sixty-four bit counter that way takes tens of thousands. This conversion
+ * never divides anything wider than sixteen bits. For a base that is a power
+ * of two it just picks the bits of each digit out of the bytes of the value.
+ * For base ten it divides the value by one hundred a byte at a time, most
+ * significant byte first, using a multiplication by a scaled reciprocal that
+ * is exact for every partial dividend that can occur, and so produces two
+ * digits per pass over a value that gets a byte shorter every couple of
+ * passes. Any other base falls back to dividing a byte at a time by the base
+ * in sixteen bits. This header file has no dependencies on the rest of Amigo
+ * beyond cxxcapi.h so that it can be used by other code, like the
+ * LongLongPrint library, that has the Amigo include directory on its path.
+ */
+
+#include <stdint.h>
+#include "com/diag/amigo/cxxcapi.h"
+
+/**
+ * @def AMIGO_CONVERT_DIGITS
+ * This is the largest number of digits amigo_convert() produces, that of the
+ * largest sixty-four bit value in base two.
+ */
+#define AMIGO_CONVERT_DIGITS (64)
+
+/**
+ * Convert an unsigned value into digits in the specified base, least
+ * significant digit first. There are no leading zeros except that a zero
+ * value produces the single digit zero. The digits are not nul terminated.
+ * @param buffer points to where the digits are stored, which must be at least
+ * AMIGO_CONVERT_DIGITS characters, or as many as the value can have in the
+ * base rounded up to an even number.
+ * @param value is the value.
+ * @param base is the base from two to thirty-six; anything less than two is
+ * treated as ten.
+ * @param alpha is the character used for a digit of ten, typically 'a' or
+ * 'A'.
+ * @return the number of digits.
+ */
+CXXCINLINE uint8_t amigo_convert(char * buffer, uint64_t value, uint8_t base, char alpha) {
+	union { uint64_t word; uint8_t byte[sizeof(uint64_t)]; } number;
+	uint8_t limb[sizeof(uint64_t)]; /* Least significant byte first. */
+	uint8_t limbs;
+	uint8_t count = 0;
+	uint8_t digit;
+	uint8_t ii;
+	number.word = 1;
+	if (number.byte[0] != 0) {
+		number.word = value;
+		for (ii = 0; ii < sizeof(limb); ++ii) { limb[ii] = number.byte[ii]; }
+	} else {
+		number.word = value;
+		for (ii = 0; ii < sizeof(limb); ++ii) { limb[ii] = number.byte[sizeof(limb) - 1 - ii]; }
+	}
+	for (limbs = sizeof(limb); (limbs > 0) && (limb[limbs - 1] == 0); --limbs) {}
+	if (base < 2) { base = 10; }
+	if ((base & (base - 1)) == 0) {
+		uint8_t bits = 0;
+		uint16_t position = 0;
+		uint16_t total = limbs * 8;
+		uint16_t window;
+		while ((1 << bits) < base) { ++bits; }
+		do {
+			ii = position >> 3;
+			window = limb[ii];
+			if (ii < (sizeof(limb) - 1)) { window |= limb[ii + 1] << 8; }
+			digit = (window >> (position & 0x7)) & (base - 1);
+			buffer[count++] = (digit < 10) ? ('0' + digit) : (alpha + (digit - 10));
+			position += bits;
+		} while (position < total);
+	} else if (base == 10) {
+		uint16_t dividend;
+		uint8_t quotient;
+		uint8_t remainder;
+		uint8_t tens;
+		do {
+			remainder = 0;
+			for (ii = limbs; ii > 0; --ii) {
+				/* The dividend is less than 25600, for which the product
+				 * below yields exactly the dividend divided by one hundred. */
+				dividend = (((uint16_t)remainder) << 8) | limb[ii - 1];
+				quotient = (uint8_t)((((uint32_t)dividend) * 5243UL) >> 19);
+				remainder = (uint8_t)(dividend - (((uint16_t)quotient) * 100));
+				limb[ii - 1] = quotient;
+			}
+			/* Likewise exact for a remainder less than one hundred. */
+			tens = (uint8_t)((((uint16_t)remainder) * 205) >> 11);
+			buffer[count++] = '0' + (remainder - (tens * 10));
+			buffer[count++] = '0' + tens;
+			while ((limbs > 0) && (limb[limbs - 1] == 0)) { --limbs; }
+		} while (limbs > 0);
+	} else {
+		uint16_t dividend;
+		uint8_t quotient;
+		uint8_t remainder;
+		do {
+			remainder = 0;
+			for (ii = limbs; ii > 0; --ii) {
+				dividend = (((uint16_t)remainder) << 8) | limb[ii - 1];
+				quotient = (uint8_t)(dividend / base);
+				remainder = (uint8_t)(dividend - (((uint16_t)quotient) * base));
+				limb[ii - 1] = quotient;
+			}
+			buffer[count++] = (remainder < 10) ? ('0' + remainder) : (alpha + (remainder - 10));
+			while ((limbs > 0) && (limb[limbs - 1] == 0)) { --limbs; }
+		} while (limbs > 0);
+	}
+	while ((count > 1) && (buffer[count - 1] == '0')) { --count; }
+	return count;
+}
+
+#if defined(__cplusplus)
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * Convert an unsigned value into digits in the specified base, least
+ * significant digit first. See amigo_convert().
+ * @param buffer points to where the digits are stored.
+ * @param value is the value.
+ * @param base is the base from two to thirty-six.
+ * @param alpha is the character used for a digit of ten.
+ * @return the number of digits.
+ */
+inline uint8_t convert(char * buffer, uint64_t value, uint8_t base = 10, char alpha = 'A') {
+	return amigo_convert(buffer, value, base, alpha);
+}
+
+}
+}
+}
+
+#endif
+
+#endif /* _COM_DIAG_AMIGO_CONVERT_H_ */
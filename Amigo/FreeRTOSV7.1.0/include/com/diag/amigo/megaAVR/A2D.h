@@ -14,7 +14,9 @@
 #include <avr/io.h>
 #include "com/diag/amigo/types.h"
 #include "com/diag/amigo/constants.h"
+#include "com/diag/amigo/unused.h"
 #include "com/diag/amigo/TypedQueue.h"
+#include "com/diag/amigo/BinarySemaphore.h"
 #include "com/diag/amigo/target/GPIO.h"
 
 namespace com {
@@ -30,7 +32,10 @@ namespace amigo {
  * (AREF) or any one of several internal voltage sources, including Vcc. (Note
  * that some Arduino boards have 5v Vcc and others 3.3v Vcc. The Freetronics
  * EtherMega is of the former.) This version does not currently support
- * differential readings between two ADC pins.
+ * differential readings between two ADC pins. Besides converting individual
+ * requests, the A2D can scan a list of channels over and over, placing each
+ * sweep of the list into one of two frames and waking the consumer only once
+ * per sweep.
  */
 class A2D
 {
@@ -116,7 +121,10 @@ public:
 	 * in the Unit Test. But I can easily see applications for triggering it
 	 * on an pulse on the external interrupt 0 (INT0) pin, or for free running.
 	 * For any of the other choices, the application has to do its own setup on
-	 * the timer/counters or the analog comparator.
+	 * the timer/counters or the analog comparator, except that rate() sets up
+	 * timer/counter 1 for MATCH1B. The interrupt service routine clears the
+	 * timer/counter flag for the trigger after each conversion, since the ADC
+	 * is only triggered again by a rising edge on that flag.
 	 */
 	enum Trigger {
 		ON_DEMAND,
@@ -165,6 +173,15 @@ public:
 
 public:
 
+	/**
+	 * Combine a pin and a reference into the single byte that is used both as
+	 * a request and as an entry in a scan list.
+	 * @param pin is the pin number.
+	 * @param reference is the reference against which the pin is measured.
+	 * @return a request or scan list entry.
+	 */
+	static uint8_t encode(Pin pin, Reference reference = AVCC) { return (reference << 4) | (pin & 0x0f); }
+
 	/**
 	 * Map a pin to its equivalent GPIO pin.
 	 * @param pin is a Pin enumerated value.
@@ -279,6 +296,79 @@ public:
 	 */
 	int convert(Pin pin, Reference reference = AVCC, ticks_t timeout = NEVER);
 
+	/***************************************************************************
+	 * TIMING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Program timer/counter 1 to generate a compare match B at the specified
+	 * rate, so that an A2D started with the MATCH1B trigger converts at
+	 * exactly that rate with no involvement from the CPU between conversions.
+	 * Combined with scan(), each sample lands in a frame, and the sweep number
+	 * returned by frame() gives each sample its time. Timer/counter 1 is placed
+	 * in CTC mode, so it can no longer be used for PWM. This fails if
+	 * timer/counter 1 is being used for the FreeRTOS tick. The period must be
+	 * longer than a conversion, or triggers will be missed; at the default
+	 * divisor that is thirteen ADC clock cycles or 104 microseconds.
+	 * @param hertz is the desired rate in conversions per second, or zero to
+	 * stop the timer/counter.
+	 * @return the period of the actual rate in microseconds, or zero if the
+	 * timer/counter was stopped or the rate cannot be generated.
+	 */
+	uint32_t rate(uint32_t hertz);
+
+	/***************************************************************************
+	 * SCANNING
+	 **************************************************************************/
+
+public:
+
+	/**
+	 * Begin scanning a list of channels, or end scanning if the list is empty.
+	 * Each entry in the list is a pin and reference combined by encode(). The
+	 * interrupt service routine walks the list, storing each sample into the
+	 * current frame, and when the frame is full it switches to the other frame
+	 * and gives the consumer a single wakeup. If the A2D was started ON_DEMAND
+	 * or FREE_RUNNING, each conversion is started by the interrupt service
+	 * routine as soon as the prior one completes (this is how free running
+	 * is done while scanning, so that every sample is from the channel it is
+	 * stored for). Otherwise each conversion waits for the auto-trigger, for
+	 * example a timer match, so that the application controls the sampling
+	 * rate. Requests that are made while scanning wait until it ends. Neither
+	 * the list nor the frames are copied, so they must persist while scanning.
+	 * @param list points to the list of scan entries, or NULL to end scanning.
+	 * @param count is the number of entries in the list, or zero to end
+	 * scanning.
+	 * @param frames points to storage for two frames, each of which has count
+	 * samples, which is to say 2 * count * sizeof(uint16_t) bytes.
+	 */
+	void scan(const uint8_t * list, uint8_t count, uint16_t * frames);
+
+	/**
+	 * Wait for the next full frame from a scan and return a pointer to it.
+	 * The frame contains one sample for each entry in the scan list, in the
+	 * same order. It remains valid until the sweep after it completes, which
+	 * is to say the consumer has one full sweep time to process it. If the
+	 * consumer falls further behind than that, the error counter is
+	 * incremented and the most recent frame is returned.
+	 * @param timeout is the number of ticks to wait for a full frame.
+	 * @param sweep is returned with the number of the sweep, starting at zero,
+	 * that filled the frame. When conversions are triggered at a fixed rate,
+	 * sample i in the frame was taken (sweep * count + i) periods after
+	 * scanning began.
+	 * @return a pointer to the frame or NULL if none was available.
+	 */
+	const uint16_t * frame(ticks_t timeout = NEVER, uint16_t & sweep = unused.u16);
+
+	/**
+	 * Return the number of sweeps that have been completed since scanning
+	 * began. This counter wraps around.
+	 * @return the number of sweeps completed.
+	 */
+	uint16_t sweeps() const;
+
 	/***************************************************************************
 	 * CHECKING
 	 **************************************************************************/
@@ -322,7 +412,16 @@ protected:
 	volatile void * adcbase;
 	TypedQueue<uint16_t> converted; // An incoming queue of ten-bit conversions.
 	TypedQueue<uint8_t> requesting; // An outgoing queue of requests.
+	BinarySemaphore ready; // Given once per completed sweep.
+	const uint8_t * volatile scanning; // Scan list or NULL if not scanning.
+	uint16_t * sampling; // Two frames of scan samples.
+	volatile uint16_t swept;
 	Converter converter;
+	uint8_t scans;
+	uint8_t position;
+	volatile uint8_t filling;
+	volatile bool fresh;
+	bool chained;
 	uint8_t errors;
 
 	/**
@@ -336,6 +435,27 @@ protected:
 	 */
 	void adc(uint8_t request);
 
+	/**
+	 * Select the channel and reference for the next analog-to-digital
+	 * conversion without starting it.
+	 * @param request combines a reference enumerated value with a pin enumerated value.
+	 */
+	void select(uint8_t request);
+
+	/**
+	 * Implement the scanning part of the conversion complete interrupt
+	 * service routine.
+	 * @param sample is the sample that was just converted.
+	 * @param woken is set true if the consumer was woken.
+	 */
+	void sweep(uint16_t sample, bool & woken);
+
+	/**
+	 * Clear the timer/counter flag for the auto-trigger source, if any, so
+	 * that its next rising edge triggers another conversion.
+	 */
+	void rearm();
+
 	/**
 	 * Implement the instance conversion complete interrupt service routine.
 	 */
@@ -364,7 +484,7 @@ inline int A2D::available() const {
 }
 
 inline size_t A2D::request(Pin pin, Reference reference, ticks_t timeout) {
-	uint8_t request = (reference << 4) | (pin & 0x0f);
+	uint8_t request = encode(pin, reference);
 	if (!requesting.send(&request, timeout)) {
 		return 0;
 	} else {
@@ -379,7 +499,7 @@ inline int A2D::conversion(ticks_t timeout) {
 }
 
 inline int A2D::convert(Pin pin, Reference reference, ticks_t timeout) {
-	uint8_t request = (reference << 4) | (pin & 0x0f);
+	uint8_t request = encode(pin, reference);
 	if (!requesting.send(&request, timeout)) {
 		return -1;
 	} else {
@@ -433,7 +433,7 @@ inline const GPIO & GPIO::output(uint8_t mymask, uint8_t initial) const {
 	Uninterruptible uninterruptible;
 	COM_DIAG_AMIGO_GPIO_DDR |= mymask;
 	COM_DIAG_AMIGO_GPIO_PORT |= (mymask & initial);
-	COM_DIAG_AMIGO_GPIO_PORT &= ~(mymask & initial);
+	COM_DIAG_AMIGO_GPIO_PORT &= ~(mymask & ~initial);
 	return *this;
 }
 
@@ -519,6 +519,185 @@ inline bool GPIO::get(Pin pin) {
 	return (gpio.get(mymask) == mymask);
 }
 
+/*******************************************************************************
+ * FAST PINS
+ ******************************************************************************/
+
+/**
+ * FastPort maps a GPIO port number, which is a Pin enumerated value divided by
+ * eight, to its PIN register at compile time. It is only defined for the
+ * ports that the microcontroller has, so using a FastPin on a port it does not
+ * have fails to compile.
+ */
+template <uint8_t _PORT_> class FastPort;
+
+#define COM_DIAG_AMIGO_GPIO_FASTPORT(_PORT_, _PIN_) \
+	template <> class FastPort<_PORT_> { public: static volatile uint8_t & pin() { return _PIN_; } }
+
+#if defined(PINA)
+COM_DIAG_AMIGO_GPIO_FASTPORT(0, PINA);
+#endif
+#if defined(PINB)
+COM_DIAG_AMIGO_GPIO_FASTPORT(1, PINB);
+#endif
+#if defined(PINC)
+COM_DIAG_AMIGO_GPIO_FASTPORT(2, PINC);
+#endif
+#if defined(PIND)
+COM_DIAG_AMIGO_GPIO_FASTPORT(3, PIND);
+#endif
+#if defined(PINE)
+COM_DIAG_AMIGO_GPIO_FASTPORT(4, PINE);
+#endif
+#if defined(PINF)
+COM_DIAG_AMIGO_GPIO_FASTPORT(5, PINF);
+#endif
+#if defined(PING)
+COM_DIAG_AMIGO_GPIO_FASTPORT(6, PING);
+#endif
+#if defined(PINH)
+COM_DIAG_AMIGO_GPIO_FASTPORT(7, PINH);
+#endif
+#if defined(PINJ)
+COM_DIAG_AMIGO_GPIO_FASTPORT(8, PINJ);
+#endif
+#if defined(PINK)
+COM_DIAG_AMIGO_GPIO_FASTPORT(9, PINK);
+#endif
+#if defined(PINL)
+COM_DIAG_AMIGO_GPIO_FASTPORT(10, PINL);
+#endif
+
+/**
+ * FastPin implements the static single pin operations of GPIO for a pin that
+ * is known at compile time. GPIO looks up the register base and mask in
+ * program memory at run time, and then does a read-modify-write of the
+ * register through a pointer with interrupts disabled. FastPin resolves the
+ * register address and mask at compile time, so when the port is in the low
+ * I/O space (ports A through G on the ATmega2560, and all of them on the
+ * ATmega328P) the optimizer reduces set() and clear() to a single SBI or CBI
+ * instruction, which is atomic and so needs no Uninterruptible section, and
+ * get() to a single SBIS or SBIC when it is used in a condition. For ports in
+ * the extended I/O space FastPin falls back to an uninterruptible
+ * read-modify-write like GPIO, but still without the table lookups. Toggling
+ * is always a single write of the mask to the PIN register, which the megaAVR
+ * defines to toggle just those bits in the PORT register.
+ */
+template <GPIO::Pin _PIN_>
+class FastPin {
+
+public:
+
+	/**
+	 * This is the eight-bit mask for the pin.
+	 */
+	static const uint8_t MASK = (1 << (_PIN_ % 8));
+
+	/**
+	 * Return a reference to the PIN register for the pin.
+	 * @return a reference to the PIN register.
+	 */
+	static volatile uint8_t & pin() { return FastPort<(_PIN_ / 8)>::pin(); }
+
+	/**
+	 * Return a reference to the DDR register for the pin.
+	 * @return a reference to the DDR register.
+	 */
+	static volatile uint8_t & ddr() { return *(&pin() + 1); }
+
+	/**
+	 * Return a reference to the PORT register for the pin.
+	 * @return a reference to the PORT register.
+	 */
+	static volatile uint8_t & port() { return *(&pin() + 2); }
+
+	/**
+	 * Return true if the registers for the pin can be addressed by the SBI and
+	 * CBI instructions. This is a constant that the optimizer folds away.
+	 * @return true if SBI and CBI can be used, false otherwise.
+	 */
+	static bool atomic() { return (_SFR_MEM_ADDR(port()) < (0x20 + __SFR_OFFSET)); }
+
+	/**
+	 * Set the pin to input with no pull-up enabled.
+	 */
+	static void input() {
+		if (atomic()) {
+			port() &= ~MASK;
+			ddr() &= ~MASK;
+		} else {
+			Uninterruptible uninterruptible;
+			port() &= ~MASK;
+			ddr() &= ~MASK;
+		}
+	}
+
+	/**
+	 * Set the pin to output with its current value.
+	 */
+	static void output() {
+		if (atomic()) {
+			ddr() |= MASK;
+		} else {
+			Uninterruptible uninterruptible;
+			ddr() |= MASK;
+		}
+	}
+
+	/**
+	 * Set the pin to output with an explicit initial value.
+	 * @param initial indicates true for high (one), false for low (zero).
+	 */
+	static void output(bool initial) {
+		if (initial) {
+			set();
+		} else {
+			clear();
+		}
+		output();
+	}
+
+	/**
+	 * Set the pin to one (high).
+	 */
+	static void set() {
+		if (atomic()) {
+			port() |= MASK;
+		} else {
+			Uninterruptible uninterruptible;
+			port() |= MASK;
+		}
+	}
+
+	/**
+	 * Set the pin to zero (low).
+	 */
+	static void clear() {
+		if (atomic()) {
+			port() &= ~MASK;
+		} else {
+			Uninterruptible uninterruptible;
+			port() &= ~MASK;
+		}
+	}
+
+	/**
+	 * Toggle the pin.
+	 */
+	static void toggle() {
+		pin() = MASK;
+	}
+
+	/**
+	 * Get the value of the pin.
+	 * @return true if the value is high (one), false if it is low (zero).
+	 */
+	static bool get() {
+		return ((pin() & MASK) != 0);
+	}
+
+};
+
 }
 }
 }
@@ -28,9 +28,11 @@ namespace amigo {
  * that the effective analog voltage is the duty cycle times Vcc. This trick
  * of physics can be used to control motor speed, LED brightness, etc. Pins
  * whose hardware timer/counter conflict with the hardware timer/counter used
- * to provide FreeRTOS with a system tick are not supported and their
- * enumerated values are not defined. (Meaning: if you try to use pins that
- * can't be used on your FreeRTOS configuration, your code won't compile).
+ * to provide FreeRTOS with a system tick, or with the counter for its run
+ * time statistics (see com/diag/amigo/target/runtime.h), are not supported
+ * and their enumerated values are not defined. (Meaning: if you try to use
+ * pins that can't be used on your FreeRTOS configuration, your code won't
+ * compile).
  */
 class PWM
 {
@@ -72,7 +74,7 @@ public:
 		PIN_1D = 6,
 #	endif
 #endif
-#if !defined(portUSE_TIMER2)
+#if !defined(portUSE_TIMER2) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER2)
 #	if defined(TCCR2) && defined(COM21)
 		PIN_2 = 7,
 #	endif
@@ -108,7 +110,7 @@ public:
 		PIN_4D = 16,
 #	endif
 #endif
-#if !defined(portUSE_TIMER5)
+#if !defined(portUSE_TIMER5) && !defined(COM_DIAG_AMIGO_RUNTIME_TIMER5)
 #	if defined(TCCR5A) && defined(COM5A1)
 		PIN_5A = 17,
 #endif
@@ -219,6 +221,23 @@ public:
 	 */
 	static Timer pwm2timer(Pin pin);
 
+	/**
+	 * Map a Timer enumerated value to the address of its interrupt flag
+	 * register (TIFRn). The overflow flag (TOVn) is bit zero for every timer.
+	 * @param timer is a Timer enumerated value.
+	 * @return an interrupt flag register address or NULL if invalid.
+	 */
+	static volatile void * timer2interruptflag(Timer timer);
+
+	/**
+	 * Map a Timer enumerated value to the address of its interrupt mask
+	 * register (TIMSKn). The overflow interrupt enable (TOIEn) is bit zero for
+	 * every timer.
+	 * @param timer is a Timer enumerated value.
+	 * @return an interrupt mask register address or NULL if invalid.
+	 */
+	static volatile void * timer2interruptmask(Timer timer);
+
 	/***************************************************************************
 	 * CONSTRUCTING AND DESTRUCTING
 	 **************************************************************************/
@@ -288,6 +307,34 @@ public:
 	 */
 	Timer prestart() { return prestart(timer); }
 
+	/**
+	 * Configure the specified sixteen-bit hardware timer for fast PWM at the
+	 * specified frequency, using the input capture register (ICR) as TOP so
+	 * that the frequency doesn't depend on the resolution. The smallest
+	 * prescale factor that can generate the frequency is chosen, which gives
+	 * the most resolution. In this mode the output compare registers are
+	 * double buffered by the hardware, so a new duty cycle takes effect at
+	 * the end of the current period and never produces a runt or stretched
+	 * pulse. This overrides any other configuration the timer may have, like
+	 * prestart(Timer) does, and it works only on timers 1, 3, 4 and 5. The
+	 * frequency should be set before the duty cycles, because changing TOP is
+	 * not double buffered.
+	 * @param timer is the timer to configure.
+	 * @param hertz is the desired frequency in cycles per second.
+	 * @return the value of TOP, which is the number of duty cycle steps less
+	 * one and at least three (two bits of resolution), or zero if the timer or
+	 * the frequency is not supported.
+	 */
+	static uint16_t prestart(Timer timer, uint32_t hertz);
+
+	/**
+	 * Configure the sixteen-bit hardware timer associated with this pin for
+	 * fast PWM at the specified frequency. See prestart(Timer, uint32_t).
+	 * @param hertz is the desired frequency in cycles per second.
+	 * @return the value of TOP or zero if unsuccessful.
+	 */
+	uint16_t prestart(uint32_t hertz) { return prestart(timer, hertz); }
+
 	/**
 	 * Start generating square wave for Pulse Width Modulation at the specified
 	 * duty cycle where 0 if a duty cycle of 0% and 255 is a duty cycle of 100%
@@ -295,6 +342,20 @@ public:
 	 */
 	void start(uint8_t dutycycle /* 0..255 */);
 
+	/**
+	 * Start generating a square wave for Pulse Width Modulation at the
+	 * specified sixteen-bit duty cycle, where 0 is a duty cycle of 0% and
+	 * 65535 is a duty cycle of 100%. The duty cycle is scaled to the value of
+	 * TOP set by prestart(Timer, uint32_t), or to the eight-bit TOP set by
+	 * prestart(Timer), or is simply truncated to eight bits for an eight-bit
+	 * timer. A duty cycle that scales to zero disconnects the pin from the
+	 * timer and drives it low, since fast PWM would otherwise still produce
+	 * a pulse one timer clock wide every period. This may be called
+	 * repeatedly to change the duty cycle without glitches.
+	 * @param dutycycle is the duty cycle in the range 0 to 65535.
+	 */
+	void start16(uint16_t dutycycle /* 0..65535 */);
+
 	/**
 	 * Stop generating a square wave.
 	 * @param high if true leave the GPIO pin set to high, otherwise low.
@@ -0,0 +1,293 @@
+#ifndef _COM_DIAG_AMIGO_MEGAAVR_PWMGROUP_H_
+#define _COM_DIAG_AMIGO_MEGAAVR_PWMGROUP_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ */
+
+#include "com/diag/amigo/types.h"
+#include "com/diag/amigo/target/PWM.h"
+#include "com/diag/amigo/target/Uninterruptible.h"
+
+namespace com {
+namespace diag {
+namespace amigo {
+
+/**
+ * PWMGroup updates the duty cycles of several PWM pins together, so that all
+ * of the pins on the same timer change in the same PWM period. (Updating them
+ * one PWM object at a time can straddle a period boundary, which for example
+ * shows up as a flicker in the color of an RGB LED.) The pins are grouped by
+ * timer and their output compare registers are looked up once, when the
+ * PWMGroup is constructed, so an update is just a store per pin. New duty
+ * cycles are staged and then committed. In every PWM mode that PWM uses the
+ * output compare registers are double buffered and the new values are loaded
+ * from the buffers at TOP or BOTTOM. A commit waits for the overflow flag of
+ * each timer, which marks the start of a period, and then writes all of that
+ * timer's registers with interrupts disabled, well before the next load. The
+ * timers must have been configured with PWM::prestart(Timer) beforehand. The
+ * duty cycles are eight bits, so a sixteen-bit timer configured with
+ * PWM::prestart(Timer, uint32_t), or any other mode with TOP in ICRn or
+ * OCRnA, is refused at commit; use PWM::start16() for those.
+ */
+template <uint8_t _CHANNELS_>
+class PWMGroup
+{
+
+public:
+
+	/**
+	 * This is a pin and the duty cycle to which it is to be set.
+	 */
+	struct Setting {
+		PWM::Pin pin;
+		uint8_t dutycycle;
+	};
+
+	/**
+	 * Constructor.
+	 * @param pins points to an array of PWM pin enumerated values.
+	 * @param count is the number of pins in the array, no more than
+	 * _CHANNELS_.
+	 */
+	explicit PWMGroup(const PWM::Pin * pins, uint8_t count)
+	: channels(0)
+	, timers(0)
+	, valid(count <= _CHANNELS_)
+	{
+		for (uint8_t ii = 0; valid && (ii < count); ++ii) {
+			if (PWM::pwm2timer(pins[ii]) == PWM::NONE) {
+				valid = false;
+			} else if ((PWM::pwm2outputcompare8(pins[ii]) == 0) && (PWM::pwm2outputcompare16(pins[ii]) == 0)) {
+				valid = false;
+			} else {
+				// Do nothing.
+			}
+		}
+		for (uint8_t ii = 0; valid && (ii < count); ++ii) {
+			PWM::Timer timer = PWM::pwm2timer(pins[ii]);
+			uint8_t tt;
+			for (tt = 0; tt < timers; ++tt) {
+				if (group[tt].timer == timer) {
+					break;
+				}
+			}
+			if (tt < timers) {
+				// Do nothing: this timer has already been grouped.
+			} else {
+				group[timers].timer = timer;
+				group[timers].control = static_cast<volatile uint8_t *>(PWM::pwm2control(pins[ii]));
+				group[timers].flag = static_cast<volatile uint8_t *>(PWM::timer2interruptflag(timer));
+				group[timers].mask = static_cast<volatile uint8_t *>(PWM::timer2interruptmask(timer));
+				group[timers].first = channels;
+				for (uint8_t jj = ii; jj < count; ++jj) {
+					if (PWM::pwm2timer(pins[jj]) == timer) {
+						channel[channels].pin = pins[jj];
+						channel[channels].ocr8 = static_cast<volatile uint8_t *>(PWM::pwm2outputcompare8(pins[jj]));
+						channel[channels].ocr16 = static_cast<volatile uint16_t *>(PWM::pwm2outputcompare16(pins[jj]));
+						channel[channels].dutycycle = PWM::LOW;
+						++channels;
+					}
+				}
+				group[timers].last = channels;
+				if ((group[timers].flag == 0) || (group[timers].mask == 0)) {
+					valid = false;
+				}
+				++timers;
+			}
+		}
+	}
+
+	/**
+	 * Destructor.
+	 */
+	~PWMGroup() {}
+
+	/**
+	 * Return true if construction was successful, false otherwise.
+	 * @return true of construction was successful, false otherwise.
+	 */
+	operator bool() const { return valid; }
+
+	/**
+	 * Return the number of distinct timers used by the pins in the group.
+	 * @return the number of distinct timers.
+	 */
+	uint8_t size() const { return timers; }
+
+	/**
+	 * Stage a new duty cycle for a pin. It takes effect at the next commit().
+	 * @param pin is a pin in the group.
+	 * @param dutycycle is the duty cycle in the range 0 to 255.
+	 * @return true if the pin is in the group, false otherwise.
+	 */
+	bool stage(PWM::Pin pin, uint8_t dutycycle) {
+		for (uint8_t ii = 0; ii < channels; ++ii) {
+			if (channel[ii].pin == pin) {
+				channel[ii].dutycycle = dutycycle;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Write all of the staged duty cycles to the output compare registers,
+	 * one timer at a time. If synchronizing, this waits up to one PWM period
+	 * for each timer. Without synchronizing the writes happen immediately,
+	 * which is appropriate when this is called from a timer overflow interrupt
+	 * service routine, which is already at the start of a period. A timer
+	 * whose overflow interrupt is enabled can't be synchronized, since its
+	 * interrupt service routine clears the overflow flag, so its writes happen
+	 * immediately too. A timer whose TOP is not 0xff is skipped: an eight-bit
+	 * timer must be in mode 1 or 3, a sixteen-bit timer in mode 1 or 5.
+	 * @param synchronize if true waits for the start of a period.
+	 * @return true if the writes for every timer completed within the period
+	 * in which they began, false otherwise, including if a timer could not be
+	 * synchronized or was skipped.
+	 */
+	bool commit(bool synchronize = true) {
+		bool result = true;
+		for (uint8_t tt = 0; tt < timers; ++tt) {
+			volatile uint8_t * flag = group[tt].flag;
+			// WGMn0 and WGMn1 are bits zero and one of TCCRnA, and WGMn2 and
+			// WGMn3 (sixteen-bit timers only) are bits three and four of
+			// TCCRnB. Any other mode puts TOP at 0x1ff, 0x3ff, ICRn or OCRnA,
+			// where an eight-bit duty cycle is meaningless.
+			uint8_t wgm = (group[tt].control[0] & (_BV(1) | _BV(0))) | ((group[tt].control[1] & (_BV(4) | _BV(3))) >> 1);
+			if (channel[group[tt].first].ocr16 != 0) {
+				if ((wgm != 1) && (wgm != 5)) {
+					result = false;
+					continue;
+				}
+			} else {
+				if ((wgm != 1) && (wgm != 3)) {
+					result = false;
+					continue;
+				}
+			}
+			// Only wait for a timer that has a clock source.
+			bool running = synchronize && ((group[tt].control[1] & (_BV(2) | _BV(1) | _BV(0))) != 0);
+			if (!running) {
+				// Do nothing.
+			} else if ((*group[tt].mask & _BV(0)) != 0) {
+				running = false;
+				result = false;
+			} else {
+				// Do nothing.
+			}
+			if (running) {
+				*flag = _BV(0); // Writing a one clears it.
+				while ((*flag & _BV(0)) == 0) {
+					// Do nothing.
+				}
+			}
+			Uninterruptible uninterruptible;
+			if (running) {
+				*flag = _BV(0);
+			}
+			for (uint8_t ii = group[tt].first; ii < group[tt].last; ++ii) {
+				if (channel[ii].ocr16 != 0) {
+					*channel[ii].ocr16 = channel[ii].dutycycle;
+				} else {
+					*channel[ii].ocr8 = channel[ii].dutycycle;
+				}
+			}
+			if (running && ((*flag & _BV(0)) != 0)) {
+				result = false;
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Stage each of the settings and commit them.
+	 * @param settings points to an array of settings.
+	 * @param count is the number of settings in the array.
+	 * @return true if every pin was in the group and the commit was
+	 * synchronized, false otherwise.
+	 */
+	bool update(const Setting * settings, uint8_t count) {
+		bool result = true;
+		for (uint8_t ii = 0; ii < count; ++ii) {
+			if (!stage(settings[ii].pin, settings[ii].dutycycle)) {
+				result = false;
+			}
+		}
+		return commit() && result;
+	}
+
+	/**
+	 * Commit the staged duty cycles and then connect every pin to its timer
+	 * so that it begins generating a square wave.
+	 */
+	void start() {
+		commit();
+		for (uint8_t ii = 0; ii < channels; ++ii) {
+			PWM pwm(channel[ii].pin);
+			pwm.start(channel[ii].dutycycle);
+		}
+	}
+
+	/**
+	 * Disconnect every pin from its timer.
+	 * @param high if true leave the GPIO pins set to high, otherwise low.
+	 */
+	void stop(bool high = false) {
+		for (uint8_t ii = 0; ii < channels; ++ii) {
+			PWM pwm(channel[ii].pin);
+			pwm.stop(high);
+		}
+	}
+
+protected:
+
+	struct Channel {
+		volatile uint8_t * ocr8;
+		volatile uint16_t * ocr16;
+		PWM::Pin pin;
+		uint8_t dutycycle;
+	};
+
+	struct Group {
+		volatile uint8_t * control;
+		volatile uint8_t * flag;
+		volatile uint8_t * mask;
+		PWM::Timer timer;
+		uint8_t first;
+		uint8_t last;
+	};
+
+	Channel channel[_CHANNELS_];
+	Group group[PWM::TIMER_5 + 1];
+	uint8_t channels;
+	uint8_t timers;
+	bool valid;
+
+private:
+
+    /**
+     *  Copy constructor. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	PWMGroup(const PWMGroup & that);
+
+    /**
+     *  Assignment operator. POISONED.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+	PWMGroup & operator=(const PWMGroup& that);
+
+};
+
+}
+}
+}
+
+#endif /* _COM_DIAG_AMIGO_MEGAAVR_PWMGROUP_H_ */
@@ -14,6 +14,7 @@
 #include "com/diag/amigo/types.h"
 #include "com/diag/amigo/constants.h"
 #include "com/diag/amigo/TypedQueue.h"
+#include "com/diag/amigo/BinarySemaphore.h"
 
 namespace com {
 namespace diag {
@@ -40,7 +41,10 @@ namespace amigo {
  * using SPI do not interfere with one another. This can be done with a
  * MutexSemaphore. This makes it easy to serialize use of the SPI and the
  * slave select pins (about which the SPI knows nothing) by using the
- * MutexSemaphore in a CriticalSection in the application.
+ * MutexSemaphore in a CriticalSection in the application. A master may
+ * instead use block transfers, in which the interrupt service routine moves
+ * bytes directly between caller-provided buffers and the SPI and wakes the
+ * caller once at the end, bypassing the ring buffers altogether.
  */
 class SPI
 {
@@ -233,6 +237,25 @@ public:
 	 */
 	int slave(uint8_t ch = 0, ticks_t timeout = NEVER);
 
+	/**
+	 * Transfer a block of bytes as a master. Each byte in the transmit buffer
+	 * is transmitted and the byte received in exchange is stored in the
+	 * receive buffer. Unlike master(), which moves every byte through the
+	 * transmit and receive ring buffers, the interrupt service routine walks
+	 * the two buffers directly and gives a semaphore once, when the entire
+	 * block is done. The transmit and receive buffers may be the same buffer.
+	 * Both buffers must remain valid until this method returns. Use of this
+	 * method must be serialized with use of master() and of other transfers
+	 * in the same way as master() is serialized.
+	 * @param data points to the bytes to transmit, or NULL to transmit zeros.
+	 * @param buffer points to where to store the received bytes, or NULL to
+	 * discard them.
+	 * @param length is the number of bytes to transfer.
+	 * @param timeout is the number of ticks to wait for the transfer.
+	 * @return the number of bytes transferred or <0 if fail.
+	 */
+	ssize_t transfer(const void * data, void * buffer, size_t length, ticks_t timeout = NEVER);
+
 	/***************************************************************************
 	 * CHECKING
 	 **************************************************************************/
@@ -277,6 +300,10 @@ protected:
 	volatile void * gpiobase;
 	TypedQueue<uint8_t> received;
 	TypedQueue<uint8_t> transmitting;
+	BinarySemaphore transferred;
+	const uint8_t * volatile transmit;
+	uint8_t * volatile receive;
+	volatile size_t remaining;
 	Controller controller;
 	// Below is _our_ Slave Select (SS) when we are operating in slave mode.
 	// When we are operating in master mode, each individual slave device on
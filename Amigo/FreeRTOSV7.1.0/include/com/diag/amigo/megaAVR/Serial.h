@@ -16,6 +16,8 @@
 #include "com/diag/amigo/types.h"
 #include "com/diag/amigo/constants.h"
 #include "com/diag/amigo/TypedQueue.h"
+#include "com/diag/amigo/BinarySemaphore.h"
+#include "com/diag/amigo/target/harvard.h"
 
 namespace com {
 namespace diag {
@@ -156,6 +158,21 @@ public:
 	 */
 	static const uint8_t BAD = '?';
 
+	/**
+	 * Defines the default number of character times the receive line must be
+	 * idle before a task blocked in a bulk read() is woken even though fewer
+	 * than the threshold number of characters have arrived.
+	 */
+	static const uint8_t IDLE = 4;
+
+	/**
+	 * Defines the maximum number of characters a bulk write copies into the
+	 * transmit ring buffer with interrupts disabled. This bounds how long the
+	 * receive interrupt can be held off, which at the higher baud rates has
+	 * to be less than the time to fill the two character USART receive FIFO.
+	 */
+	static const size_t BURST = 16;
+
 	/***************************************************************************
 	 * CONSTRUCTING AND DESTRUCTING
 	 **************************************************************************/
@@ -271,6 +288,34 @@ public:
 	 */
 	int read(ticks_t timeout = NEVER);
 
+	/**
+	 * Set the receive threshold used by the bulk read(). When the threshold is
+	 * zero, which is the default, a bulk read() returns as soon as at least
+	 * one character is available. Otherwise the calling task is not woken for
+	 * every character the interrupt service routine receives, but only when
+	 * the threshold number of characters have accumulated, or when at least
+	 * one character has arrived and the receive line has been idle for the
+	 * specified number of character times. Idle detection is only as fine as
+	 * the system tick, so the idle interval is rounded up to at least one
+	 * tick. The threshold should be smaller than the receive ring buffer.
+	 * @param count is the number of characters that wakes the reader.
+	 * @param characters is the number of idle character times that wakes the
+	 * reader.
+	 */
+	void threshold(size_t count, uint8_t characters = IDLE);
+
+	/**
+	 * Remove as many characters as are available, up to the size of the
+	 * buffer, from the receive ring buffer in one call. If characters are
+	 * not already available, the calling task blocks as determined by the
+	 * receive threshold.
+	 * @param buffer points to where the characters are stored.
+	 * @param size is the size of the buffer in bytes.
+	 * @param timeout is the number of ticks to wait when the buffer is empty.
+	 * @return the number of characters stored, which may be zero.
+	 */
+	size_t read(void * buffer, size_t size, ticks_t timeout = NEVER);
+
 	/**
 	 * Append a character to the end of the transmit ring buffer.
 	 * @param ch is the character to be appended.
@@ -279,6 +324,32 @@ public:
 	 */
 	size_t write(uint8_t ch, ticks_t timeout = NEVER);
 
+	/**
+	 * Append a buffer in data space to the end of the transmit ring buffer.
+	 * The characters are copied in bursts with interrupts disabled instead of
+	 * one queue operation at a time, and the transmitter is started once per
+	 * burst instead of once per character.
+	 * @param data points to the characters to be appended.
+	 * @param size is the number of characters to be appended.
+	 * @param timeout is the number of ticks to wait each time the buffer is
+	 * full.
+	 * @return the number of characters appended.
+	 */
+	size_t write(const void * data, size_t size, ticks_t timeout = NEVER);
+
+	/**
+	 * Append a buffer in program space to the end of the transmit ring buffer.
+	 * The characters are copied in bursts with interrupts disabled instead of
+	 * one queue operation at a time, and the transmitter is started once per
+	 * burst instead of once per character.
+	 * @param data points to the characters to be appended.
+	 * @param size is the number of characters to be appended.
+	 * @param timeout is the number of ticks to wait each time the buffer is
+	 * full.
+	 * @return the number of characters appended.
+	 */
+	size_t write_P(PGM_VOID_P data, size_t size, ticks_t timeout = NEVER);
+
 	/**
 	 * Prepend a character to the beginning of the transmit ring buffer. This
 	 * will be the next character to be transmitted from the buffer, ahead of
@@ -342,11 +413,33 @@ protected:
 	volatile void * usartbase;
 	TypedQueue<uint8_t> received;
 	TypedQueue<uint8_t> transmitting;
+	BinarySemaphore ready;
 	Port port;
 	double microseconds;
+	size_t batch;
+	volatile ticks_t last;
+	ticks_t quiet;
+	uint8_t idle;
 	uint8_t bad;
 	uint8_t errors;
 
+	/**
+	 * Implement the bulk writes from either data or program space.
+	 * @param data points to the characters to be appended.
+	 * @param size is the number of characters to be appended.
+	 * @param timeout is the number of ticks to wait each time the buffer is
+	 * full.
+	 * @param progmem is true if data is in program space.
+	 * @return the number of characters appended.
+	 */
+	size_t emit(const void * data, size_t size, ticks_t timeout, bool progmem);
+
+	/**
+	 * Compute the idle interval in ticks from the idle character times and the
+	 * character time established by start().
+	 */
+	void quiesce();
+
 	/**
 	 * Start an interrupt-driven I/O.
 	 */
@@ -410,6 +503,14 @@ inline size_t Serial::write(uint8_t ch, ticks_t timeout) {
 	}
 }
 
+inline size_t Serial::write(const void * data, size_t size, ticks_t timeout) {
+	return emit(data, size, timeout, false);
+}
+
+inline size_t Serial::write_P(PGM_VOID_P data, size_t size, ticks_t timeout) {
+	return emit(data, size, timeout, true);
+}
+
 inline size_t Serial::express(uint8_t ch, ticks_t timeout) {
 	if (!transmitting.express(&ch, timeout)) {
 		return 0;
@@ -0,0 +1,73 @@
+#ifndef _COM_DIAG_AMIGO_MEGAAVR_RUNTIME_H_
+#define _COM_DIAG_AMIGO_MEGAAVR_RUNTIME_H_
+
+/**
+ * @file
+ * Copyright 2012 Digital Aggregates Corporation, Colorado, USA\n
+ * Licensed under the terms in README.h\n
+ * Chip Overclock mailto:coverclock@diag.com\n
+ * http://www.diag.com/navigation/downloads/Amigo.html\n
+ *
+ * These functions implement the high resolution counter that FreeRTOS uses
+ * to measure how much CPU time each task uses when configGENERATE_RUN_TIME_STATS
+ * is 1; FreeRTOSConfig.h defines portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() and
+ * portGET_RUN_TIME_COUNTER_VALUE() to call them. This header is included by
+ * FreeRTOSConfig.h and so has to be acceptable to the C compiler too.
+ *
+ * The counter is a free running hardware timer, Timer5 on processors like the
+ * ATmega2560 that have one and Timer2 on those like the ATmega328p that don't,
+ * prescaled by 64 and extended to thirty-two bits by counting its overflows in
+ * an interrupt service routine. With a 16MHz clock it counts every four
+ * microseconds and wraps around after nearly five hours. While statistics are
+ * being collected that timer can't be used for anything else, including PWM
+ * on its output compare pins.
+ */
+
+#include <avr/io.h>
+#include "com/diag/amigo/cxxcapi.h"
+
+/**
+ * @def COM_DIAG_AMIGO_RUNTIME_TIMER5
+ * This is defined when Timer5 is the counter, so that, like the timer named
+ * by portUSE_TIMERn for the system tick, PWM leaves it alone.
+ */
+
+/**
+ * @def COM_DIAG_AMIGO_RUNTIME_TIMER2
+ * This is defined when Timer2 is the counter, so that PWM leaves it alone.
+ */
+
+#if defined(configGENERATE_RUN_TIME_STATS) && (configGENERATE_RUN_TIME_STATS == 1)
+#	if defined(TCNT5)
+#		define COM_DIAG_AMIGO_RUNTIME_TIMER5
+#	elif defined(TCNT2)
+#		define COM_DIAG_AMIGO_RUNTIME_TIMER2
+#	endif
+#endif
+
+/**
+ * @def COM_DIAG_AMIGO_RUNTIME_PRESCALE
+ * This is the divisor applied to the CPU clock to drive the counter.
+ */
+#define COM_DIAG_AMIGO_RUNTIME_PRESCALE (64)
+
+/**
+ * @def COM_DIAG_AMIGO_RUNTIME_HZ
+ * This is the frequency of the counter in Hertz.
+ */
+#define COM_DIAG_AMIGO_RUNTIME_HZ (F_CPU / COM_DIAG_AMIGO_RUNTIME_PRESCALE)
+
+/**
+ * Reset the counter to zero and start it. FreeRTOS calls this when it starts
+ * the scheduler.
+ */
+CXXCAPI void amigo_runtime_start(void);
+
+/**
+ * Return the value of the counter. FreeRTOS calls this during every context
+ * switch, so it is short.
+ * @return the value of the counter.
+ */
+CXXCAPI unsigned long amigo_runtime_counter(void);
+
+#endif /* _COM_DIAG_AMIGO_MEGAAVR_RUNTIME_H_ */
@@ -18,8 +18,9 @@
 	/*
 	 * Change 0 to 1 if ssize_t is already defined elsewhere. There is no
 	 * standard portable way the preprocessor can know this since it is
-	 * (likely) not a preprocessor symbol.
+	 * (likely) not a preprocessor symbol. On a POSIX host it is here.
 	 */
+#	include <sys/types.h>
 #elif !defined(___SIZEOF_SIZE_T__)
 	typedef unsigned int ssize_t;
 #elif (__SIZEOF_SIZE_T__ == __SIZEOF_INT__)
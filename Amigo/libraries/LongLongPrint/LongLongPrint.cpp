@@ -26,6 +26,9 @@
 #include "Arduino.h"
 
 #include "LongLongPrint.h"
+// The Amigo include directory, FreeRTOSV7.1.0/include, must be on the include
+// path.
+#include "com/diag/amigo/convert.h"
 
 // Public Methods //////////////////////////////////////////////////////////////
 
@@ -239,23 +242,20 @@ size_t LongLongPrint::println(const Printable& x)
 
 // Private Methods /////////////////////////////////////////////////////////////
 
+// Uses amigo_convert so that no digit costs a sixty-four bit division by the
+// base.
 size_t LongLongPrint::printNumber(unsigned long long n, uint8_t base) {
-  char buf[8 * sizeof(long long) + 1]; // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[sizeof(buf) - 1];
+  char digits[AMIGO_CONVERT_DIGITS]; // Least significant digit first.
+  char buf[AMIGO_CONVERT_DIGITS + 1]; // Plus zero byte.
+  uint8_t count = amigo_convert(digits, n, base, 'A'); // Treats base < 2 as 10.
+  uint8_t i;
 
-  *str = '\0';
-
-  // prevent crash if called with base == 1
-  if (base < 2) base = 10;
-
-  do {
-    unsigned long long m = n;
-    n /= base;
-    char c = m - base * n;
-    *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  } while(n);
+  for (i = 0; i < count; ++i) {
+    buf[i] = digits[count - 1 - i];
+  }
+  buf[count] = '\0';
 
-  return write(str);
+  return write(buf);
 }
 
 size_t LongLongPrint::printFloat(double number, uint8_t digits)
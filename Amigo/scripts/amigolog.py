@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+#
+# Copyright 2012 Digital Aggregates Corporation, Colorado, USA
+# Licensed under the terms in README.h
+# Chip Overclock mailto:coverclock@diag.com
+# http://www.diag.com/navigation/downloads/Amigo.html
+#
+# Renders as text the binary records written by com::diag::amigo::Log, using
+# the format strings in the ELF file of the application that wrote them.
+# Everything else in the input, for example the output of Print, is passed
+# through unchanged. Text that isn't seven-bit ASCII may contain the RECORD
+# byte itself, so a RECORD that isn't followed by the address of a format
+# string and a record that renders is passed through as text too, and the
+# decoding resumes with the byte after it. The decoding of each record follows the scan of the
+# format string in Amigo/GCC/Log.cpp and the two must be kept in agreement.
+#
+# usage: amigolog.py [ -t ] APPLICATION.elf [ CAPTURE ]
+#
+# -t prefixes each record with its tick count. CAPTURE defaults to standard
+# input, for example: amigolog.py -t main.elf < /dev/ttyACM0
+#
+
+import struct
+import sys
+
+RECORD = 0xa5
+EM_AVR = 83
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+class Image:
+
+	def __init__(self, path):
+		data = open(path, 'rb').read()
+		if data[0:4] != b'\x7fELF':
+			raise ValueError(path + ': not an ELF file')
+		wide = (data[4] == 2)
+		order = '<' if (data[5] == 1) else '>'
+		machine = struct.unpack_from(order + 'H', data, 18)[0]
+		# The megaAVR double is the same as its float.
+		self.double = (order + 'f', 4) if (machine == EM_AVR) else (order + 'd', 8)
+		if wide:
+			shoff = struct.unpack_from(order + 'Q', data, 40)[0]
+			shentsize, shnum = struct.unpack_from(order + 'HH', data, 58)
+		else:
+			shoff = struct.unpack_from(order + 'I', data, 32)[0]
+			shentsize, shnum = struct.unpack_from(order + 'HH', data, 46)
+		self.sections = []
+		for ii in range(shnum):
+			base = shoff + (ii * shentsize)
+			if wide:
+				kind, flags, address, offset, size = struct.unpack_from(order + 'IQQQQ', data, base + 4)
+			else:
+				kind, flags, address, offset, size = struct.unpack_from(order + 'IIIII', data, base + 4)
+			if (flags & SHF_ALLOC) and (kind != SHT_NOBITS) and (size > 0):
+				self.sections.append((address, size, data[offset:offset + size]))
+
+	def string(self, address):
+		for base, size, contents in self.sections:
+			if base <= address < (base + size):
+				end = contents.find(b'\0', address - base)
+				if end < 0:
+					end = size
+				return contents[address - base:end].decode('latin-1')
+		return '<0x%x>' % address
+
+	def format(self, address):
+		for base, size, contents in self.sections:
+			if base <= address < (base + size):
+				end = contents.find(b'\0', address - base)
+				if end <= (address - base):
+					return None
+				text = contents[address - base:end]
+				for octet in text:
+					if (octet < 0x20 or octet > 0x7e) and (octet not in b'\t\r\n'):
+						return None
+				return text.decode('latin-1')
+		return None
+
+class Capture:
+
+	def __init__(self, stream):
+		self.stream = stream
+		self.pushed = []
+		self.taken = None
+
+	def byte(self):
+		if self.pushed:
+			octet = self.pushed.pop(0)
+		else:
+			octets = self.stream.read(1)
+			if not octets:
+				raise EOFError
+			octet = octets[0]
+		if self.taken is not None:
+			self.taken.append(octet)
+		return octet
+
+	def bytes(self, size):
+		return bytes([self.byte() for ii in range(size)])
+
+	# Remember the bytes read from here on, so that they can be read again.
+	def mark(self):
+		self.taken = []
+
+	def commit(self):
+		self.taken = None
+
+	def rewind(self):
+		self.pushed = self.taken + self.pushed
+		self.taken = None
+
+	def varint(self):
+		value = 0
+		shift = 0
+		while True:
+			octet = self.byte()
+			value |= (octet & 0x7f) << shift
+			shift += 7
+			if not (octet & 0x80):
+				return value
+
+	def zigzag(self):
+		value = self.varint()
+		return (value >> 1) ^ -(value & 1)
+
+def render(image, capture, format):
+	text = ''
+	ii = 0
+	while ii < len(format):
+		ch = format[ii]
+		ii += 1
+		if ch != '%':
+			text += ch
+			continue
+		spec = '%'
+		arguments = []
+		while ii < len(format):
+			ch = format[ii]
+			ii += 1
+			if ch in '-+ #.0123456789':
+				spec += ch
+			elif ch in 'hlLjzt':
+				# Length modifiers; the record already has the argument in
+				# its encoded size, and %L is written as a double.
+				pass
+			elif ch == '*':
+				spec += ch
+				arguments.append(capture.zigzag())
+			elif ch in 'di':
+				arguments.append(capture.zigzag())
+				text += (spec + 'd') % tuple(arguments)
+				break
+			elif ch in 'ouxX':
+				arguments.append(capture.varint())
+				text += (spec + ch.replace('u', 'd')) % tuple(arguments)
+				break
+			elif ch == 'c':
+				arguments.append(chr(capture.varint()))
+				text += (spec + 'c') % tuple(arguments)
+				break
+			elif ch == 'p':
+				arguments.append(capture.varint())
+				text += (spec + '#x') % tuple(arguments)
+				break
+			elif ch == 'S':
+				arguments.append(image.string(capture.varint()))
+				text += (spec + 's') % tuple(arguments)
+				break
+			elif ch == 's':
+				arguments.append(capture.bytes(capture.varint()).decode('latin-1'))
+				text += (spec + 's') % tuple(arguments)
+				break
+			elif ch in 'eEfFgG':
+				arguments.append(struct.unpack(image.double[0], capture.bytes(image.double[1]))[0])
+				text += (spec + ch) % tuple(arguments)
+				break
+			elif ch == '%':
+				text += '%'
+				break
+			else:
+				text += spec + ch
+				break
+	return text
+
+def main(argv):
+	stamp = False
+	if (len(argv) > 1) and (argv[1] == '-t'):
+		stamp = True
+		argv = argv[1:]
+	if len(argv) < 2:
+		sys.stderr.write('usage: amigolog.py [ -t ] APPLICATION.elf [ CAPTURE ]\n')
+		return 1
+	image = Image(argv[1])
+	stream = open(argv[2], 'rb') if (len(argv) > 2) else sys.stdin.buffer
+	capture = Capture(stream)
+	output = sys.stdout
+	try:
+		while True:
+			octet = capture.byte()
+			if octet != RECORD:
+				output.write(chr(octet))
+				continue
+			capture.mark()
+			try:
+				format = image.format(capture.varint())
+				if format is None:
+					raise ValueError
+				ticks = capture.varint()
+				text = render(image, capture, format)
+			except (EOFError, ValueError, TypeError, OverflowError):
+				# Not a record after all, just a RECORD byte in the text.
+				capture.rewind()
+				output.write(chr(octet))
+				continue
+			capture.commit()
+			if stamp:
+				output.write('[%u] ' % ticks)
+			output.write(text)
+			output.flush()
+	except EOFError:
+		pass
+	return 0
+
+if __name__ == '__main__':
+	sys.exit(main(sys.argv))